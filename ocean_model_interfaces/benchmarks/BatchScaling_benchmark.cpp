@@ -0,0 +1,106 @@
+#include "ocean_model_interfaces/fvcom/FVCOM.h"
+#include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
+#include "ocean_model_interfaces/model_interface/ModelData.h"
+#include "ocean_model_interfaces/util/Point.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace ocean_model_interfaces;
+
+#define SECONDS_IN_DAY 86400
+
+/**
+ * Measures getDataBatch throughput against the batch thread count.
+ *
+ * Usage: BatchScaling_benchmark [model directory] [number of points] [repetitions]
+ * Run from the repository root to use the default test model.
+ */
+int main(int argc, char **argv)
+{
+    std::string directory = argc > 1 ? argv[1] : "./ocean_model_interfaces/test_data/axial_data_test";
+    size_t pointCount = argc > 2 ? std::stoul(argv[2]) : 200000;
+    int repetitions = argc > 3 ? std::stoi(argv[3]) : 3;
+
+    //Chunk sizes match the unit tests, with a cache large enough to hold the whole test model
+    FVCOMStructure structure(directory, 1000, 1000, 10, 3);
+    FVCOM fvcom(directory, 1000, 1000, 10, 3, 1000);
+
+    //Random points inside random triangles, at random depths and times inside the model
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> triangleDistribution(0, structure.getNumTriangles() - 1);
+    std::uniform_real_distribution<double> unitDistribution(0.0, 1.0);
+
+    double startTime = structure.getTime(0) * SECONDS_IN_DAY;
+    double endTime = structure.getTime(structure.getNumTimes() - 1) * SECONDS_IN_DAY;
+
+    std::vector<double> xs(pointCount), ys(pointCount), zs(pointCount), ts(pointCount);
+    for(size_t i = 0; i < pointCount; i++)
+    {
+        const std::vector<int>& nodes = structure.getNodesInTriangle(triangleDistribution(generator));
+        Point p1 = structure.getNodePointWithH(nodes[0]);
+        Point p2 = structure.getNodePointWithH(nodes[1]);
+        Point p3 = structure.getNodePointWithH(nodes[2]);
+
+        double a = unitDistribution(generator);
+        double b = unitDistribution(generator);
+        if(a + b > 1.0)
+        {
+            a = 1.0 - a;
+            b = 1.0 - b;
+        }
+
+        xs[i] = p1.x + a * (p2.x - p1.x) + b * (p3.x - p1.x);
+        ys[i] = p1.y + a * (p2.y - p1.y) + b * (p3.y - p1.y);
+        zs[i] = -0.9 * unitDistribution(generator) * std::min(p1.z, std::min(p2.z, p3.z));
+        ts[i] = startTime + unitDistribution(generator) * (endTime - startTime);
+    }
+
+    //Load every chunk before timing so the results measure the query path and not the disk
+    ModelDataSoA out;
+    fvcom.getDataBatch(xs.data(), ys.data(), zs.data(), ts.data(), pointCount, out);
+
+    std::vector<unsigned int> threadCounts;
+    unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned int threads = 1; threads < hardwareThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+
+    std::cout << "points: " << pointCount << ", hardware threads: " << hardwareThreads << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "points/sec" << std::setw(10) << "speedup" << std::endl;
+
+    double baseline = 0;
+    for(unsigned int threads : threadCounts)
+    {
+        fvcom.setBatchThreadCount(threads);
+
+        //Report the best of the repetitions to reduce noise from other processes
+        double best = 0;
+        for(int r = 0; r < repetitions; r++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            fvcom.getDataBatch(xs.data(), ys.data(), zs.data(), ts.data(), pointCount, out);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::max(best, pointCount / elapsed.count());
+        }
+
+        if(baseline == 0)
+        {
+            baseline = best;
+        }
+
+        std::cout << std::setw(8) << threads
+                  << std::setw(16) << std::fixed << std::setprecision(0) << best
+                  << std::setw(10) << std::setprecision(2) << best / baseline << std::endl;
+    }
+
+    return 0;
+}
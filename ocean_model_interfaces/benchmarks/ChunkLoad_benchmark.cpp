@@ -0,0 +1,148 @@
+#include "ocean_model_interfaces/fvcom/FVCOMChunk.h"
+#include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
+#include "ocean_model_interfaces/util/NetCDFFilePool.h"
+#include "ocean_model_interfaces/util/NetCDFMutex.h"
+#include "ocean_model_interfaces/util/Point.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include <netcdf>
+
+using namespace ocean_model_interfaces;
+
+/**
+ * Loads a chunk the way FVCOMChunk did before reads were coalesced, with one request per node or
+ * triangle for each variable. Files come from the same pool so only the read pattern differs.
+ * @return The number of values read, so the reads can not be optimized away.
+ */
+static size_t loadPerElement(const FVCOMStructure& structure, const FVCOMStructure::ChunkInfo& chunkInfo)
+{
+    std::lock_guard<std::mutex> lock(getNetCDFMutex());
+
+    const std::vector<FVCOMStructure::ModelFile> modelFiles = structure.getModelFiles();
+    const std::vector<unsigned int>& nodes = structure.getNodesInChunk(chunkInfo);
+    const std::vector<unsigned int>& triangles = structure.getTrianglesInChunk(chunkInfo);
+    NetCDFFilePool& filePool = structure.getFilePool();
+
+    std::vector<float> values(chunkInfo.timeSize * chunkInfo.siglaySize);
+    size_t valuesRead = 0;
+
+    unsigned int timeIndex = chunkInfo.timeStart;
+    for(const FVCOMStructure::ModelFile& modelFile : modelFiles)
+    {
+        if(timeIndex >= chunkInfo.timeStart + chunkInfo.timeSize)
+        {
+            break;
+        }
+        if(timeIndex >= modelFile.startTimeIndex + modelFile.timeDim)
+        {
+            continue;
+        }
+
+        unsigned int adjustedTimeIndex = timeIndex - modelFile.startTimeIndex;
+        unsigned int timeCount = std::min(chunkInfo.timeSize - (timeIndex - chunkInfo.timeStart), modelFile.timeDim - adjustedTimeIndex);
+        std::vector<size_t> count = {timeCount, chunkInfo.siglaySize, 1};
+
+        for(const std::string& name : {"temp", "salinity", "DYE"})
+        {
+            netCDF::NcVar var = filePool.getVar(modelFile.filename, name);
+            for(unsigned int i = 0; i < nodes.size() && !var.isNull(); i++)
+            {
+                std::vector<size_t> start = {adjustedTimeIndex, chunkInfo.siglayStart, nodes[i]};
+                var.getVar(start, count, values.data());
+                valuesRead += timeCount * chunkInfo.siglaySize;
+            }
+        }
+
+        for(const std::string& name : {"u", "v", "ww"})
+        {
+            netCDF::NcVar var = filePool.getVar(modelFile.filename, name);
+            for(unsigned int i = 0; i < triangles.size(); i++)
+            {
+                std::vector<size_t> start = {adjustedTimeIndex, chunkInfo.siglayStart, triangles[i]};
+                var.getVar(start, count, values.data());
+                valuesRead += timeCount * chunkInfo.siglaySize;
+            }
+        }
+
+        timeIndex += timeCount;
+    }
+
+    return valuesRead;
+}
+
+/**
+ * Compares the time to load every chunk of a model with one read per node or triangle
+ * against the coalesced range reads used by FVCOMChunk.
+ *
+ * Usage: ChunkLoad_benchmark [model directory] [xy chunk size] [repetitions]
+ * Run from the repository root to use the default test model.
+ */
+int main(int argc, char **argv)
+{
+    std::string directory = argc > 1 ? argv[1] : "./ocean_model_interfaces/test_data/axial_data_test";
+    int xyChunkSize = argc > 2 ? std::stoi(argv[2]) : 2000;
+    int repetitions = argc > 3 ? std::stoi(argv[3]) : 3;
+
+    FVCOMStructure structure(directory, xyChunkSize, xyChunkSize, 10, 3);
+
+    //Every chunk in the model
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+    for(unsigned int i = 0; i < structure.getNumNodes(); i++)
+    {
+        Point node = structure.getNodePointWithH(i);
+        minX = std::min(minX, node.x);
+        minY = std::min(minY, node.y);
+        maxX = std::max(maxX, node.x);
+        maxY = std::max(maxY, node.y);
+    }
+    std::vector<FVCOMStructure::ChunkInfo> chunks = structure.getChunksInRegion(minX, minY, maxX, maxY,
+                                                                                0, structure.getNumSiglays() - 1,
+                                                                                structure.getTime(0),
+                                                                                structure.getTime(structure.getNumTimes() - 1));
+
+    //Open the files before timing so both methods start with the same handles
+    loadPerElement(structure, chunks[0]);
+
+    //Report the best of the repetitions to reduce noise from other processes
+    double perElementBest = std::numeric_limits<double>::max();
+    double coalescedBest = std::numeric_limits<double>::max();
+    size_t valuesRead = 0;
+    for(int r = 0; r < repetitions; r++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for(const FVCOMStructure::ChunkInfo& chunk : chunks)
+        {
+            valuesRead += loadPerElement(structure, chunk);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        perElementBest = std::min(perElementBest, elapsed.count());
+
+        start = std::chrono::steady_clock::now();
+        for(const FVCOMStructure::ChunkInfo& chunk : chunks)
+        {
+            FVCOMChunk loaded(structure.getModelFiles(), structure.getNodesInChunk(chunk),
+                              structure.getTrianglesInChunk(chunk), chunk, structure.getStorageBackend());
+        }
+        elapsed = std::chrono::steady_clock::now() - start;
+        coalescedBest = std::min(coalescedBest, elapsed.count());
+    }
+
+    std::cout << "chunks: " << chunks.size() << ", values read per repetition: " << valuesRead / repetitions << std::endl;
+    std::cout << std::setw(14) << "method" << std::setw(16) << "ms per chunk" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(14) << "per element" << std::setw(16) << 1000 * perElementBest / chunks.size() << std::endl;
+    std::cout << std::setw(14) << "coalesced" << std::setw(16) << 1000 * coalescedBest / chunks.size() << std::endl;
+    std::cout << "speedup: " << std::setprecision(2) << perElementBest / coalescedBest << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,804 @@
+#include "ocean_model_interfaces/fvcom/FVCOM.h"
+#include "ocean_model_interfaces/fvcom/FVCOMChunk.h"
+#include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
+#include "ocean_model_interfaces/fvcom/SyntheticFVCOM.h"
+#include "ocean_model_interfaces/geodetic_grid/GeodeticGrid.h"
+#include "ocean_model_interfaces/geodetic_grid/SyntheticGeodeticGrid.h"
+#include "ocean_model_interfaces/model_interface/QueryContext.h"
+#include "ocean_model_interfaces/util/ChunkStore.h"
+#include "ocean_model_interfaces/util/ConcurrentCache.h"
+#include "ocean_model_interfaces/util/MemoryStorageBackend.h"
+#include "ocean_model_interfaces/util/Point.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+using namespace ocean_model_interfaces;
+
+#define SECONDS_IN_DAY 86400
+
+//Chunk sizes of the models, small enough that every model has several chunks in each direction
+static const unsigned int FVCOM_XY_CHUNK_SIZE = 2000;
+static const unsigned int FVCOM_SIGLAY_CHUNK_SIZE = 5;
+static const unsigned int FVCOM_TIME_CHUNK_SIZE = 6;
+
+static const unsigned int GRID_LAT_CHUNK_SIZE = 20;
+static const unsigned int GRID_LON_CHUNK_SIZE = 20;
+static const unsigned int GRID_DEPTH_CHUNK_SIZE = 5;
+
+//Cache size of the cold FVCOM model. A single query uses at most this many chunks, so queries do not
+//evict each other's chunks, but the cache holds only a small part of the model.
+static const unsigned int COLD_CACHE_SIZE = 16;
+
+//Number of queries in each access pattern. Benchmarks cycle through them.
+static const size_t QUERY_COUNT = 1 << 14;
+
+//Distance in meters a trajectory moves between queries, and time in seconds
+static const double TRAJECTORY_STEP = 5.0;
+static const double TRAJECTORY_TIME_STEP = 1.0;
+
+/**
+ * Every benchmark runs with both access patterns. Random queries are spread uniformly over the model,
+ * so nearly every query needs a different chunk and a new search. Trajectory queries follow a drifting
+ * vehicle, so consecutive queries are close in space and time like the queries of a simulation.
+ */
+enum AccessPattern
+{
+    RANDOM,
+    TRAJECTORY
+};
+
+/**
+ * Where FVCOMChunk reads its values from in the chunk load benchmark.
+ */
+enum ChunkSource
+{
+    NETCDF,
+    MEMORY,
+    SYNTHETIC,
+    CHUNK_STORE
+};
+
+/**
+ * Query locations in model coordinates, with the time in seconds.
+ */
+struct Queries
+{
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    std::vector<double> time;
+
+    //For FVCOM queries, the triangle containing each location and the id of the chunk holding its data
+    std::vector<int> triangles;
+    std::vector<unsigned int> chunkIds;
+
+    void add(double queryX, double queryY, double queryZ, double queryTime)
+    {
+        x.push_back(queryX);
+        y.push_back(queryY);
+        z.push_back(queryZ);
+        time.push_back(queryTime);
+    }
+};
+
+/**
+ * Size of the synthetic models and where they are written, set from the command line.
+ */
+struct Settings
+{
+    std::string directory;
+    SyntheticFVCOMParameters fvcom;
+    SyntheticGeodeticGridParameters grid;
+};
+
+static Settings settings;
+
+/**
+ * The synthetic models and queries shared by the benchmarks. They are written and generated the first
+ * time a benchmark needs them, so running a filtered set of benchmarks only pays for what it uses.
+ */
+class Environment
+{
+public:
+    static Environment& get()
+    {
+        static Environment environment;
+        return environment;
+    }
+
+    std::string fvcomDirectory;
+    std::string gridDirectory;
+    std::string structureCacheFile;
+
+    std::unique_ptr<FVCOMStructure> structure;
+    std::vector<FVCOMStructure::ChunkInfo> chunks;
+
+    Queries fvcomQueries[2];
+    Queries gridQueries[2];
+
+    //Indices into chunks in the order each access pattern loads them
+    std::vector<size_t> chunkOrders[2];
+
+    /**
+     * @return A model that holds every chunk in its cache, with the chunks already loaded.
+     */
+    FVCOM& getCachedFVCOM()
+    {
+        if(!cachedFVCOM)
+        {
+            cachedFVCOM.reset(new FVCOM(fvcomDirectory, FVCOM_XY_CHUNK_SIZE, FVCOM_XY_CHUNK_SIZE,
+                                        FVCOM_SIGLAY_CHUNK_SIZE, FVCOM_TIME_CHUNK_SIZE, chunks.size()));
+            for(AccessPattern pattern : {RANDOM, TRAJECTORY})
+            {
+                const Queries& queries = fvcomQueries[pattern];
+                for(size_t i = 0; i < queries.x.size(); i++)
+                {
+                    cachedFVCOM->getData(queries.x[i], queries.y[i], queries.z[i], queries.time[i]);
+                }
+            }
+        }
+        return *cachedFVCOM;
+    }
+
+    /**
+     * @return A model with room for the chunks of a few queries, so queries outside of them load chunks.
+     */
+    FVCOM& getColdFVCOM()
+    {
+        if(!coldFVCOM)
+        {
+            coldFVCOM.reset(new FVCOM(fvcomDirectory, [this]() { chunkLoads++; }, nullptr,
+                                      FVCOM_XY_CHUNK_SIZE, FVCOM_XY_CHUNK_SIZE,
+                                      FVCOM_SIGLAY_CHUNK_SIZE, FVCOM_TIME_CHUNK_SIZE, COLD_CACHE_SIZE));
+        }
+        return *coldFVCOM;
+    }
+
+    /**
+     * @return A grid that holds every chunk in its cache, with the chunks already loaded.
+     */
+    GeodeticGrid& getCachedGrid()
+    {
+        if(!cachedGrid)
+        {
+            GeodeticGridParameters parameters = getGridParameters();
+            parameters.cacheSize = 1000000;
+            cachedGrid.reset(new GeodeticGrid(parameters));
+            cachedGrid->setCoordinateType(ModelInterface::CoordinateType::LATLON);
+            for(AccessPattern pattern : {RANDOM, TRAJECTORY})
+            {
+                const Queries& queries = gridQueries[pattern];
+                for(size_t i = 0; i < queries.x.size(); i++)
+                {
+                    cachedGrid->getData(queries.x[i], queries.y[i], queries.z[i], queries.time[i]);
+                }
+            }
+        }
+        return *cachedGrid;
+    }
+
+    GeodeticGridParameters getGridParameters() const
+    {
+        GeodeticGridParameters parameters;
+        parameters.modelDirectory = gridDirectory;
+        parameters.timeChunkSize = 1;
+        parameters.depthChunkSize = GRID_DEPTH_CHUNK_SIZE;
+        parameters.latChunkSize = GRID_LAT_CHUNK_SIZE;
+        parameters.lonChunkSize = GRID_LON_CHUNK_SIZE;
+        return parameters;
+    }
+
+    /**
+     * @return The backend a chunk load benchmark reads from.
+     */
+    StorageBackend& getBackend(ChunkSource source)
+    {
+        if(source == MEMORY)
+        {
+            if(!memoryBackend)
+            {
+                memoryBackend = createMemoryBackend();
+            }
+            return *memoryBackend;
+        }
+        if(source == SYNTHETIC)
+        {
+            if(!syntheticBackend)
+            {
+                syntheticBackend = createSyntheticFVCOMBackend(settings.fvcom);
+            }
+            return *syntheticBackend;
+        }
+        return structure->getStorageBackend();
+    }
+
+    /**
+     * @return A chunk store with every chunk of the model, written the first time it is needed.
+     */
+    std::shared_ptr<const ChunkStore> getChunkStore()
+    {
+        if(!chunkStore)
+        {
+            std::string filename = (fs::path(settings.directory) / "chunks.omics").string();
+            FVCOM(fvcomDirectory, FVCOM_XY_CHUNK_SIZE, FVCOM_XY_CHUNK_SIZE,
+                  FVCOM_SIGLAY_CHUNK_SIZE, FVCOM_TIME_CHUNK_SIZE, 1).writeChunkStore(filename);
+            chunkStore = std::make_shared<const ChunkStore>(filename);
+        }
+        return chunkStore;
+    }
+
+    //Chunks loaded by the cold model
+    std::atomic<long> chunkLoads;
+
+private:
+    Environment() :
+        chunkLoads(0)
+    {
+        fvcomDirectory = (fs::path(settings.directory) / "fvcom").string();
+        gridDirectory = (fs::path(settings.directory) / "grid").string();
+        structureCacheFile = (fs::path(settings.directory) / "fvcom.omistruct").string();
+
+        std::cerr << "Writing synthetic models to " << settings.directory << std::endl;
+        writeSyntheticFVCOM(fvcomDirectory, settings.fvcom);
+        writeSyntheticGeodeticGrid(gridDirectory, settings.grid);
+
+        structure.reset(new FVCOMStructure(fvcomDirectory, FVCOM_XY_CHUNK_SIZE, FVCOM_XY_CHUNK_SIZE,
+                                           FVCOM_SIGLAY_CHUNK_SIZE, FVCOM_TIME_CHUNK_SIZE));
+        chunks = structure->getAllChunks();
+
+        std::mt19937 generator(1);
+        createFVCOMQueries(generator);
+        createGridQueries(generator);
+
+        //Random chunk loads visit every chunk once in a shuffled order, trajectory chunk loads follow the
+        //chunks the trajectory passes through
+        std::vector<size_t> chunkIndices(structure->getNumChunks(), chunks.size());
+        for(size_t i = 0; i < chunks.size(); i++)
+        {
+            chunkIndices[chunks[i].id] = i;
+            chunkOrders[RANDOM].push_back(i);
+        }
+        std::shuffle(chunkOrders[RANDOM].begin(), chunkOrders[RANDOM].end(), generator);
+
+        for(unsigned int id : fvcomQueries[TRAJECTORY].chunkIds)
+        {
+            if(chunkOrders[TRAJECTORY].empty() || chunks[chunkOrders[TRAJECTORY].back()].id != id)
+            {
+                chunkOrders[TRAJECTORY].push_back(chunkIndices[id]);
+            }
+        }
+    }
+
+    /**
+     * Adds an FVCOM query at a location known to be in the model, recording its triangle and chunk.
+     */
+    void addFVCOMQuery(Queries& queries, Point point, int triangle, double depthFraction, double time)
+    {
+        point.z = -depthFraction * structure->getDepthAtPoint(point, triangle);
+
+        Point siglayPoint = point;
+        int siglay1Index = 0;
+        int siglay2Index = 0;
+        double siglay1Percent = 0;
+        structure->siglayInterpolation(siglayPoint, siglay1Index, siglay2Index, siglay1Percent, triangle);
+
+        int timeIndex = structure->getPreviousTimeIndex(time / SECONDS_IN_DAY);
+        int node = structure->getNodesInTriangle(triangle)[0];
+
+        queries.add(point.x, point.y, point.z, time);
+        queries.triangles.push_back(triangle);
+        queries.chunkIds.push_back(structure->getChunkForNode(node, siglay1Index, timeIndex).id);
+    }
+
+    void createFVCOMQueries(std::mt19937& generator)
+    {
+        std::uniform_real_distribution<double> unitDistribution(0.0, 1.0);
+        std::uniform_int_distribution<int> triangleDistribution(0, structure->getNumTriangles() - 1);
+        double endTime = structure->getTime(structure->getNumTimes() - 1) * SECONDS_IN_DAY;
+
+        //Random points inside random triangles
+        Queries& randomQueries = fvcomQueries[RANDOM];
+        while(randomQueries.x.size() < QUERY_COUNT)
+        {
+            int triangle = triangleDistribution(generator);
+            const std::vector<int>& nodes = structure->getNodesInTriangle(triangle);
+            Point p1 = structure->getNodePointWithH(nodes[0]);
+            Point p2 = structure->getNodePointWithH(nodes[1]);
+            Point p3 = structure->getNodePointWithH(nodes[2]);
+
+            double a = unitDistribution(generator);
+            double b = unitDistribution(generator);
+            if(a + b > 1.0)
+            {
+                a = 1.0 - a;
+                b = 1.0 - b;
+            }
+
+            Point point(p1.x + a * (p2.x - p1.x) + b * (p3.x - p1.x), p1.y + a * (p2.y - p1.y) + b * (p3.y - p1.y), 0);
+            addFVCOMQuery(randomQueries, point, triangle,
+                          0.05 + 0.9 * unitDistribution(generator), unitDistribution(generator) * endTime);
+        }
+
+        //A trajectory from the center of the mesh with a slowly turning heading. It turns around near the edge
+        //of the mesh, and slowly changes depth.
+        Queries& trajectoryQueries = fvcomQueries[TRAJECTORY];
+        double halfWidth = 0.9 * 0.5 * (settings.fvcom.nodesX - 1) * settings.fvcom.nodeSpacing;
+        double halfHeight = 0.9 * 0.5 * (settings.fvcom.nodesY - 1) * settings.fvcom.nodeSpacing;
+        std::normal_distribution<double> turnDistribution(0.0, 0.05);
+        Point point(0, 0, 0);
+        double heading = 0.3;
+        double depthFraction = 0.5;
+        double time = 0;
+        while(trajectoryQueries.x.size() < QUERY_COUNT)
+        {
+            heading += turnDistribution(generator);
+            Point next(point.x + TRAJECTORY_STEP * std::cos(heading), point.y + TRAJECTORY_STEP * std::sin(heading), 0);
+            if(std::abs(next.x) > halfWidth || std::abs(next.y) > halfHeight)
+            {
+                heading += M_PI;
+                continue;
+            }
+
+            point = next;
+            depthFraction = 0.5 + 0.4 * std::sin(trajectoryQueries.x.size() * 0.001);
+            time = std::fmod(time + TRAJECTORY_TIME_STEP, endTime);
+            addFVCOMQuery(trajectoryQueries, point, structure->getContainingTriangle(point), depthFraction, time);
+        }
+    }
+
+    void createGridQueries(std::mt19937& generator)
+    {
+        std::uniform_real_distribution<double> unitDistribution(0.0, 1.0);
+        const SyntheticGeodeticGridParameters& grid = settings.grid;
+        double endTime = (grid.timeSteps - 1) * grid.timeStep;
+
+        //Stay a grid point inside the edges, and above the bottom of the shallowest water column
+        double minLat = grid.minLat + grid.spacing;
+        double minLon = grid.minLon + grid.spacing;
+        double latRange = (grid.lats - 3) * grid.spacing;
+        double lonRange = (grid.lons - 3) * grid.spacing;
+        double minDepth = 100;
+        double maxDepth = 400;
+
+        Queries& randomQueries = gridQueries[RANDOM];
+        while(randomQueries.x.size() < QUERY_COUNT)
+        {
+            randomQueries.add(minLon + unitDistribution(generator) * lonRange,
+                              minLat + unitDistribution(generator) * latRange,
+                              -(minDepth + unitDistribution(generator) * (maxDepth - minDepth)),
+                              unitDistribution(generator) * endTime);
+        }
+
+        //The same kind of trajectory as for FVCOM, with the step converted to degrees
+        Queries& trajectoryQueries = gridQueries[TRAJECTORY];
+        double degreesPerMeter = 1.0 / 111000.0;
+        std::normal_distribution<double> turnDistribution(0.0, 0.05);
+        double lat = minLat + 0.5 * latRange;
+        double lon = minLon + 0.5 * lonRange;
+        double heading = 0.3;
+        double time = 0;
+        while(trajectoryQueries.x.size() < QUERY_COUNT)
+        {
+            heading += turnDistribution(generator);
+            double nextLat = lat + TRAJECTORY_STEP * degreesPerMeter * std::sin(heading);
+            double nextLon = lon + TRAJECTORY_STEP * degreesPerMeter * std::cos(heading);
+            if(nextLat < minLat || nextLat > minLat + latRange || nextLon < minLon || nextLon > minLon + lonRange)
+            {
+                heading += M_PI;
+                continue;
+            }
+
+            lat = nextLat;
+            lon = nextLon;
+            time = std::fmod(time + TRAJECTORY_TIME_STEP, endTime);
+            double depth = 0.5 * (minDepth + maxDepth) + 0.4 * (maxDepth - minDepth) * std::sin(trajectoryQueries.x.size() * 0.001);
+            trajectoryQueries.add(lon, lat, -depth, time);
+        }
+    }
+
+    std::shared_ptr<StorageBackend> createMemoryBackend()
+    {
+        //Copies every data variable out of the synthetic backend, which gives the same values as the files
+        std::shared_ptr<SyntheticStorageBackend> source = createSyntheticFVCOMBackend(settings.fvcom);
+        std::shared_ptr<MemoryStorageBackend> backend = std::make_shared<MemoryStorageBackend>();
+
+        size_t siglays = structure->getNumSiglays();
+        for(const FVCOMStructure::ModelFile& modelFile : structure->getModelFiles())
+        {
+            for(const std::string& name : {"temp", "salinity", "DYE", "u", "v", "ww"})
+            {
+                bool nodeVariable = name == "temp" || name == "salinity" || name == "DYE";
+                size_t elements = nodeVariable ? structure->getNumNodes() : structure->getNumTriangles();
+                std::vector<size_t> shape = {modelFile.timeDim, siglays, elements};
+
+                std::vector<float> values(modelFile.timeDim * siglays * elements);
+                source->read(modelFile.filename, name, {0, 0, 0}, shape, values.data());
+                backend->setVariable(modelFile.filename, name, shape, std::move(values));
+            }
+        }
+        return backend;
+    }
+
+    std::unique_ptr<FVCOM> cachedFVCOM;
+    std::unique_ptr<FVCOM> coldFVCOM;
+    std::unique_ptr<GeodeticGrid> cachedGrid;
+
+    std::shared_ptr<StorageBackend> memoryBackend;
+    std::shared_ptr<StorageBackend> syntheticBackend;
+    std::shared_ptr<const ChunkStore> chunkStore;
+};
+
+/**
+ * Queries a model that already holds every chunk, so only the search and interpolation are timed.
+ */
+static void FVCOMGetDataCached(benchmark::State& state, AccessPattern pattern)
+{
+    Environment& environment = Environment::get();
+    FVCOM& model = environment.getCachedFVCOM();
+    const Queries& queries = environment.fvcomQueries[pattern];
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(model.getData(queries.x[i], queries.y[i], queries.z[i], queries.time[i]));
+        i = (i + 1) % queries.x.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Queries a model with a small cache, so the time includes loading chunks whenever a query needs chunks the
+ * recent queries did not. The chunk loads per query counter shows how often that was.
+ */
+static void FVCOMGetDataCold(benchmark::State& state, AccessPattern pattern)
+{
+    Environment& environment = Environment::get();
+    FVCOM& model = environment.getColdFVCOM();
+    const Queries& queries = environment.fvcomQueries[pattern];
+
+    long startLoads = environment.chunkLoads;
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(model.getData(queries.x[i], queries.y[i], queries.z[i], queries.time[i]));
+        i = (i + 1) % queries.x.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["chunk_loads_per_query"] = double(environment.chunkLoads - startLoads) / state.iterations();
+}
+
+static void GeodeticGridGetData(benchmark::State& state, AccessPattern pattern)
+{
+    Environment& environment = Environment::get();
+    GeodeticGrid& model = environment.getCachedGrid();
+    const Queries& queries = environment.gridQueries[pattern];
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(model.getData(queries.x[i], queries.y[i], queries.z[i], queries.time[i]));
+        i = (i + 1) % queries.x.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void GetContainingTriangle(benchmark::State& state, AccessPattern pattern)
+{
+    Environment& environment = Environment::get();
+    const FVCOMStructure& structure = *environment.structure;
+    const Queries& queries = environment.fvcomQueries[pattern];
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(structure.getContainingTriangle(Point(queries.x[i], queries.y[i], queries.z[i])));
+        i = (i + 1) % queries.x.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Same as GetContainingTriangle, starting each search from the triangle of the previous query.
+ */
+static void GetContainingTriangleWithContext(benchmark::State& state, AccessPattern pattern)
+{
+    Environment& environment = Environment::get();
+    const FVCOMStructure& structure = *environment.structure;
+    const Queries& queries = environment.fvcomQueries[pattern];
+
+    QueryContext context;
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(structure.getContainingTriangle(Point(queries.x[i], queries.y[i], queries.z[i]), context));
+        i = (i + 1) % queries.x.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void SiglayInterpolation(benchmark::State& state, AccessPattern pattern)
+{
+    Environment& environment = Environment::get();
+    const FVCOMStructure& structure = *environment.structure;
+    const Queries& queries = environment.fvcomQueries[pattern];
+
+    QueryContext context;
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        Point point(queries.x[i], queries.y[i], queries.z[i]);
+        int siglay1Index;
+        int siglay2Index;
+        double siglay1Percent;
+        structure.siglayInterpolation(point, siglay1Index, siglay2Index, siglay1Percent, queries.triangles[i], context);
+        benchmark::DoNotOptimize(siglay1Percent);
+        i = (i + 1) % queries.x.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Loads one FVCOM chunk per iteration without a cache, cycling through the chunks in the order of the access
+ * pattern. Random loads visit the chunks shuffled, trajectory loads the chunks the trajectory passes through.
+ */
+static void ChunkLoad(benchmark::State& state, ChunkSource source, AccessPattern pattern)
+{
+    Environment& environment = Environment::get();
+    const FVCOMStructure& structure = *environment.structure;
+    const std::vector<size_t>& order = environment.chunkOrders[pattern];
+    const std::vector<FVCOMStructure::ModelFile> modelFiles = structure.getModelFiles();
+
+    std::shared_ptr<const ChunkStore> store;
+    StorageBackend* backend = nullptr;
+    if(source == CHUNK_STORE)
+    {
+        store = environment.getChunkStore();
+    }
+    else
+    {
+        backend = &environment.getBackend(source);
+    }
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        const FVCOMStructure::ChunkInfo& chunk = environment.chunks[order[i]];
+        if(store)
+        {
+            FVCOMChunk loaded(store, chunk);
+            benchmark::DoNotOptimize(&loaded);
+        }
+        else
+        {
+            FVCOMChunk loaded(modelFiles, structure.getNodesInChunk(chunk), structure.getTrianglesInChunk(chunk), chunk, *backend);
+            benchmark::DoNotOptimize(&loaded);
+        }
+        i = (i + 1) % order.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Keys of the cache benchmarks, the chunk of each query in the access pattern.
+ */
+static const std::vector<unsigned int>& getCacheKeys(AccessPattern pattern)
+{
+    return Environment::get().fvcomQueries[pattern].chunkIds;
+}
+
+/**
+ * Looks up chunks that are all in the cache, the cost every query pays before using its chunk.
+ */
+static void CacheHit(benchmark::State& state, AccessPattern pattern)
+{
+    const std::vector<unsigned int>& keys = getCacheKeys(pattern);
+    unsigned int numChunks = Environment::get().structure->getNumChunks();
+
+    ConcurrentCache<unsigned int, std::shared_ptr<const int>> cache(numChunks);
+    for(unsigned int id = 0; id < numChunks; id++)
+    {
+        cache.put(id, std::make_shared<const int>(id));
+    }
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(cache.get(keys[i]));
+        i = (i + 1) % keys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Looks up chunks that are not in a full cache and adds them, evicting the least recently used chunk. The
+ * chunk itself is made before timing, so only the cost of the cache is measured.
+ */
+static void CacheMiss(benchmark::State& state, AccessPattern pattern)
+{
+    const std::vector<unsigned int>& keys = getCacheKeys(pattern);
+    unsigned int numChunks = Environment::get().structure->getNumChunks();
+    std::shared_ptr<const int> value = std::make_shared<const int>(0);
+
+    //Keys in the cache never match the keys looked up, which move past every earlier key each time around
+    ConcurrentCache<unsigned int, std::shared_ptr<const int>> cache(16);
+    unsigned int offset = numChunks;
+    for(unsigned int id = 0; id < 16; id++)
+    {
+        cache.put(id, value);
+    }
+
+    size_t i = 0;
+    for(auto _ : state)
+    {
+        unsigned int key = keys[i] + offset;
+        bool found = cache.visit(key, [](const std::shared_ptr<const int>&) {});
+        if(!found)
+        {
+            cache.put(key, value);
+        }
+        benchmark::DoNotOptimize(found);
+
+        i++;
+        if(i == keys.size())
+        {
+            i = 0;
+            offset += numChunks;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Loads the FVCOM structure, reading the model files or a structure cache. Access patterns do not apply.
+ */
+static void FVCOMStartup(benchmark::State& state, bool useStructureCache)
+{
+    Environment& environment = Environment::get();
+    std::string cacheFile = useStructureCache ? environment.structureCacheFile : "";
+    if(useStructureCache)
+    {
+        //Write the cache before timing
+        FVCOMStructure(environment.fvcomDirectory, FVCOM_XY_CHUNK_SIZE, FVCOM_XY_CHUNK_SIZE,
+                       FVCOM_SIGLAY_CHUNK_SIZE, FVCOM_TIME_CHUNK_SIZE, cacheFile);
+    }
+
+    for(auto _ : state)
+    {
+        FVCOM model(environment.fvcomDirectory, FVCOM_XY_CHUNK_SIZE, FVCOM_XY_CHUNK_SIZE,
+                    FVCOM_SIGLAY_CHUNK_SIZE, FVCOM_TIME_CHUNK_SIZE, 1, cacheFile);
+        benchmark::DoNotOptimize(&model);
+    }
+}
+
+static void GeodeticGridStartup(benchmark::State& state)
+{
+    Environment& environment = Environment::get();
+    for(auto _ : state)
+    {
+        GeodeticGrid model(environment.getGridParameters());
+        benchmark::DoNotOptimize(&model);
+    }
+}
+
+BENCHMARK_CAPTURE(FVCOMGetDataCached, random, RANDOM);
+BENCHMARK_CAPTURE(FVCOMGetDataCached, trajectory, TRAJECTORY);
+BENCHMARK_CAPTURE(FVCOMGetDataCold, random, RANDOM);
+BENCHMARK_CAPTURE(FVCOMGetDataCold, trajectory, TRAJECTORY);
+BENCHMARK_CAPTURE(GeodeticGridGetData, random, RANDOM);
+BENCHMARK_CAPTURE(GeodeticGridGetData, trajectory, TRAJECTORY);
+
+BENCHMARK_CAPTURE(GetContainingTriangle, random, RANDOM);
+BENCHMARK_CAPTURE(GetContainingTriangle, trajectory, TRAJECTORY);
+BENCHMARK_CAPTURE(GetContainingTriangleWithContext, random, RANDOM);
+BENCHMARK_CAPTURE(GetContainingTriangleWithContext, trajectory, TRAJECTORY);
+BENCHMARK_CAPTURE(SiglayInterpolation, random, RANDOM);
+BENCHMARK_CAPTURE(SiglayInterpolation, trajectory, TRAJECTORY);
+
+BENCHMARK_CAPTURE(ChunkLoad, netcdf_random, NETCDF, RANDOM)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ChunkLoad, netcdf_trajectory, NETCDF, TRAJECTORY)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ChunkLoad, memory_random, MEMORY, RANDOM)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ChunkLoad, memory_trajectory, MEMORY, TRAJECTORY)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ChunkLoad, synthetic_random, SYNTHETIC, RANDOM)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ChunkLoad, synthetic_trajectory, SYNTHETIC, TRAJECTORY)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ChunkLoad, chunk_store_random, CHUNK_STORE, RANDOM)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(ChunkLoad, chunk_store_trajectory, CHUNK_STORE, TRAJECTORY)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_CAPTURE(CacheHit, random, RANDOM);
+BENCHMARK_CAPTURE(CacheHit, trajectory, TRAJECTORY);
+BENCHMARK_CAPTURE(CacheMiss, random, RANDOM);
+BENCHMARK_CAPTURE(CacheMiss, trajectory, TRAJECTORY);
+
+BENCHMARK_CAPTURE(FVCOMStartup, model_files, false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(FVCOMStartup, structure_cache, true)->Unit(benchmark::kMillisecond);
+BENCHMARK(GeodeticGridStartup)->Unit(benchmark::kMillisecond);
+
+/**
+ * Reads an option of the form --name=value.
+ * @return True if the argument was the option.
+ */
+static bool readOption(const std::string& argument, const std::string& name, std::string& value)
+{
+    std::string prefix = "--" + name + "=";
+    if(argument.compare(0, prefix.size(), prefix) != 0)
+    {
+        return false;
+    }
+    value = argument.substr(prefix.size());
+    return true;
+}
+
+/**
+ * Benchmarks of the query hot paths on synthetic models, so they run anywhere and scale to any model size.
+ * The models are written to a temporary directory and removed at the end.
+ *
+ * Usage: QueryPaths_benchmark [--nodes=<nodes along each side>] [--siglays=<layers>] [--time_steps=<steps>]
+ *                             [--directory=<directory for the models>] [google benchmark options]
+ * For example --benchmark_filter=ChunkLoad runs only the chunk load benchmarks, and --benchmark_format=json
+ * writes results that can be compared between builds with the compare.py tool of google benchmark.
+ */
+int main(int argc, char **argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    settings.directory = fs::exists("/dev/shm") ? "/dev/shm" : fs::temp_directory_path().string();
+    settings.directory = (fs::path(settings.directory) / fs::unique_path("omi_benchmark_%%%%%%")).string();
+    settings.fvcom.timeStepsPerFile = 12;
+    settings.grid.depths = settings.fvcom.siglays;
+
+    //Options not handled by google benchmark are ours
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        std::string value;
+        try
+        {
+            if(readOption(argument, "nodes", value))
+            {
+                settings.fvcom.nodesX = settings.fvcom.nodesY = std::stoi(value);
+                settings.grid.lats = settings.grid.lons = std::stoi(value);
+            }
+            else if(readOption(argument, "siglays", value))
+            {
+                settings.fvcom.siglays = settings.grid.depths = std::stoi(value);
+            }
+            else if(readOption(argument, "time_steps", value))
+            {
+                settings.fvcom.timeSteps = settings.grid.timeSteps = std::stoi(value);
+            }
+            else if(readOption(argument, "directory", value))
+            {
+                settings.directory = value;
+            }
+            else
+            {
+                std::cerr << "Unknown argument " << argument << std::endl;
+                return 1;
+            }
+        }
+        catch(const std::logic_error& e)
+        {
+            std::cerr << "Invalid value in " << argument << std::endl;
+            return 1;
+        }
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    fs::remove_all(settings.directory);
+
+    return 0;
+}
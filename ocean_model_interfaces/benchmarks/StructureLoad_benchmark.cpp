@@ -0,0 +1,112 @@
+#include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdio>
+
+using namespace ocean_model_interfaces;
+
+/**
+ * Best time of each load phase over several loads of the same structure.
+ */
+struct PhaseTimes
+{
+    FVCOMStructure::LoadTimes phases;
+    double total = std::numeric_limits<double>::max();
+};
+
+static void keepBest(double& best, double time)
+{
+    best = std::min(best, time);
+}
+
+/**
+ * Loads the structure repetitions times and keeps the fastest time of each phase.
+ * @param structureCacheFile Structure cache to use, empty to read the model files every time
+ * @param removeCache Remove the cache before each load so it is written instead of read
+ */
+static PhaseTimes loadStructure(const std::string& directory, int xyChunkSize, int repetitions,
+                                const std::string& structureCacheFile, bool removeCache)
+{
+    double max = std::numeric_limits<double>::max();
+    PhaseTimes best;
+    best.phases.readTimes = max;
+    best.phases.readMesh = max;
+    best.phases.buildAdjacency = max;
+    best.phases.splitIntoChunks = max;
+    best.phases.structureCache = max;
+    best.phases.buildSpatialIndex = max;
+
+    for(int r = 0; r < repetitions; r++)
+    {
+        if(removeCache)
+        {
+            std::remove(structureCacheFile.c_str());
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        FVCOMStructure structure(directory, xyChunkSize, xyChunkSize, 10, 3, structureCacheFile);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const FVCOMStructure::LoadTimes& times = structure.getLoadTimes();
+        keepBest(best.phases.readTimes, times.readTimes);
+        keepBest(best.phases.readMesh, times.readMesh);
+        keepBest(best.phases.buildAdjacency, times.buildAdjacency);
+        keepBest(best.phases.splitIntoChunks, times.splitIntoChunks);
+        keepBest(best.phases.structureCache, times.structureCache);
+        keepBest(best.phases.buildSpatialIndex, times.buildSpatialIndex);
+        keepBest(best.total, elapsed.count());
+    }
+
+    return best;
+}
+
+static void printRow(const std::string& phase, double noCache, double cacheWrite, double cacheRead)
+{
+    std::cout << std::setw(20) << phase
+              << std::setw(14) << 1000 * noCache
+              << std::setw(14) << 1000 * cacheWrite
+              << std::setw(14) << 1000 * cacheRead << std::endl;
+}
+
+/**
+ * Reports the wall time of each phase of loading an FVCOM structure, without a structure cache,
+ * when the structure cache is written, and when it is read back.
+ *
+ * Usage: StructureLoad_benchmark [model directory] [xy chunk size] [repetitions] [structure cache file]
+ * Run from the repository root to use the default test model.
+ */
+int main(int argc, char **argv)
+{
+    std::string directory = argc > 1 ? argv[1] : "./ocean_model_interfaces/test_data/axial_data_test";
+    int xyChunkSize = argc > 2 ? std::stoi(argv[2]) : 2000;
+    int repetitions = argc > 3 ? std::stoi(argv[3]) : 3;
+    std::string structureCacheFile = argc > 4 ? argv[4] : "./StructureLoad_benchmark_cache.bin";
+
+    //The first load also opens the files, so it is not timed
+    FVCOMStructure warmup(directory, xyChunkSize, xyChunkSize, 10, 3);
+
+    PhaseTimes noCache = loadStructure(directory, xyChunkSize, repetitions, "", false);
+    PhaseTimes cacheWrite = loadStructure(directory, xyChunkSize, repetitions, structureCacheFile, true);
+    PhaseTimes cacheRead = loadStructure(directory, xyChunkSize, repetitions, structureCacheFile, false);
+    std::remove(structureCacheFile.c_str());
+
+    std::cout << "nodes: " << warmup.getNumNodes() << ", triangles: " << warmup.getNumTriangles()
+              << ", times: " << warmup.getNumTimes() << ", files: " << warmup.getModelFiles().size() << std::endl;
+    std::cout << std::setw(20) << "phase (ms)" << std::setw(14) << "no cache" << std::setw(14) << "cache write" << std::setw(14) << "cache read" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    printRow("read times", noCache.phases.readTimes, cacheWrite.phases.readTimes, cacheRead.phases.readTimes);
+    printRow("read mesh", noCache.phases.readMesh, cacheWrite.phases.readMesh, cacheRead.phases.readMesh);
+    printRow("build adjacency", noCache.phases.buildAdjacency, cacheWrite.phases.buildAdjacency, cacheRead.phases.buildAdjacency);
+    printRow("split into chunks", noCache.phases.splitIntoChunks, cacheWrite.phases.splitIntoChunks, cacheRead.phases.splitIntoChunks);
+    printRow("structure cache", noCache.phases.structureCache, cacheWrite.phases.structureCache, cacheRead.phases.structureCache);
+    printRow("spatial index", noCache.phases.buildSpatialIndex, cacheWrite.phases.buildSpatialIndex, cacheRead.phases.buildSpatialIndex);
+    printRow("total", noCache.total, cacheWrite.total, cacheRead.total);
+
+    return 0;
+}
@@ -12,7 +12,7 @@
 
 #include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
 #include "ocean_model_interfaces/fvcom/FVCOMChunk.h"
-#include "ocean_model_interfaces/util/LRUCache.h"
+#include "ocean_model_interfaces/util/ConcurrentCache.h"
 
 #include "ocean_model_interfaces/model_interface/ModelInterface.h"
 #include "ocean_model_interfaces/model_interface/ModelData.h"
@@ -24,7 +24,11 @@ namespace ocean_model_interfaces
  * Provides random access to FVCOM ocean model data. To handle the large data volumes,
  * only the model structure (location of triangles, vertical layers, and time slices )
  * is initially loaded into memory. When queried specific sections, or "chunks", of the model
- * are loaded and stored using an LRU cache.
+ * are loaded and stored using a thread safe cache.
+ *
+ * One FVCOM instance can be queried from several threads at once as long as each thread passes
+ * its own QueryContext to getData. The startLoad and endLoad functions may then be called from
+ * any of those threads.
  */
 class FVCOM : public ModelInterface
 {
@@ -65,12 +69,15 @@ public:
      * @param yChunkSize Size of a chunk in the y direction
      * @param siglayChunkSize Size of a chunk in the siglay direction
      * @param timeChunkSize Size of a chunk in the time direction
+     * @param cacheSize Maximum number of chunks kept in memory
+     * @param structureCacheFile Structure cache file to load the model structure from, see FVCOMStructure. Empty to always read the model files.
      */
     FVCOM(std::string filename, unsigned int xChunkSize, 
                                 unsigned int yChunkSize,
                                 unsigned int siglayChunkSize, 
                                 unsigned int timeChunkSize, 
-                                unsigned int cacheSize);
+                                unsigned int cacheSize,
+                                const std::string structureCacheFile = "");
 
     /**
      * Initalize FVCOM class with data from single file or directory.
@@ -86,6 +93,8 @@ public:
      * @param timeChunkSize Size of a chunk in the time direction
      * @param startLoad function to call before new data is loaded
      * @param endLoad function to call after new data is loaded
+     * @param cacheSize Maximum number of chunks kept in memory
+     * @param structureCacheFile Structure cache file to load the model structure from, see FVCOMStructure. Empty to always read the model files.
      */
     FVCOM(std::string filename,
           std::function<void(void)> startLoad,
@@ -94,7 +103,68 @@ public:
           unsigned int yChunkSize,
           unsigned int siglayChunkSize,
           unsigned int timeChunkSize,
-          unsigned int cacheSize);
+          unsigned int cacheSize,
+          const std::string structureCacheFile = "");
+
+    FVCOM(FVCOM&& other) = default;
+    FVCOM& operator=(FVCOM&& other) = default;
+
+    /**
+     * Stops any prefetches before the model is destroyed.
+     */
+    ~FVCOM();
+
+    /**
+     * Limits the memory used by cached chunks in addition to the number of chunks. Chunks are evicted
+     * until the cache is under the limit. The limit covers the whole cache; a chunk larger than the whole
+     * limit is used for the query but not cached.
+     * @param bytes Maximum bytes used by cached chunks. 0 removes the limit.
+     */
+    void setCacheMemoryLimit(size_t bytes);
+
+    /**
+     * @return Bytes currently used by cached chunks.
+     */
+    size_t getCacheMemoryUsage() const;
+
+    /**
+     * @return The most bytes cached chunks have used at once.
+     */
+    size_t getPeakCacheMemoryUsage() const;
+
+    /**
+     * @return The number of chunks currently cached.
+     */
+    size_t getCachedChunkCount() const;
+
+    /**
+     * Writes every chunk of the model to a chunk store, see ChunkStore. The chunks are read from the model files
+     * one at a time, without using the cache. Run once offline, then pass the store to setChunkStore in every
+     * process that uses the model with the same chunk sizes.
+     * @param filename Path of the chunk store to write
+     *
+     * @throws std::runtime_error if the store can not be written
+     */
+    void writeChunkStore(const std::string& filename);
+
+    /**
+     * Loads chunks from a chunk store instead of the model files. Loading a chunk from a store does not copy
+     * or convert any values, and the store's pages are shared with every other process that maps it. Chunks
+     * loaded before the store was set stay cached. Waits for queued prefetches, and must not be called while
+     * other threads are querying the model.
+     * @param filename Chunk store written by writeChunkStore. Empty to load chunks from the model files again.
+     *
+     * @throws std::runtime_error if the store can not be mapped or was written for a different chunk layout
+     */
+    void setChunkStore(const std::string& filename);
+
+    /**
+     * Reads chunks through a different storage backend, for example a MemoryStorageBackend holding the model
+     * variables. A chunk store set with setChunkStore is still used first. Chunks loaded before the backend was
+     * set stay cached. Waits for queued prefetches, and must not be called while other threads are querying the model.
+     * @param backend The backend to read chunks from
+     */
+    void setStorageBackend(std::shared_ptr<StorageBackend> backend);
 
 protected:
     /**
@@ -112,6 +182,12 @@ protected:
      */
     const ModelData getDataHelper(double x, double y, double z, double time) override;
 
+    /**
+     * Same as getDataHelper, but starts the triangle, siglay and time searches from the hints in context
+     * and updates them for the next query.
+     */
+    const ModelData getDataHelperWithContext(double x, double y, double z, double time, QueryContext& context) override;
+
     /**
      * Helper function implementation from the ModelInterface class. Handles requests that are outside
      * the model bounds. All returned model data is NaN with depths taken from the nearest node, if outside
@@ -128,8 +204,42 @@ protected:
      */
     const ModelData getDataOutOfRangeHelper(double x, double y, double z, double time) override;
 
+    /**
+     * Same as getDataOutOfRangeHelper, but starts the triangle search from the hint in context.
+     */
+    const ModelData getDataOutOfRangeHelperWithContext(double x, double y, double z, double time, QueryContext& context) override;
+
+    /**
+     * Batch helper implementation from the ModelInterface class. Locates every point first, sharing search
+     * hints between consecutive points, then interpolates the points grouped by the chunk holding their
+     * containing triangle so each chunk is looked up and loaded together. Both steps are split between
+     * getBatchThreadCount() threads, with each chunk group handled by a single thread.
+     */
+    void getDataBatchHelper(const double* x, const double* y, const double* z, const double* time, size_t n, ModelDataSoA& out) override;
+
+    /**
+     * Prefetch helper implementation from the ModelInterface class. Queues every chunk within radius of (x,y),
+     * for the siglays around z and the time slices from time to time + timeWindow, that is not already cached.
+     * If (x,y) is outside of the model all siglays are loaded.
+     */
+    void prefetchHelper(double x, double y, double z, double time, double radius, double timeWindow) override;
+
 private:
 
+    /**
+     * The triangle, siglay and time brackets a point is interpolated between.
+     */
+    struct Location
+    {
+        int containingTriangle;
+        int time1Index;
+        int time2Index;
+        double time1Percent;
+        int siglay1Index;
+        int siglay2Index;
+        double siglay1Percent;
+    };
+
     /**
      * Retrieves data located at a specific node, siglay, and time.
      * If the required data is not loaded in memory then this function will call all the necessary 
@@ -140,7 +250,7 @@ private:
      * 
      * @return The data located at the specified node.
      */
-    const FVCOMChunk::NodeData& getNodeData(int node, int siglayNodeIndex, int timeIndex);
+    FVCOMChunk::NodeData getNodeData(int node, int siglayNodeIndex, int timeIndex);
 
     /**
      * Retrieves data located at the center of a specific triangle, siglay, and time
@@ -152,16 +262,74 @@ private:
      * 
      * @return The data located at the specified triangle.
      */
-    const FVCOMChunk::TriangleData& getTriangleData(int triangle, int siglayTriangleIndex, int timeIndex);
+    FVCOMChunk::TriangleData getTriangleData(int triangle, int siglayTriangleIndex, int timeIndex);
+
+    /**
+     * Chunks are shared between the cache and the queries reading them, so a chunk evicted while a
+     * query is still reading it stays alive until the query releases it.
+     */
+    typedef std::shared_ptr<const FVCOMChunk> ChunkHandle;
+
+    /**
+     * Returns a chunk from the cache, loading it if it is not cached.
+     * @param chunkInfo The chunk to get
+     *
+     * @return A handle that keeps the chunk in memory for as long as it is held.
+     */
+    ChunkHandle getChunk(const FVCOMStructure::ChunkInfo& chunkInfo);
+
+    /**
+     * Reads a chunk from the chunk store if one is set, otherwise from the model files, without calling the load functions.
+     * @param chunkInfo The chunk to read
+     *
+     * @return The read chunk.
+     */
+    ChunkHandle readChunk(const FVCOMStructure::ChunkInfo& chunkInfo);
+
+    /**
+     * Reads a chunk from the model files, even if a chunk store is set.
+     * @param chunkInfo The chunk to read
+     *
+     * @return The read chunk.
+     */
+    ChunkHandle readChunkFromModelFiles(const FVCOMStructure::ChunkInfo& chunkInfo);
+
+    /**
+     * Loads a chunk from permanent storage, calling startLoad and endLoad around the load.
+     * @param chunkInfo The chunk to load
+     *
+     * @return The loaded chunk.
+     */
+    ChunkHandle loadChunk(const FVCOMStructure::ChunkInfo& chunkInfo);
 
     /**
      * Retreives the interpolated model data at a specified model point and time
      * @param interpolatedPoint The point to interpolate at
      * @param time The time to interpolate at
+     * @param context Search hints for this query
      * 
      * @return The interpolated data.
      */
-    ModelData interpolate(Point p, double time);
+    ModelData interpolate(Point p, double time, QueryContext& context);
+
+    /**
+     * Finds the containing triangle and the siglay and time brackets for a point inside the model.
+     * @param interpolatePoint The point to locate
+     * @param time The time to locate
+     * @param context Search hints for this query
+     *
+     * @return The location of the point in the model.
+     */
+    Location locate(Point interpolatePoint, double time, QueryContext& context);
+
+    /**
+     * Interpolates the model data at a point that has already been located.
+     * @param interpolatePoint The point to interpolate at
+     * @param location The location of the point from locate
+     *
+     * @return The interpolated data.
+     */
+    ModelData interpolate(Point interpolatePoint, const Location& location);
 
     /**
      * Performs XY barycentric linear interpolation of the model variables stored at the 
@@ -198,9 +366,12 @@ private:
     const double areaOfTriangle(const Point& p1, const Point& p2, const Point& p3) const;
 
 private:
-    LRUCache<unsigned int, FVCOMChunk> chunkCache;
+    ConcurrentCache<unsigned int, ChunkHandle> chunkCache;
     FVCOMStructure structure;
 
+    //Chunks are read from here instead of the model files when set
+    std::shared_ptr<const ChunkStore> chunkStore;
+
     std::function<void(void)> startLoad;
     std::function<void(void)> endLoad;
 
@@ -1,12 +1,13 @@
 #ifndef FVCOM_CHUNK_H
 #define FVCOM_CHUNK_H
 
-#include <unordered_map>
 #include <vector>
-
-#include <netcdf>
+#include <string>
+#include <memory>
 
 #include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
+#include "ocean_model_interfaces/util/StorageBackend.h"
+#include "ocean_model_interfaces/util/ChunkStore.h"
 namespace ocean_model_interfaces
 {
 
@@ -47,37 +48,95 @@ public:
         double w;
     };
 
-    typedef std::vector<FVCOMChunk::NodeData> NodeVector;
-    typedef std::vector<FVCOMChunk::TriangleData> TriangleVector;
+    /**
+     * Variables stored in a chunk, in the order they are written to a chunk store.
+     * TEMP, SALT and DYE are stored at nodes, U, V and W at triangles.
+     */
+    enum Variable
+    {
+        TEMP,
+        SALT,
+        DYE,
+        U,
+        V,
+        W,
+        NUM_VARIABLES
+    };
+
+    /**
+     * @return The model file name of each variable, indexed by Variable. Chunk stores use the same names.
+     */
+    static const std::vector<std::string>& getVariableNames();
 
     /**
      * @param modelFiles File information for all files used by the model.
      * @param nodesToLoad List of nodes that are contained in this chunk
      * @param trianglesToLoad List of triangles that are contained in this chunk.
      * @param chunkInfo The chunk id and the location of the chunk in the larger model.
+     * @param backend Storage to read the model files from. Usually the structure's backend.
+     * @param nodeFileIndices Index in the model files of each node in nodesToLoad. Empty if the files were not reordered.
+     * @param triangleFileIndices Index in the model files of each triangle in trianglesToLoad. Empty if the files were not reordered.
      */
     FVCOMChunk(const std::vector<FVCOMStructure::ModelFile> modelFiles, std::vector<unsigned int> nodesToLoad,
                                                std::vector<unsigned int> trianglesToLoad,
-                                               FVCOMStructure::ChunkInfo chunkInfo);
+                                               FVCOMStructure::ChunkInfo chunkInfo,
+                                               StorageBackend& backend,
+                                               const std::vector<unsigned int>& nodeFileIndices = std::vector<unsigned int>(),
+                                               const std::vector<unsigned int>& triangleFileIndices = std::vector<unsigned int>());
+
+    /**
+     * Uses the values of a chunk in a chunk store written by FVCOM::writeChunkStore without copying them.
+     * The chunk keeps the store mapped for as long as it exists.
+     * @param store The chunk store to read from
+     * @param chunkInfo The chunk id and the location of the chunk in the larger model.
+     * @param numNodes Number of nodes in the chunk
+     * @param numTriangles Number of triangles in the chunk
+     *
+     * @throws std::out_of_range if the store does not have the chunk
+     * @throws std::runtime_error if the stored values do not fit the chunk
+     */
+    FVCOMChunk(std::shared_ptr<const ChunkStore> store, FVCOMStructure::ChunkInfo chunkInfo, size_t numNodes, size_t numTriangles);
+
+    //The value pointers may point into the chunk's own buffer, so chunks are not copied
+    FVCOMChunk(const FVCOMChunk& other) = delete;
+    FVCOMChunk& operator=(const FVCOMChunk& other) = delete;
 
 
     /**
      * Retrieve data that is stored at nodes.
-     * @param node The node index to retrieve data for
+     * @param node Index of the node inside this chunk, its position in nodesToLoad
      * @param siglay The siglay index to retrieve data at
      * @param time The time index to retrieve data at
      * @return Data at a specific node, siglay, and time index. All indcies are assumed to be valid for this chunk.
      */
-    const FVCOMChunk::NodeData& getNodeData(const unsigned int node, const unsigned int siglay, const unsigned int time);
+    FVCOMChunk::NodeData getNodeData(const unsigned int node, const unsigned int siglay, const unsigned int time) const;
 
     /**
      * Retrieve data that is stored at triangles.
-     * @param triangle The triangle index to retrieve data for
+     * @param triangle Index of the triangle inside this chunk, its position in trianglesToLoad
      * @param siglay The siglay index to retrieve data at
      * @param time The time index to retrieve data at
      * @return Data at a specific triangle, siglay, and time index. All indcies are assumed to be valid for this chunk.
      */
-    const FVCOMChunk::TriangleData& getTriangleData(const unsigned int triangle, const unsigned int siglay, const unsigned int time);
+    FVCOMChunk::TriangleData getTriangleData(const unsigned int triangle, const unsigned int siglay, const unsigned int time) const;
+
+    /**
+     * @param variable The variable to get
+     * @return The values of a variable for each node or triangle in the chunk, laid out as [element][time][siglay].
+     */
+    const float* getValues(Variable variable) const;
+
+    /**
+     * @param variable The variable to count
+     * @return The number of values returned by getValues for the variable.
+     */
+    size_t getNumValues(Variable variable) const;
+
+    /**
+     * @return The memory used by this chunk in bytes. Values read from a chunk store are in the shared
+     * page cache instead of the chunk and are not counted.
+     */
+    size_t getMemoryUsage() const;
 
 private:
     /**
@@ -85,9 +144,26 @@ private:
      */
     const unsigned int getFileIndexForTimeIndex(const std::vector<FVCOMStructure::ModelFile>& modelFiles, const unsigned int timeIndex) const;
 
+    /**
+     * @return The index in the data arrays of the value for a node or triangle at a siglay and time.
+     */
+    unsigned int getValueIndex(const unsigned int element, const unsigned int siglay, const unsigned int time) const;
+
 private:
-    std::unordered_map<unsigned int, FVCOMChunk::NodeVector> nodes;
-    std::unordered_map<unsigned int, FVCOMChunk::TriangleVector> triangles;
+    //Data for each node and triangle in the order they were listed to load, laid out as
+    //[element][time][siglay] so the values used by one interpolation are close together.
+    //Points into loadedValues or into a mapped chunk store.
+    const float* values[NUM_VARIABLES];
+    size_t numValues[NUM_VARIABLES];
+
+    //Every variable read from the model files, one after the other. Empty for chunks from a chunk store.
+    std::vector<float> loadedValues;
+
+    //Keeps a chunk store mapped while values points into it
+    std::shared_ptr<const ChunkStore> store;
+
+    //Number of values stored for each node or triangle
+    unsigned int valuesPerElement;
 
     const FVCOMStructure::ChunkInfo chunkInfo;
 };
@@ -3,6 +3,11 @@
 
 #include "ocean_model_interfaces/util/Plane.h"
 #include "ocean_model_interfaces/util/Point.h"
+#include "ocean_model_interfaces/util/KDTree.h"
+#include "ocean_model_interfaces/util/BoundingVolumeHierarchy.h"
+#include "ocean_model_interfaces/util/NetCDFFilePool.h"
+#include "ocean_model_interfaces/util/StorageBackend.h"
+#include "ocean_model_interfaces/model_interface/QueryContext.h"
 
 #include <list>
 #include <unordered_map>
@@ -19,6 +24,7 @@ namespace ocean_model_interfaces
 /**
  * Class used to load and query FVCOM structure data. This data is always stored in memory
  * and is used to determine what chunks need to be loaded to retrieve specific parts of the model.
+ * Queries do not modify the structure, search hints are kept in a QueryContext owned by the caller.
  */
 class FVCOMStructure
 {
@@ -36,6 +42,22 @@ public:
      */
     FVCOMStructure(const std::string filename, int xChunkSize, int yChunkSize, int siglayChunkSize, int timeChunkSize);
 
+    /**
+     * Initalize FVCOMStructure class with data from file, reusing a structure cache file written by an
+     * earlier run when it matches. The cache holds everything read from the model files and the chunk
+     * membership lists, so loading from it skips reading the model files. It is used only if it was
+     * written for the same chunk sizes and the same model files, with the same sizes and modification
+     * times. Otherwise the structure is loaded from the model files and the cache file is rewritten.
+     * @param filename Single file or directory to load
+     * @param xChunkSize Size of a chunk in the x direction
+     * @param yChunkSize Size of a chunk in the y direction
+     * @param siglayChunkSize Size of a chunk in the siglay direction
+     * @param timeChunkSize Size of a chunk in the time direction
+     * @param structureCacheFile Path of the structure cache file. An empty path disables the cache.
+     */
+    FVCOMStructure(const std::string filename, int xChunkSize, int yChunkSize, int siglayChunkSize, int timeChunkSize,
+                   const std::string structureCacheFile);
+
     /**
      * Initalize FVCOMStructure class with no data
      */
@@ -63,6 +85,31 @@ public:
         unsigned int timeSize;
     };
 
+    /**
+     * Wall time in seconds spent in each phase of loading the structure. Phases that were
+     * skipped because the structure came from a structure cache are 0.
+     */
+    struct LoadTimes
+    {
+        //Reading the time axis of every model file
+        double readTimes = 0;
+
+        //Reading the mesh and siglay depths from the first model file
+        double readMesh = 0;
+
+        //Listing the triangles around each node
+        double buildAdjacency = 0;
+
+        //Sorting the nodes and triangles into chunks
+        double splitIntoChunks = 0;
+
+        //Checking, reading, and writing the structure cache file
+        double structureCache = 0;
+
+        //Building the KD tree and bounding volume hierarchy
+        double buildSpatialIndex = 0;
+    };
+
     /**
      * Contains information about each netCDF file that makes up the model.
      */
@@ -101,24 +148,36 @@ public:
     bool pointInTriangle(Point testPoint, int triangle) const;
 
     /**
-     * Finds the triangle which contains the specified point. This requires searching through all
-     * triangles.
+     * Finds the triangle which contains the specified point. The triangles around the closest node
+     * are checked first, then the bounding volume hierarchy of all triangles.
      * @param testPoint Point to get containing triangle for
      * 
      * @return The index of the containing triangle
      */
-    int getContainingTriangle(Point testPoint);
+    int getContainingTriangle(Point testPoint) const;
+
+    /**
+     * Finds the triangle which contains the specified point. The last containing triangle stored in
+     * context is checked first, then the search continues as in getContainingTriangle(Point).
+     * The containing triangle is stored in context for the next query.
+     * @param testPoint Point to get containing triangle for
+     * @param context Search hints for this query
+     * 
+     * @return The index of the containing triangle
+     */
+    int getContainingTriangle(Point testPoint, QueryContext& context) const;
 
     /**
      * Finds the triangle which contains the specified point. Prioritizes checking of triangles
      * that are adjacent to closestNode to avoid searching the entire model. If not contained in those
-     * adjacent triangles then the entire model will be searched.
+     * adjacent triangles then every triangle whose bounding box contains the point is checked.
+     * Throws std::out_of_range if no triangle contains the point.
      * @param testPoint Point to get containing triangle for
      * @param closestNode The index of the node that is expected to be adjacent to the containing triangle
      * 
      * @return The index of the containing triangle
      */
-    int getContainingTriangle(Point testPoint, int closestNode);
+    int getContainingTriangle(Point testPoint, int closestNode) const;
 
     /**
      * Gets the nodes that form the specified triangle.
@@ -145,7 +204,8 @@ public:
     Plane getTrianglePlane(int triange) const;
 
     /**
-     * Finds the closest node to a point.
+     * Finds the closest node to a point using a k-d tree built when the structure is loaded.
+     * If multiple nodes are the same distance away the lowest node index is returned.
      * @param testPoint Point to get the closest node for
      * 
      * @return The index of the node closest to testPoint
@@ -185,6 +245,14 @@ public:
      */
      int getPreviousTimeIndex(double time) const;
 
+     /**
+     * Gets the time index that is previous to the given time, checking the time bracket stored in context first.
+     * @param time time to find the previous index for
+     * @param context Search hints for this query, updated with the found index
+     * @return index for the previous time
+     */
+     int getPreviousTimeIndex(double time, QueryContext& context) const;
+
      /**
       * Gets time for a specific index
       * @return Time in units specified by the netCDF files.
@@ -227,6 +295,40 @@ public:
      */
     FVCOMStructure::ChunkInfo getChunkForTriangle(int triangle, int siglay, int time) const;
 
+    /**
+     * Gets every chunk that holds data for nodes or triangles in an XY region, for a range of siglays and times.
+     * The region is clamped to the model extent and chunks without any nodes or triangles are skipped.
+     * @param minX Minimum x of the region
+     * @param minY Minimum y of the region
+     * @param maxX Maximum x of the region
+     * @param maxY Maximum y of the region
+     * @param siglayStart First siglay index
+     * @param siglayEnd Last siglay index
+     * @param startTime Start of the time range, in the units of the model files
+     * @param endTime End of the time range, in the units of the model files
+     * @return The chunks in the region, ordered by time then siglay so earlier times come first.
+     */
+    std::vector<FVCOMStructure::ChunkInfo> getChunksInRegion(double minX, double minY, double maxX, double maxY,
+                                                             unsigned int siglayStart, unsigned int siglayEnd,
+                                                             double startTime, double endTime) const;
+
+    /**
+     * @return Every chunk that holds data for nodes or triangles, for all siglays and times.
+     */
+    std::vector<FVCOMStructure::ChunkInfo> getAllChunks() const;
+
+    /**
+     * @return The number of chunk ids, one more than the largest id. Includes chunks without any nodes or triangles.
+     */
+    unsigned int getNumChunks() const;
+
+    /**
+     * Describes how the model is split into chunks. Structures with the same key have the same chunk ids,
+     * and the same nodes and triangles in the same order in each chunk.
+     * @return The layout key.
+     */
+    std::string getChunkLayoutKey() const;
+
     /**
      * Gets a vector of all node indicies that are contained in a chunk
      * @param chunk The chunk to get the vector of nodes indicies for.
@@ -241,18 +343,68 @@ public:
      */
     const std::vector<unsigned int>& getTrianglesInChunk(FVCOMStructure::ChunkInfo chunk) const;
 
+    /**
+     * Gets the position of a node in the list returned by getNodesInChunk for the chunk containing it.
+     * Chunks store their data in that order.
+     * @param node The node index
+     * @return Index of the node inside its chunk.
+     */
+    const unsigned int getNodeIndexInChunk(unsigned int node) const;
+
+    /**
+     * Gets the position of a triangle in the list returned by getTrianglesInChunk for the chunk containing it.
+     * Chunks store their data in that order.
+     * @param triangle The triangle index
+     * @return Index of the triangle inside its chunk.
+     */
+    const unsigned int getTriangleIndexInChunk(unsigned int triangle) const;
+
     /**
      * Get information on all files that make up the model.
      * @return List of all files that make up the model.
      */
     const std::vector<ModelFile> getModelFiles() const;
 
+    /**
+     * @return The time spent in each phase of loading this structure.
+     */
+    const LoadTimes& getLoadTimes() const;
+
+    /**
+     * Get the pool of open model files. Copies of a structure share the same pool.
+     * It must only be used while holding getNetCDFMutex().
+     * @return The file handle pool used to read the model files.
+     */
+    NetCDFFilePool& getFilePool() const;
+
+    /**
+     * Get the backend chunks read their data from. By default it reads the model files through the file pool.
+     * Copies of a structure share the same backend.
+     * @return The storage backend used to load chunks.
+     */
+    StorageBackend& getStorageBackend() const;
+
+    /**
+     * Replace the backend chunks read their data from, for example with a MemoryStorageBackend in tests.
+     * The structure itself is always loaded from the model files.
+     * @param backend The new storage backend
+     */
+    void setStorageBackend(std::shared_ptr<StorageBackend> backend);
+
     /**
      * Determines if a point is in the model.
      * @param p The point to check
      * @param time The time to check at.
      */
-    const bool pointInModel(Point p, double time);
+    const bool pointInModel(Point p, double time) const;
+
+    /**
+     * Determines if a point is in the model using the search hints in context.
+     * @param p The point to check
+     * @param time The time to check at.
+     * @param context Search hints for this query
+     */
+    const bool pointInModel(Point p, double time, QueryContext& context) const;
 
     /**
      * Determines if a specific time is in the model.
@@ -262,7 +414,12 @@ public:
     /**
      * Determines if the depth value of a point is in the model.
      */
-    const bool depthInModel(Point p);
+    const bool depthInModel(Point p) const;
+
+    /**
+     * Determines if the depth value of a point is in the model using the search hints in context.
+     */
+    const bool depthInModel(Point p, QueryContext& context) const;
 
     /**
      * Determines if the xy value of a point is in the model.
@@ -274,6 +431,39 @@ public:
      */
     const unsigned int getNumSiglays() const;
 
+    /**
+     * @return The number of nodes in the model.
+     */
+    const unsigned int getNumNodes() const;
+
+    /**
+     * @return The number of triangles in the model.
+     */
+    const unsigned int getNumTriangles() const;
+
+    /**
+     * @return The number of time slices in the model.
+     */
+    const unsigned int getNumTimes() const;
+
+    /**
+     * @return True if the model files were renumbered by scripts/fvcom_spatial_reorder.py. Node and triangle
+     * indices used by the structure are always the original ones, so only reads from the files need the file indices.
+     */
+    const bool isReordered() const;
+
+    /**
+     * @param node Original index of a node
+     * @return The index of the node in the model files.
+     */
+    const unsigned int getNodeFileIndex(unsigned int node) const;
+
+    /**
+     * @param triangle Original index of a triangle
+     * @return The index of the triangle in the model files.
+     */
+    const unsigned int getTriangleFileIndex(unsigned int triangle) const;
+
     /**
      * Gets the index and percentage for linear interpolation of time
      * @param time Time to interpolate with
@@ -283,6 +473,16 @@ public:
      */
     void timeInterpolation(double time, int& time1Index, int& time2Index, double& time1Percent) const;
 
+    /**
+     * Gets the index and percentage for linear interpolation of time, checking the time bracket stored in context first.
+     * @param time Time to interpolate with
+     * @param time1Index Output for the first time index for interpolation
+     * @param time2Index Output for the second time index for the interpolation
+     * @param time1Percent Output for the percent for time1Index for interpolation
+     * @param context Search hints for this query
+     */
+    void timeInterpolation(double time, int& time1Index, int& time2Index, double& time1Percent, QueryContext& context) const;
+
     /**
      * Gets the index and percentage for linear interpolation of time
      * @param interpolatePoint Point to interpolate with
@@ -290,7 +490,7 @@ public:
      * @param siglay2Index Output for the second siglay index for the interpolation
      * @param siglay1Percent Output for the percent for siglay1Index for interpolation
      */
-    void siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent);
+    void siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent) const;
 
     /**
      * Gets the index and percentage for linear interpolation of time. Use the provided containing triangle to avoid re-searching.
@@ -300,7 +500,19 @@ public:
      * @param siglay1Percent Output for the percent for siglay1Index for interpolation
      * @param containingTriangle The triangle that the interpolatePoint is inside.
      */
-    void siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent, int containingTriangle);
+    void siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent, int containingTriangle) const;
+
+    /**
+     * Gets the index and percentage for linear interpolation of siglay. The siglay bracket stored in context is
+     * checked first, if the point is not strictly inside it all siglays are searched.
+     * @param interpolatePoint Point to interpolate with
+     * @param siglay1Index Output for the first siglay index for interpolation
+     * @param siglay2Index Output for the second siglay index for the interpolation
+     * @param siglay1Percent Output for the percent for siglay1Index for interpolation
+     * @param containingTriangle The triangle that the interpolatePoint is inside.
+     * @param context Search hints for this query
+     */
+    void siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent, int containingTriangle, QueryContext& context) const;
 
 
     /**
@@ -309,14 +521,22 @@ public:
     *@param containingTriangle Containing triangle for this point
     *@return Depth at this point. Note this will be a positive number
     **/
-    double getDepthAtPoint(Point& interpolatePoint, int containingTriangle);
+    double getDepthAtPoint(Point& interpolatePoint, int containingTriangle) const;
 
     /**
     * Gets the depth at a specific point.
     * @param interpolatePoint Point to get depth at
     * @return Depth at this point. Note this will be a positive number
     **/
-    double getDepthAtPoint(Point& interpolatePoint);
+    double getDepthAtPoint(Point& interpolatePoint) const;
+
+    /**
+    * Gets the depth at a specific point using the search hints in context.
+    * @param interpolatePoint Point to get depth at
+    * @param context Search hints for this query
+    * @return Depth at this point. Note this will be a positive number
+    **/
+    double getDepthAtPoint(Point& interpolatePoint, QueryContext& context) const;
 
 private:
 
@@ -325,6 +545,34 @@ private:
      */
     void loadStructureData(const std::string directory);
 
+    /**
+     * Helper function which reads the original numbering from reordered model files and puts
+     * the structure data loaded in file order back into the original order
+     */
+    void loadFilePermutation(netCDF::NcFile& dataFile);
+
+    /**
+     * Helper function which describes the model files and chunk sizes a structure cache was written for
+     */
+    std::string getStructureCacheKey(const std::string filename) const;
+
+    /**
+     * Helper function which loads the structure and chunk membership from a structure cache file
+     *
+     * @return False if the file does not exist, is not valid, or was written for a different key.
+     */
+    bool readStructureCache(const std::string cacheFile, const std::string& key, const std::string filename);
+
+    /**
+     * Helper function which writes the structure and chunk membership to a structure cache file
+     */
+    void writeStructureCache(const std::string cacheFile, const std::string& key) const;
+
+    /**
+     * Helper function which removes any structure data so it can be loaded again
+     */
+    void clearStructureData();
+
     /**
      * Helper function that determines the extent of the model
      */
@@ -335,6 +583,26 @@ private:
      */
     void splitIntoChunks();
 
+    /**
+     * Helper function which fills in the ChunkInfo for a chunk from its index in each dimension
+     */
+    FVCOMStructure::ChunkInfo getChunkInfo(unsigned int xChunk, unsigned int yChunk, unsigned int siglayChunk, unsigned int timeChunk) const;
+
+    /**
+     * Helper function which builds the spatial indices used to find the nodes and triangles near a point
+     */
+    void buildSpatialIndex();
+
+    /**
+     * Helper function which determines if a point is strictly between siglay siglay1Index and siglay1Index + 1
+     */
+    bool siglayBracketContains(const Point& interpolatePoint, int containingTriangle, int siglay1Index) const;
+
+    /**
+     * Helper function which searches all siglays for the ones above and below a point
+     */
+    void findSiglayBracket(const Point& interpolatePoint, int containingTriangle, int& siglay1Index, int& siglay2Index) const;
+
 private:
 
     /**
@@ -342,6 +610,28 @@ private:
      */
     std::vector<ModelFile> modelFiles;
 
+    /**
+     * Index in the model files of each node and triangle, by original index.
+     * Empty if the files use the original numbering.
+     */
+    std::vector<unsigned int> nodeFileIndices;
+    std::vector<unsigned int> triangleFileIndices;
+
+    /**
+     * Open handles to the model files, shared with the chunks loaded from them
+     */
+    std::shared_ptr<NetCDFFilePool> filePool;
+
+    /**
+     * Source of chunk data, shared with copies of the structure
+     */
+    std::shared_ptr<StorageBackend> storageBackend;
+
+    /**
+     * Time spent in each phase of loading
+     */
+    LoadTimes loadTimes;
+
     /**
      * Number of sigma layers
      */
@@ -398,6 +688,21 @@ private:
      */
     std::vector<std::vector<unsigned int>> trianglesInChunk;
 
+    /**
+     * The position of each node in nodesInChunk and each triangle in trianglesInChunk
+     */
+    std::vector<unsigned int> nodeIndexInChunk;
+    std::vector<unsigned int> triangleIndexInChunk;
+
+    /**
+     * Spatial index over the x,y of each node
+     */
+    KDTree nodeTree;
+
+    /**
+     * Spatial index over the bounding box of each triangle
+     */
+    BoundingVolumeHierarchy triangleTree;
 
     // X,Y extent of the model
     double minX = std::numeric_limits<double>::max();
@@ -416,9 +721,6 @@ private:
     unsigned int timeDimChunks;
     unsigned int yDimChunks;
     unsigned int xDimChunks;
-
-    //Used in optimizations
-    unsigned int lastContainingTriangle;
 };
 
 }
@@ -0,0 +1,62 @@
+#ifndef SYNTHETIC_FVCOM_H
+#define SYNTHETIC_FVCOM_H
+
+#include <string>
+#include <memory>
+
+#include "ocean_model_interfaces/util/SyntheticStorageBackend.h"
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Size and layout of a synthetic FVCOM model. The defaults make a small model that writes in well under a second.
+ */
+struct SyntheticFVCOMParameters
+{
+    //Nodes are on a jittered nodesX by nodesY grid, with two triangles in each grid cell
+    unsigned int nodesX = 100;
+    unsigned int nodesY = 100;
+
+    //Distance between neighbouring nodes in meters
+    double nodeSpacing = 100;
+
+    unsigned int siglays = 10;
+    unsigned int timeSteps = 24;
+
+    //Number of time steps in each file, the last file holds the rest
+    unsigned int timeStepsPerFile = 24;
+
+    //Days between time steps, the first step is at day 0
+    double timeStep = 1.0 / 24.0;
+
+    //Write the values of temp, salinity, DYE, u, v and ww. When false those variables are only declared, so
+    //the files stay small at any size, and chunks must be read through createSyntheticFVCOMBackend.
+    bool writeData = true;
+};
+
+/**
+ * Writes a synthetic FVCOM model that FVCOM and FVCOMStructure load like any other model. The mesh covers
+ * about nodesX * nodeSpacing by nodesY * nodeSpacing meters centered on 0, 0, with a smoothly varying depth.
+ * Files are named synthetic_fvcom_<n>.nc and replace any with the same name, so use an empty or new directory.
+ * A directory on a tmpfs such as /dev/shm keeps the whole model in memory.
+ *
+ * @param directory Directory to write the model to, created if it does not exist
+ * @param parameters Size of the model
+ *
+ * @throws std::runtime_error if the parameters describe an empty model
+ */
+void writeSyntheticFVCOM(const std::string& directory, const SyntheticFVCOMParameters& parameters);
+
+/**
+ * Creates a backend that computes the data variables of a synthetic FVCOM model. It gives the same values as
+ * the files written by writeSyntheticFVCOM with the same parameters, so pass it to FVCOM::setStorageBackend
+ * to load chunks without any file reads, or when the files were written without data.
+ *
+ * @param parameters Size of the model, the same as it was written with
+ * @return The backend for the model.
+ */
+std::shared_ptr<SyntheticStorageBackend> createSyntheticFVCOMBackend(const SyntheticFVCOMParameters& parameters);
+
+}
+#endif
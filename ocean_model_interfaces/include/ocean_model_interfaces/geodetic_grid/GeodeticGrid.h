@@ -13,7 +13,7 @@
 #include "ocean_model_interfaces/geodetic_grid/GeodeticGridStructure.h"
 #include "ocean_model_interfaces/geodetic_grid/GeodeticGridParameters.h"
 #include "ocean_model_interfaces/geodetic_grid/GeodeticGridChunk.h"
-#include "ocean_model_interfaces/util/LRUCache.h"
+#include "ocean_model_interfaces/util/ConcurrentCache.h"
 
 #include "ocean_model_interfaces/model_interface/ModelInterface.h"
 #include "ocean_model_interfaces/model_interface/ModelData.h"
@@ -25,7 +25,10 @@ namespace ocean_model_interfaces
  * Provides random access to FVCOM ocean model data. To handle the large data volumes,
  * only the model structure (location of triangles, vertical layers, and time slices )
  * is initially loaded into memory. When queried specific sections, or "chunks", of the model
- * are loaded and stored using an LRU cache.
+ * are loaded and stored using a thread safe cache.
+ *
+ * One GeodeticGrid instance can be queried from several threads at once as long as each thread passes
+ * its own QueryContext to getData. The load functions may then be called from any of those threads.
  */
 class GeodeticGrid : public ModelInterface
 {
@@ -41,6 +44,14 @@ public:
      */
     GeodeticGrid(GeodeticGridParameters parameters);
 
+    GeodeticGrid(GeodeticGrid&& other) = default;
+    GeodeticGrid& operator=(GeodeticGrid&& other) = default;
+
+    /**
+     * @brief Stops any prefetches before the model is destroyed.
+     */
+    ~GeodeticGrid();
+
     /**
      * @brief Sets the functions that are called before and after data is loaded
      * 
@@ -49,12 +60,67 @@ public:
      */
     void setLoadFunction(std::function<void(void)> startLoad, std::function<void(void)> endLoad);
 
-    const ModelData getDataAtIndex(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex);
+    /**
+     * Limits the memory used by cached chunks in addition to the number of chunks. Chunks are evicted
+     * until the cache is under the limit. The limit covers the whole cache; a chunk larger than the whole
+     * limit is used for the query but not cached.
+     * @param bytes Maximum bytes used by cached chunks. 0 removes the limit.
+     */
+    void setCacheMemoryLimit(size_t bytes);
+
+    /**
+     * @return Bytes currently used by cached chunks.
+     */
+    size_t getCacheMemoryUsage() const;
+
+    /**
+     * @return The most bytes cached chunks have used at once.
+     */
+    size_t getPeakCacheMemoryUsage() const;
 
-    const ModelData getData(double x, double y, double z, double time) override;
-    const ModelData getDataOutOfRange(double x, double y, double z, double time) override;
+    /**
+     * @return The number of chunks currently cached.
+     */
+    size_t getCachedChunkCount() const;
+
+    /**
+     * @brief Writes every chunk of the model to a chunk store, see ChunkStore. The chunks are read from the
+     * model files one at a time, without using the cache. Run once offline, then pass the store to setChunkStore
+     * in every process that uses the model with the same chunk sizes.
+     *
+     * @param filename Path of the chunk store to write
+     * @throws std::runtime_error if the store can not be written
+     */
+    void writeChunkStore(const std::string& filename);
+
+    /**
+     * @brief Loads chunks from a chunk store instead of the model files. The store is mapped, so its pages are
+     * shared with every other process using it. Chunks loaded before the store was set stay cached. Waits for
+     * queued prefetches, and must not be called while other threads are querying the model.
+     *
+     * @param filename Chunk store written by writeChunkStore. Empty to load chunks from the model files again.
+     * @throws std::runtime_error if the store can not be mapped or was written for a different chunk layout
+     */
+    void setChunkStore(const std::string& filename);
+
+    /**
+     * @brief Reads chunks through a different storage backend, for example a MemoryStorageBackend holding the
+     * model variables. A chunk store set with setChunkStore is still used first. Chunks loaded before the backend
+     * was set stay cached. Waits for queued prefetches, and must not be called while other threads are querying the model.
+     *
+     * @param backend The backend to read chunks from
+     */
+    void setStorageBackend(std::shared_ptr<StorageBackend> backend);
+
+    const ModelData getDataAtIndex(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex);
 
 protected:
+    /**
+     * @brief Converts the requested position into longitude, latitude and depth, applying the offsets.
+     * XY requests are converted using the origin, LATLON requests are shifted by the XY offsets in meters.
+     */
+    Point toModelCoordinates(double x, double y, double z) const override;
+
     /**
      * @brief Interpolates the model at the given location. Note that x is longitude and y is latitude
      * 
@@ -77,10 +143,54 @@ protected:
      */
     const ModelData getDataOutOfRangeHelper(double x, double y, double z, double time) override;
 
+    /**
+     * @brief Batch helper implementation from the ModelInterface class. Computes the interpolation weights
+     * for every point, then reads all the grid values grouped by chunk so each chunk is visited once per batch.
+     * Each step is split between getBatchThreadCount() threads, with each chunk read by a single thread.
+     */
+    void getDataBatchHelper(const double* x, const double* y, const double* z, const double* time, size_t n, ModelDataSoA& out) override;
+
+    /**
+     * @brief Prefetch helper implementation from the ModelInterface class. Queues every chunk that is not already
+     * cached within radius meters of the longitude and latitude, for the depth layers around z and the times from
+     * time to time + timeWindow.
+     */
+    void prefetchHelper(double x, double y, double z, double time, double radius, double timeWindow) override;
+
 private:
-    LRUCache<unsigned int, GeodeticGridChunk> chunkCache;
+    /**
+     * @brief Chunks are shared between the cache and the queries reading them, so a chunk evicted while a
+     * query is still reading it stays alive until the query releases it.
+     */
+    typedef std::shared_ptr<const GeodeticGridChunk> ChunkHandle;
+
+    /**
+     * @brief Returns the chunk holding the given indicies from the cache, loading it if it is not cached.
+     * The chunk stays in memory for as long as the returned handle is held.
+     */
+    ChunkHandle getChunk(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex);
+
+    /**
+     * @brief Reads a chunk from the chunk store if one is set, otherwise from the model files, without calling the load functions.
+     */
+    ChunkHandle readChunk(const GeodeticGridStructure::ChunkInfo& info);
+
+    /**
+     * @brief Reads a chunk from the model files, even if a chunk store is set.
+     */
+    ChunkHandle readChunkFromModelFiles(const GeodeticGridStructure::ChunkInfo& info);
+
+    /**
+     * @brief Loads the chunk holding the given indicies, calling the load functions around the load.
+     */
+    ChunkHandle loadChunk(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex);
+
+    ConcurrentCache<unsigned int, ChunkHandle> chunkCache;
     GeodeticGridStructure structure;
     GeodeticGridParameters parameters;
+
+    //Chunks are read from here instead of the model files when set
+    std::shared_ptr<const ChunkStore> chunkStore;
 };
 
 }
@@ -3,6 +3,7 @@
 
 #include "ocean_model_interfaces/geodetic_grid/GeodeticGridStructure.h"
 #include "ocean_model_interfaces/model_interface/ModelData.h"
+#include "ocean_model_interfaces/util/ChunkStore.h"
 
 #include <list>
 #include <unordered_map>
@@ -21,15 +22,105 @@ namespace ocean_model_interfaces
 class GeodeticGridChunk
 {
 public:
-    GeodeticGridChunk(GeodeticGridStructure::ChunkInfo info, std::vector<GeodeticGridStructure::ModelFile>& modelFiles);
+    /**
+     * @param precision Precision the values are stored in
+     */
+    GeodeticGridChunk(GeodeticGridStructure::ChunkInfo info, std::vector<GeodeticGridStructure::ModelFile>& modelFiles, StorageBackend& backend,
+                      GeodeticGridParameters::Precision precision = GeodeticGridParameters::FLOAT64);
+
+    /**
+     * @brief Loads a chunk from a chunk store written by GeodeticGrid::writeChunkStore.
+     *
+     * @throws std::out_of_range if the store does not have the chunk
+     * @throws std::runtime_error if the stored values do not fit the chunk
+     */
+    GeodeticGridChunk(GeodeticGridStructure::ChunkInfo info, const ChunkStore& store,
+                      GeodeticGridParameters::Precision precision = GeodeticGridParameters::FLOAT64);
+
+    /**
+     * @brief Variables stored in a chunk, in the order of getVariableNames.
+     */
+    enum Variable {
+        U,
+        V,
+        W,
+        SALT,
+        TEMP,
+        DYE,
+        NUM_VARIABLES
+    };
+
+    /**
+     * @brief Names of the variables in a chunk, in the model files and in chunk stores. Indexed by Variable.
+     */
+    static const std::vector<std::string>& getVariableNames();
 
 public:
-    ModelData getData(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex);
+    /**
+     * @throws std::runtime_error if the indicies are not in this chunk
+     */
+    ModelData getData(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex) const;
+
+    /**
+     * @brief Get where the values of a grid point are stored in the chunk. The indicies are model indicies and
+     * are not checked, so they must be in this chunk.
+     */
+    size_t getOffset(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex) const;
+
+    /**
+     * @brief Add the values of every variable at a grid point times a weight to data. The sums are done in double
+     * whatever the precision of the chunk. The depth of data is not changed.
+     *
+     * @param offset Offset of the grid point from getOffset
+     */
+    void addWeightedValues(size_t offset, double weight, ModelData& data) const;
+
+    /**
+     * @brief Get a view of the values at one time index of the model, as [depth][lat][lon][variable].
+     * The view is valid as long as the chunk. T must be float for FLOAT32 chunks and double for FLOAT64 chunks.
+     *
+     * @throws std::runtime_error if the time index is not in this chunk or T is not the precision of the chunk
+     */
+    template<typename T>
+    MultiDimensionalView<const T, 4> getTimeSlice(unsigned int timeIndex) const;
+
+    GeodeticGridParameters::Precision getPrecision() const;
+
+    /**
+     * @brief Copies the values of a variable as floats, laid out as [time][depth][lat][lon].
+     */
+    std::vector<float> getValues(const std::string& variable) const;
+
+    /**
+     * @return The memory used by this chunk in bytes.
+     */
+    size_t getMemoryUsage() const;
+
+private:
+    template<typename T>
+    void loadValues(std::vector<GeodeticGridStructure::ModelFile>& modelFiles, StorageBackend& backend, MultiDimensionalVector<T, 5>& values);
+
+    template<typename T>
+    void loadValues(const ChunkStore& store, MultiDimensionalVector<T, 5>& values);
+
+    void checkTimeSlice(unsigned int timeIndex, GeodeticGridParameters::Precision slicePrecision) const;
 
 private:
     GeodeticGridStructure::ChunkInfo info;
-    std::unordered_map<std::string, MultiDimensionalVector<double>> dataFields;
+    GeodeticGridParameters::Precision precision;
+
+    //Every variable laid out as [time][depth][lat][lon][variable], so the values used for one grid point
+    //are next to each other and neighbouring longitudes are next in memory. Only the one for the precision
+    //of the chunk is allocated.
+    MultiDimensionalVector<float, 5> floatValues;
+    MultiDimensionalVector<double, 5> doubleValues;
 };
 
+template<>
+MultiDimensionalView<const float, 4> GeodeticGridChunk::getTimeSlice<float>(unsigned int timeIndex) const;
+
+template<>
+MultiDimensionalView<const double, 4> GeodeticGridChunk::getTimeSlice<double>(unsigned int timeIndex) const;
+
 }
 #endif
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <functional>
+#include <cstddef>
 
 namespace ocean_model_interfaces
 {
@@ -20,6 +21,15 @@ struct GeodeticGridParameters {
     //The size of the cache used for storing loaded chunks
     unsigned int cacheSize = 10;
 
+    //Maximum bytes used by cached chunks, in addition to cacheSize. 0 for no limit.
+    size_t cacheMemoryLimit = 0;
+
+    //Precision that chunk values and the depths of the model are stored in. Interpolation is always done
+    //in double. FLOAT32 halves the memory they use but rounds the depths and any data variable the files
+    //store as double, such as the u and v written by scripts/roms_model_regularization.py.
+    enum Precision {FLOAT32, FLOAT64};
+    Precision precision = FLOAT64;
+
     //Functions called when starting or ending loading model from disk.
     std::function<void(void)> startLoad;
     std::function<void(void)> endLoad;
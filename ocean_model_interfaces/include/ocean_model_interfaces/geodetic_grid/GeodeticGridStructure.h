@@ -14,6 +14,8 @@
 #include "ocean_model_interfaces/geodetic_grid/GeodeticGridParameters.h"
 #include "ocean_model_interfaces/util/MultiDimensionalVector.h"
 #include "ocean_model_interfaces/util/Point.h"
+#include "ocean_model_interfaces/util/NetCDFFilePool.h"
+#include "ocean_model_interfaces/util/StorageBackend.h"
 
 namespace ocean_model_interfaces
 {
@@ -73,6 +75,32 @@ public:
         bool operator<(const ModelFile& rhs) const { return startTime < rhs.startTime; }
     };
 
+    /**
+     * @brief The grid points and weights that interpolate the model at one location and time. That is at most
+     * 2 times by 2 depths by the 3 corners of the grid cell triangle around the location. It is filled in place
+     * so interpolating does not allocate.
+     */
+    struct InterpolationStencil
+    {
+        static const unsigned int MAX_POINTS = 12;
+
+        struct GridPoint
+        {
+            unsigned int timeIndex;
+            unsigned int depthIndex;
+            unsigned int latIndex;
+            unsigned int lonIndex;
+            double weight;
+        };
+
+        //Ordered by time, depth, lat and then lon index, the same order as getDataInterpolationWeights
+        GridPoint points[MAX_POINTS];
+        unsigned int size;
+
+        //The depth of the water column at the location
+        double waterColumnDepth;
+    };
+
     /**
      * @brief Get the full ChunkInfo struct for a chunk that the given indicies are in.
      */
@@ -83,6 +111,21 @@ public:
      */
     unsigned int getChunkIdFromIndicies(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex);
 
+    /**
+     * @brief Get every chunk in the model.
+     */
+    std::vector<ChunkInfo> getAllChunks();
+
+    /**
+     * @brief Get the number of chunk ids, one more than the largest id.
+     */
+    unsigned int getNumChunks() const;
+
+    /**
+     * @brief Describes how the model is split into chunks. Structures with the same key have the same chunks.
+     */
+    std::string getChunkLayoutKey() const;
+
     bool indexInRange(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex);
     bool timeInModel(double time);
     bool depthInModel(Point point);
@@ -94,28 +137,106 @@ public:
 
     std::vector<ModelFile>& getModelFiles();
 
+    /**
+     * @return The pool of open model files. Copies of a structure share the same pool.
+     * It must only be used while holding getNetCDFMutex().
+     */
+    NetCDFFilePool& getFilePool();
+
+    /**
+     * @brief Get the backend chunks read their data from. By default it reads the model files through the file pool.
+     * Copies of a structure share the same backend.
+     */
+    StorageBackend& getStorageBackend();
+
+    /**
+     * @brief Replace the backend chunks read their data from. The structure itself is always loaded from the model files.
+     */
+    void setStorageBackend(std::shared_ptr<StorageBackend> backend);
+
+    /**
+     * @brief Fill a stencil with the grid points and weights to interpolate at a location and time.
+     *
+     * @param point Longitude, latitude and depth of the location
+     * @param time Time of the location
+     * @param stencil Stencil to fill
+     *
+     * @throws std::out_of_range if the location or time is outside of the model
+     */
+    void getInterpolationStencil(Point point, double time, InterpolationStencil& stencil);
+
+    /**
+     * @brief Same as getInterpolationStencil, returning the weights by their time, depth, lat and lon index.
+     */
     std::map<std::tuple<unsigned int, unsigned int, unsigned int, unsigned int>, double> getDataInterpolationWeights(Point point, double time);
 
+    /**
+     * @brief Get every chunk holding grid points needed to interpolate inside a lon/lat box between two times.
+     * The depth layers are the ones around minPoint.z to maxPoint.z at the center of the box. The region is
+     * clamped to the model extent.
+     *
+     * @param minPoint Minimum longitude, latitude and depth of the region
+     * @param maxPoint Maximum longitude, latitude and depth of the region
+     * @param startTime Start of the time range
+     * @param endTime End of the time range
+     * @return The chunks in the region, ordered by time so earlier times come first.
+     */
+    std::vector<ChunkInfo> getChunksInRegion(Point minPoint, Point maxPoint, double startTime, double endTime);
+
 private:
     void loadStructureData();
     void loadTime();
     void determineChunksPerDimension();
 
-    std::map<unsigned int, double> getTimeInterpolationWeights(double time);
-    std::map<unsigned int, double> getDepthInterpolationWeights(Point point, std::map<std::pair<unsigned int, unsigned int>, double> xyWeights);
-    std::map<std::pair<unsigned int, unsigned int>, double> getXYInterpolationWeights(Point point);
+    //Interpolation weights along each dimension, ordered by index
+    struct TimeWeights
+    {
+        unsigned int indices[2];
+        double weights[2];
+    };
 
-    double interpolateDepthLayer(std::map<std::pair<unsigned int, unsigned int>, double> xyWeights, unsigned int layer);
+    struct DepthWeights
+    {
+        unsigned int indices[2];
+        double weights[2];
+        unsigned int size;
+    };
+
+    struct XYWeights
+    {
+        unsigned int latIndices[3];
+        unsigned int lonIndices[3];
+        double weights[3];
+    };
+
+    void getTimeInterpolationWeights(double time, TimeWeights& weights);
+    void getDepthInterpolationWeights(Point point, const XYWeights& xyWeights, DepthWeights& weights);
+    template<typename T>
+    void getDepthInterpolationWeights(const MultiDimensionalVector<T, 3>& columnDepths, Point point, const XYWeights& xyWeights, DepthWeights& weights);
+    void getXYInterpolationWeights(Point point, XYWeights& weights);
+
+    double interpolateWaterColumnDepth(const XYWeights& xyWeights);
+
+    //Unchecked reads of the depths in the precision they are stored in
+    unsigned int getDepthDim() const;
+    double getWaterColumnDepth(unsigned int latIndex, unsigned int lonIndex) const;
 
 private:
     std::vector<ModelFile> modelFiles;
+
+    //Open handles to the model files, shared with the chunks loaded from them
+    std::shared_ptr<NetCDFFilePool> filePool;
+    std::shared_ptr<StorageBackend> storageBackend;
     std::vector<double> times;
     std::vector<double> longitudes;
     std::vector<double> latitudes;
 
-    MultiDimensionalVector<double> depths;
-
-    MultiDimensionalVector<double> waterColumnDepth;
+    //Depth of each layer at each grid point, as [lat][lon][depth] so each column is contiguous, and the depth
+    //of the seafloor at each grid point. Only the ones for parameters.precision are loaded.
+    MultiDimensionalVector<float, 3> floatColumnDepths;
+    MultiDimensionalVector<double, 3> doubleColumnDepths;
+    MultiDimensionalVector<float, 2> floatWaterColumnDepth;
+    MultiDimensionalVector<double, 2> doubleWaterColumnDepth;
 
     //Size of chunks in different dimensions
     GeodeticGridParameters parameters;
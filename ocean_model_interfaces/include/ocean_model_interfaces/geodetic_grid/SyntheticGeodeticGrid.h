@@ -0,0 +1,62 @@
+#ifndef SYNTHETIC_GEODETIC_GRID_H
+#define SYNTHETIC_GEODETIC_GRID_H
+
+#include <string>
+#include <memory>
+
+#include "ocean_model_interfaces/util/SyntheticStorageBackend.h"
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * @brief Size and layout of a synthetic geodetic grid model. The defaults make a small model that writes in well under a second.
+ */
+struct SyntheticGeodeticGridParameters {
+    //Number of grid points in each dimension
+    unsigned int lats = 100;
+    unsigned int lons = 100;
+    unsigned int depths = 10;
+    unsigned int timeSteps = 24;
+
+    //Number of time steps in each file, the last file holds the rest. GeodeticGrid is only tested with one step per file.
+    unsigned int timeStepsPerFile = 1;
+
+    //Position of the south west grid point and the distance between grid points in degrees
+    double minLat = 30;
+    double minLon = -120;
+    double spacing = 0.01;
+
+    //Seconds between time steps, the first step is at 0
+    double timeStep = 3600;
+
+    //Order the depth layers from the surface down instead of from the seafloor up. Models are written both ways.
+    bool surfaceFirst = false;
+
+    //Write the values of u, v, w, salt, temp and dye_01. When false those variables are only declared, so
+    //the files stay small at any size, and chunks must be read through createSyntheticGeodeticGridBackend.
+    bool writeData = true;
+};
+
+/**
+ * @brief Writes a synthetic north aligned geodetic grid model that GeodeticGrid loads like any other model, with a
+ * smoothly varying water column depth. Files are named synthetic_grid_<n>.nc and replace any with the same name,
+ * so use an empty or new directory. A directory on a tmpfs such as /dev/shm keeps the whole model in memory.
+ *
+ * @param directory Directory to write the model to, created if it does not exist
+ * @param parameters Size of the model
+ * @throws std::runtime_error if the parameters describe an empty model
+ */
+void writeSyntheticGeodeticGrid(const std::string& directory, const SyntheticGeodeticGridParameters& parameters);
+
+/**
+ * @brief Creates a backend that computes the data variables of a synthetic geodetic grid model. It gives the same
+ * values as the files written by writeSyntheticGeodeticGrid with the same parameters, so pass it to
+ * GeodeticGrid::setStorageBackend to load chunks without any file reads, or when the files were written without data.
+ *
+ * @param parameters Size of the model, the same as it was written with
+ */
+std::shared_ptr<SyntheticStorageBackend> createSyntheticGeodeticGridBackend(const SyntheticGeodeticGridParameters& parameters);
+
+}
+#endif
@@ -1,6 +1,9 @@
 #ifndef MODEL_DATA_H
 #define MODEL_DATA_H
 
+#include <vector>
+#include <cstddef>
+
 namespace ocean_model_interfaces
 {
 
@@ -26,5 +29,77 @@ struct ModelData
     double depth;
 };
 
+/**
+ * Model data for many locations stored as a structure of arrays, one array per variable.
+ * Used by ModelInterface::getDataBatch.
+ */
+struct ModelDataSoA
+{
+    std::vector<double> u;
+    std::vector<double> v;
+    std::vector<double> w;
+    std::vector<double> temp;
+    std::vector<double> salt;
+    std::vector<double> dye;
+    std::vector<double> depth;
+
+    /** 1 if the location was inside the model, 0 if the data came from the out of range handling. */
+    std::vector<unsigned char> inModel;
+
+    /**
+     * Resizes every array to hold n locations.
+     */
+    void resize(size_t n)
+    {
+        u.resize(n);
+        v.resize(n);
+        w.resize(n);
+        temp.resize(n);
+        salt.resize(n);
+        dye.resize(n);
+        depth.resize(n);
+        inModel.resize(n);
+    }
+
+    /**
+     * @return The number of locations stored.
+     */
+    size_t size() const
+    {
+        return u.size();
+    }
+
+    /**
+     * Stores the data for a single location.
+     */
+    void set(size_t index, const ModelData& data, bool dataInModel)
+    {
+        u[index] = data.u;
+        v[index] = data.v;
+        w[index] = data.w;
+        temp[index] = data.temp;
+        salt[index] = data.salt;
+        dye[index] = data.dye;
+        depth[index] = data.depth;
+        inModel[index] = dataInModel;
+    }
+
+    /**
+     * @return The data for a single location.
+     */
+    ModelData get(size_t index) const
+    {
+        ModelData data;
+        data.u = u[index];
+        data.v = v[index];
+        data.w = w[index];
+        data.temp = temp[index];
+        data.salt = salt[index];
+        data.dye = dye[index];
+        data.depth = depth[index];
+        return data;
+    }
+};
+
 }
 #endif
\ No newline at end of file
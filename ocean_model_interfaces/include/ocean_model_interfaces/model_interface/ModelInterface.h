@@ -2,7 +2,9 @@
 #define MODEL_INTERFACE_H
 
 #include "ocean_model_interfaces/model_interface/ModelData.h"
+#include "ocean_model_interfaces/model_interface/QueryContext.h"
 #include "ocean_model_interfaces/util/Point.h"
+#include "ocean_model_interfaces/util/BackgroundLoader.h"
 
 namespace ocean_model_interfaces
 {
@@ -15,25 +17,74 @@ class ModelInterface
 public:
 
     ModelInterface();
+    ModelInterface(const ModelInterface& other) = default;
+    ModelInterface(ModelInterface&& other) = default;
+    ModelInterface& operator=(const ModelInterface& other) = default;
+    ModelInterface& operator=(ModelInterface&& other) = default;
     virtual ~ModelInterface();
 
     /**
     * Public interface for retriving model data. This will add the specified offsets to x, y, and time.
     * The input type expected by this function depends on how positionType is set. The base implementation
     * assumes the underlying model accepts a (x,y, height) tuple in meters. If the underlying model is different
-    * (i.e. accepts lat/lon) then it should override this function. If requested data is outside of the model then 
-    * this should throw and out_of_range exception.
+    * (i.e. accepts lat/lon) then it should override toModelCoordinates. If requested data is outside of the model then 
+    * this should throw and out_of_range exception. Uses a query context owned by the model, so this must not be called
+    * from multiple threads at once.
     **/
     virtual const ModelData getData(double x, double y, double z, double time);
 
+    /**
+    * Same as getData but uses the search hints stored in context and updates them for the next query. Use one
+    * context per trajectory (or per thread) so independent queries do not destroy each other's locality.
+    **/
+    const ModelData getData(double x, double y, double z, double time, QueryContext& context);
+
     /**
     * Public interface for retriving model data when request is out of the model bounds. This will add the specified offsets to x, y, and time.
     * The input type expected by this function depends on how positionType is set. The base implementation
     * assumes the underlying model accepts a (x,y, height) tuple in meters. If the underlying model is different
-    * (i.e. accepts lat/lon) then it should override this function. 
+    * (i.e. accepts lat/lon) then it should override toModelCoordinates. 
     **/
     virtual const ModelData getDataOutOfRange(double x, double y, double z, double time);
 
+    /**
+    * Same as getDataOutOfRange but uses the search hints stored in context and updates them for the next query.
+    **/
+    const ModelData getDataOutOfRange(double x, double y, double z, double time, QueryContext& context);
+
+    /**
+    * Retrieves model data for many locations at once. Inputs are interpreted the same way as getData, with
+    * offsets and the coordinate type applied to every location. Locations outside of the model do not throw,
+    * instead they get the result of getDataOutOfRange and are marked in out.inModel. Each call uses its own
+    * search hints so different threads can request batches from the same model.
+    * @param x Array of n x values
+    * @param y Array of n y values
+    * @param z Array of n z values
+    * @param time Array of n time values
+    * @param n Number of locations
+    * @param out Output data, resized to n
+    **/
+    void getDataBatch(const double* x, const double* y, const double* z, const double* time, size_t n, ModelDataSoA& out);
+
+    /**
+    * Starts loading, on a background thread, the model data that queries near a location will need. Inputs are
+    * interpreted the same way as getData. This returns right away; queries that need a chunk that is still being
+    * prefetched wait for that load instead of starting another one. The load functions are not called for
+    * background loads. Models that do not load data on demand ignore this.
+    * @param x x value of the center of the region
+    * @param y y value of the center of the region
+    * @param z z value of the center of the region
+    * @param time Start time of the region
+    * @param radius Horizontal distance from the center to load, in meters
+    * @param timeWindow Length of time after time to load, in the same units as time
+    **/
+    void prefetch(double x, double y, double z, double time, double radius, double timeWindow);
+
+    /**
+    * Blocks until all data requested with prefetch has been loaded.
+    **/
+    void waitForPrefetch();
+
     /**
      * Set the 4D offset to apply to requested data. This can be used to shift the origin of the model
      * in the world frame.
@@ -48,6 +99,18 @@ public:
     };
     void setCoordinateType(CoordinateType type);
 
+    /**
+     * Set the number of threads getDataBatch may use. Models that support parallel batches split the
+     * locations by chunk and balance the work between threads with work stealing. Defaults to 1.
+     * @param threadCount Number of threads, including the calling thread
+     */
+    void setBatchThreadCount(unsigned int threadCount);
+
+    /**
+     * @return The number of threads getDataBatch may use.
+     */
+    unsigned int getBatchThreadCount() const;
+
 
 protected:
 
@@ -63,6 +126,45 @@ protected:
     */
     virtual const ModelData getDataOutOfRangeHelper(double x, double y, double z, double time)=0;
 
+    /**
+    * Internal helper to retrive data using search hints. Models that can use the hints should override this,
+    * by default the hints are ignored and getDataHelper is called.
+    **/
+    virtual const ModelData getDataHelperWithContext(double x, double y, double z, double time, QueryContext& context);
+
+    /**
+    * Internal helper to retrive data out of the model bounds using search hints. Models that can use the hints
+    * should override this, by default the hints are ignored and getDataOutOfRangeHelper is called.
+    **/
+    virtual const ModelData getDataOutOfRangeHelperWithContext(double x, double y, double z, double time, QueryContext& context);
+
+    /**
+    * Internal helper to retrieve data for many locations, already converted with toModelCoordinates and offset.
+    * The base implementation calls the single location helpers in order while sharing search hints between
+    * them. Models should override this to group the work, for example by chunk.
+    **/
+    virtual void getDataBatchHelper(const double* x, const double* y, const double* z, const double* time, size_t n, ModelDataSoA& out);
+
+    /**
+    * Internal helper to start background loads for a region, already converted with toModelCoordinates and offset.
+    * Models that load data on demand should override this and queue their loads on prefetchLoader.
+    * The base implementation does nothing.
+    **/
+    virtual void prefetchHelper(double x, double y, double z, double time, double radius, double timeWindow);
+
+    /**
+    * Drops queued prefetches and waits for a running one to finish. Models that use prefetchLoader must call
+    * this in their destructor since the loads reference the model's members.
+    **/
+    void stopPrefetching();
+
+    /**
+    * Converts a requested position into the coordinates expected by the helper functions, applying the
+    * x, y and z offsets. The base implementation produces (x,y, height) in meters. Models that use a different
+    * reference frame (i.e. lat/lon) should override this.
+    **/
+    virtual Point toModelCoordinates(double x, double y, double z) const;
+
     double offsetX;
     double offsetY;
     double offsetZ;
@@ -74,6 +176,26 @@ protected:
      * @brief The type of position that is expected to be passed into the getData and getDataOutOfRange functions
      */
     CoordinateType positionType = CoordinateType::XY;
+
+    /**
+     * @brief Search hints used by getData and getDataOutOfRange when no context is provided
+     */
+    QueryContext defaultContext;
+
+    /**
+     * @brief Number of consecutive locations handled as one task when batches are split between threads
+     */
+    static const size_t BATCH_BLOCK_SIZE = 256;
+
+    /**
+     * @brief Number of threads getDataBatchHelper may use
+     */
+    unsigned int batchThreadCount = 1;
+
+    /**
+     * @brief Background thread used by prefetchHelper to load data ahead of queries
+     */
+    BackgroundLoader prefetchLoader;
 };
 
 }
@@ -0,0 +1,45 @@
+#ifndef QUERY_CONTEXT_H
+#define QUERY_CONTEXT_H
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Warm start hints for a sequence of related model queries, such as the samples along one
+ * vehicle trajectory. Models check the hinted cell, vertical bracket and time bracket first
+ * and only fall back to a full search when the hint does not contain the new query.
+ *
+ * Each independent trajectory should use its own QueryContext so interleaved queries do not
+ * overwrite each other's hints, and so several threads can query one loaded model at the same
+ * time. A context must not be used by more than one thread at a time.
+ */
+struct QueryContext
+{
+    /**
+     * Index of the last containing cell (triangle for FVCOM). -1 if unknown.
+     */
+    int lastCell = -1;
+
+    /**
+     * Upper (shallower) index of the last vertical layer bracket. -1 if unknown.
+     */
+    int lastLayer = -1;
+
+    /**
+     * Lower index of the last time bracket. -1 if unknown.
+     */
+    int lastTimeIndex = -1;
+
+    /**
+     * Clears all hints, for example when a trajectory jumps to an unrelated location.
+     */
+    void reset()
+    {
+        lastCell = -1;
+        lastLayer = -1;
+        lastTimeIndex = -1;
+    }
+};
+
+}
+#endif
@@ -0,0 +1,102 @@
+#ifndef BACKGROUND_LOADER_H
+#define BACKGROUND_LOADER_H
+
+#include <deque>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <cstddef>
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Runs chunk loads on a single background thread so queries do not have to wait on disk for
+ * chunks that were requested ahead of time. Each load is identified by a key (the chunk id)
+ * and a key is only queued once. The thread is started on the first request.
+ *
+ * Loads are only hints: queued loads that have not started are dropped by stop, and exceptions
+ * thrown by a load are ignored.
+ *
+ * A loader is owned by a model and its loads reference that model, so copying or moving a loader
+ * never transfers pending work. Copies start out idle, and assigning to a loader or moving from one
+ * stops it first so the model it belongs to can be safely replaced.
+ */
+class BackgroundLoader
+{
+public:
+
+    /**
+     * Maximum number of loads waiting to start. Requests past this are dropped.
+     */
+    static const size_t MAX_PENDING = 1024;
+
+    BackgroundLoader();
+    BackgroundLoader(const BackgroundLoader& other);
+    BackgroundLoader(BackgroundLoader&& other);
+    BackgroundLoader& operator=(const BackgroundLoader& other);
+    BackgroundLoader& operator=(BackgroundLoader&& other);
+    ~BackgroundLoader();
+
+    /**
+     * Queues a load to run on the background thread.
+     * @param key Identifies the load. Ignored if a load with the same key is already queued or running.
+     * @param load Function that performs the load
+     *
+     * @return True if the load was queued.
+     */
+    bool enqueue(unsigned int key, std::function<void(void)> load);
+
+    /**
+     * Used before loading a chunk in the foreground. If the load for key is running this waits for it
+     * to finish. If it is queued but not started it is removed so it is not loaded twice.
+     * @param key Key of the load
+     *
+     * @return True if a running load for key finished while waiting.
+     */
+    bool waitFor(unsigned int key);
+
+    /**
+     * Blocks until every queued load has finished.
+     */
+    void wait();
+
+    /**
+     * Drops queued loads, waits for the running load to finish and stops the background thread.
+     * The loader can be used again afterwards.
+     */
+    void stop();
+
+    /**
+     * @return The number of loads queued or running.
+     */
+    size_t pending();
+
+private:
+
+    /**
+     * Loop run by the background thread.
+     */
+    void run();
+
+    std::mutex mutex;
+
+    //Signaled when a load is queued or the loader is stopping
+    std::condition_variable workAvailable;
+
+    //Signaled when a load finishes
+    std::condition_variable loadFinished;
+
+    std::deque<std::pair<unsigned int, std::function<void(void)>>> queue;
+    std::unordered_set<unsigned int> queuedKeys;
+
+    std::thread thread;
+    bool stopping = false;
+    bool loading = false;
+    unsigned int loadingKey = 0;
+};
+
+}
+#endif
@@ -0,0 +1,148 @@
+#ifndef BOUNDING_VOLUME_HIERARCHY_H
+#define BOUNDING_VOLUME_HIERARCHY_H
+
+#include <vector>
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Static bounding volume hierarchy over a set of 2D axis aligned bounding boxes. Used to find
+ * which shapes could contain a point without checking every shape. Points outside all of the
+ * boxes are rejected after only visiting the few nodes that overlap them.
+ */
+class BoundingVolumeHierarchy
+{
+public:
+
+    /**
+     * Axis aligned bounding box in the XY plane
+     */
+    struct Box
+    {
+        double minX;
+        double minY;
+        double maxX;
+        double maxY;
+
+        bool contains(double x, double y) const
+        {
+            return x >= minX && x <= maxX && y >= minY && y <= maxY;
+        }
+    };
+
+    /**
+     * Initalize an empty hierarchy.
+     */
+    BoundingVolumeHierarchy();
+
+    /**
+     * Builds the hierarchy for a set of boxes.
+     * @param boxes Bounding box of each shape. The index of each box in this vector is what is passed to queries.
+     */
+    BoundingVolumeHierarchy(const std::vector<Box>& boxes);
+
+    /**
+     * Finds the lowest shape index whose bounding box contains x,y and for which test returns true.
+     * @param x x value of the point
+     * @param y y value of the point
+     * @param test Called with a shape index, should return true if the shape contains the point
+     *
+     * @return The lowest matching shape index, or -1 if no shape matches.
+     */
+    template<typename Test>
+    int findLowest(double x, double y, Test test) const;
+
+    /**
+     * @return The number of shapes in the hierarchy.
+     */
+    unsigned int size() const;
+
+private:
+
+    /**
+     * A node is either a leaf with count shapes starting at first in indices,
+     * or an inner node (count == 0) whose children are at first and first + 1.
+     */
+    struct Node
+    {
+        Box box;
+        unsigned int first;
+        unsigned int count;
+    };
+
+    /**
+     * Recursively builds the node at nodeIndex for the shapes between begin and end.
+     */
+    void build(const std::vector<Box>& boxes, unsigned int nodeIndex, unsigned int begin, unsigned int end);
+
+private:
+
+    /**
+     * Maximum number of shapes in a leaf node
+     */
+    static const unsigned int LEAF_SIZE = 4;
+
+    /**
+     * Maximum depth of the tree. Median splits keep the depth near log2 of the number of shapes.
+     */
+    static const unsigned int MAX_DEPTH = 64;
+
+    std::vector<Node> nodes;
+
+    /**
+     * Shape index of each leaf entry
+     */
+    std::vector<unsigned int> indices;
+
+    /**
+     * Bounding box of each leaf entry, stored in the same order as indices
+     */
+    std::vector<Box> leafBoxes;
+};
+
+template<typename Test>
+int BoundingVolumeHierarchy::findLowest(double x, double y, Test test) const
+{
+    int lowest = -1;
+    if(nodes.empty())
+    {
+        return lowest;
+    }
+
+    //Iterative traversal, every node whose box contains the point has to be visited so the
+    //lowest index matches the result of testing every shape in order
+    unsigned int stack[MAX_DEPTH];
+    unsigned int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0)
+    {
+        const Node& node = nodes[stack[--stackSize]];
+        if(!node.box.contains(x, y))
+        {
+            continue;
+        }
+
+        if(node.count == 0)
+        {
+            stack[stackSize++] = node.first;
+            stack[stackSize++] = node.first + 1;
+            continue;
+        }
+
+        for(unsigned int i = node.first; i < node.first + node.count; i++)
+        {
+            int shape = indices[i];
+            if((lowest == -1 || shape < lowest) && leafBoxes[i].contains(x, y) && test(shape))
+            {
+                lowest = shape;
+            }
+        }
+    }
+
+    return lowest;
+}
+
+}
+#endif
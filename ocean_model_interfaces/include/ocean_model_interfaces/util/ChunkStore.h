@@ -0,0 +1,160 @@
+#ifndef CHUNK_STORE_H
+#define CHUNK_STORE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+
+#include "ocean_model_interfaces/util/MappedFile.h"
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Read only view of a chunk store, a copy of a model's variables split into the same chunks the model
+ * loads. Each chunk holds one contiguous float array for each variable, in the layout the model's chunks
+ * use in memory, so reading a chunk is only a pointer into the mapped file. The operating system loads
+ * the pages as they are read and shares them between every process that maps the same store.
+ *
+ * A store starts with a header holding the layout key, the variable names, the number of chunks and the
+ * position of the index. The index holds the offset and number of values of every variable in every chunk.
+ * Stores are written by ChunkStoreWriter.
+ */
+class ChunkStore
+{
+public:
+
+    /**
+     * Maps a chunk store for reading.
+     * @param filename Path of the store
+     *
+     * @throws std::runtime_error if the file can not be mapped or is not a valid chunk store
+     */
+    ChunkStore(const std::string& filename);
+
+    ChunkStore(const ChunkStore& other) = delete;
+    ChunkStore& operator=(const ChunkStore& other) = delete;
+
+    /**
+     * @return The layout key the store was written with, describing how the model was split into chunks.
+     */
+    const std::string& getKey() const;
+
+    /**
+     * @return The names of the variables stored for every chunk, in the order they are indexed.
+     */
+    const std::vector<std::string>& getVariables() const;
+
+    /**
+     * @return The number of chunk ids in the store. Not every id has to hold data.
+     */
+    unsigned int getNumChunks() const;
+
+    /**
+     * @return True if the store holds data for the chunk.
+     */
+    bool hasChunk(unsigned int chunkId) const;
+
+    /**
+     * Returns the values of one variable in a chunk. The values stay valid for as long as the store exists.
+     * @param chunkId Id of the chunk
+     * @param variable Index of the variable in getVariables()
+     * @param count Set to the number of values
+     *
+     * @return The first value in the mapped file.
+     *
+     * @throws std::out_of_range if the chunk is not in the store or the variable does not exist
+     */
+    const float* getValues(unsigned int chunkId, unsigned int variable, size_t& count) const;
+
+private:
+
+    /**
+     * Position of one variable of one chunk in the file.
+     */
+    struct IndexEntry
+    {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    const IndexEntry& getIndexEntry(unsigned int chunkId, unsigned int variable) const;
+
+private:
+    MappedFile file;
+    std::string key;
+    std::vector<std::string> variables;
+    unsigned int numChunks;
+
+    //Points into the mapped file, numChunks * variables.size() entries ordered by chunk then variable
+    const IndexEntry* index;
+};
+
+/**
+ * Writes a chunk store read by ChunkStore. Chunks can be added in any order. The store is written to a
+ * temporary file that replaces filename when finish() is called, so a store is never read partly written.
+ */
+class ChunkStoreWriter
+{
+public:
+
+    /**
+     * Starts a new chunk store.
+     * @param filename Path of the store to write
+     * @param key Layout key the store is checked against when it is used
+     * @param variables Names of the variables stored for every chunk
+     * @param numChunks Number of chunk ids in the model
+     *
+     * @throws std::runtime_error if the file can not be written
+     */
+    ChunkStoreWriter(const std::string& filename, const std::string& key, const std::vector<std::string>& variables, unsigned int numChunks);
+
+    ChunkStoreWriter(const ChunkStoreWriter& other) = delete;
+    ChunkStoreWriter& operator=(const ChunkStoreWriter& other) = delete;
+
+    /**
+     * Removes the temporary file if the store was not finished.
+     */
+    ~ChunkStoreWriter();
+
+    /**
+     * Adds the values of every variable in a chunk.
+     * @param chunkId Id of the chunk
+     * @param values Start of the values of each variable, in the order of the variable names
+     * @param counts Number of values of each variable
+     *
+     * @throws std::runtime_error if the chunk id is out of range or the values can not be written
+     */
+    void writeChunk(unsigned int chunkId, const std::vector<const float*>& values, const std::vector<size_t>& counts);
+
+    /**
+     * Writes the index and replaces filename with the finished store.
+     *
+     * @throws std::runtime_error if the store can not be written
+     */
+    void finish();
+
+private:
+    void writeBytes(const void* data, size_t size);
+    void writeString(const std::string& value);
+
+    /**
+     * Writes zeros until the position is a multiple of alignment, at most 64.
+     */
+    void pad(size_t alignment);
+
+private:
+    std::string filename;
+    std::string temporaryFile;
+    std::ofstream out;
+    size_t position;
+    size_t variableCount;
+    std::vector<uint64_t> index;
+    size_t indexOffsetPosition;
+    bool finished;
+};
+
+}
+#endif
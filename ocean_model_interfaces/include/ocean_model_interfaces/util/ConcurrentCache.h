@@ -0,0 +1,474 @@
+#ifndef CONCURRENT_CACHE_H
+#define CONCURRENT_CACHE_H
+
+#include <unordered_map>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+#include <utility>
+#include <tuple>
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Thread safe cache with a bounded number of entries. Keys are hashed into shards which each
+ * have their own lock, so lookups of different keys rarely contend. Eviction uses the CLOCK
+ * (second chance) algorithm: a hit only sets a reference bit instead of reordering a list,
+ * and the clock hand skips and clears referenced entries when looking for one to evict.
+ *
+ * Values are never handed out by reference since another thread could evict them. Use visit
+ * to read a value while the shard is locked, or get to copy it out.
+ *
+ * The cache can also be limited by memory. Give it a function that reports the size of a value in
+ * bytes and call setMemoryLimit. The limit covers the whole cache. A new value reserves its bytes before
+ * it is inserted, evicting from its own shard first and then from the other shards in turn until it fits,
+ * so the usage never goes over the limit. A value larger than the whole limit is not cached at all.
+ */
+template <class K, class V>
+class ConcurrentCache
+{
+public:
+
+    /**
+     * Default number of shards. Fewer shards are used when the capacity is small.
+     */
+    static const size_t DEFAULT_SHARD_COUNT = 16;
+
+    /**
+     * Fewest entries a shard holds. Tiny shards evict keys that hash to them even when the rest of the
+     * cache is empty, so small caches use fewer shards instead.
+     */
+    static const size_t MIN_SHARD_CAPACITY = 16;
+
+    ConcurrentCache() :
+        ConcurrentCache(10)
+    {}
+
+    /**
+     * @param maxSize Maximum number of entries across all shards
+     * @param shardCount Number of independently locked shards
+     */
+    ConcurrentCache(size_t maxSize, size_t shardCount = DEFAULT_SHARD_COUNT) :
+        ConcurrentCache(maxSize, nullptr, shardCount)
+    {}
+
+    /**
+     * @param maxSize Maximum number of entries across all shards
+     * @param sizeOf Returns the memory used by a value in bytes. Required to use setMemoryLimit.
+     * @param shardCount Number of independently locked shards
+     */
+    ConcurrentCache(size_t maxSize, std::function<size_t(const V&)> sizeOf, size_t shardCount = DEFAULT_SHARD_COUNT) :
+        maxSize(maxSize),
+        sizeOf(sizeOf),
+        usage(new Usage())
+    {
+        shardCount = std::max<size_t>(1, std::min(shardCount, maxSize / MIN_SHARD_CAPACITY));
+
+        //Split the capacity evenly, giving the remainder to the first shards
+        for(size_t i = 0; i < shardCount; i++)
+        {
+            size_t capacity = maxSize / shardCount + (i < maxSize % shardCount ? 1 : 0);
+            shards.push_back(std::unique_ptr<Shard>(new Shard(capacity)));
+        }
+    }
+
+    /**
+     * Put a copy of a value into the cache with a key. If the key already exists its value is replaced.
+     * @param key key corresponding to the value
+     * @param value value to add to the cache
+     */
+    void put(const K& key, const V& value)
+    {
+        insert(key, V(value));
+    }
+
+    /**
+     * Move a value into the cache with a key. If the key already exists its value is replaced.
+     * @param key key corresponding to the value
+     * @param value value to add to the cache
+     */
+    void put(const K& key, V&& value)
+    {
+        insert(key, std::move(value));
+    }
+
+    /**
+     * Construct a value from args and move it into the cache. If the key already exists its value is replaced.
+     * @param key key corresponding to the value
+     * @param args arguments for the constructor of the value
+     */
+    template<typename... Args>
+    void emplace(const K& key, Args&&... args)
+    {
+        insert(key, V(std::forward<Args>(args)...));
+    }
+
+    /**
+     * Calls visitor with the value for key while the shard holding it is locked.
+     * The visitor must not access this cache.
+     * @param key key corresponding to the value to visit
+     * @param visitor Called with a reference to the value if it exists
+     *
+     * @return True if the key was in the cache
+     */
+    template<typename Visitor>
+    bool visit(const K& key, Visitor visitor)
+    {
+        Shard& shard = getShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.entries.find(key);
+        if(it == shard.entries.end())
+        {
+            return false;
+        }
+
+        it->second.referenced = true;
+        visitor(it->second.value);
+        return true;
+    }
+
+    /**
+     * Get a copy of a value from the cache
+     * @param key key corresponding to the value to retrieve
+     */
+    V get(const K& key)
+    {
+        Shard& shard = getShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.entries.find(key);
+        if(it == shard.entries.end())
+        {
+            throw std::range_error("There is no such key in cache");
+        }
+
+        it->second.referenced = true;
+        return it->second.value;
+    }
+
+    /**
+     * Check if a key is in the cache. Another thread may insert or evict the key right after this returns.
+     * @param key key to check for
+     */
+    bool exists(const K& key) const
+    {
+        Shard& shard = getShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        return shard.entries.find(key) != shard.entries.end();
+    }
+
+    /**
+     * @return The number of entries currently in the cache
+     */
+    size_t size() const
+    {
+        size_t total = 0;
+        for(const auto& shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->entries.size();
+        }
+
+        return total;
+    }
+
+    /**
+     * @return The maximum number of entries in the cache
+     */
+    size_t capacity() const
+    {
+        return maxSize;
+    }
+
+    /**
+     * Limits the total size of the values in the cache, evicting entries until it is under the limit.
+     * @param bytes Maximum bytes used by values across all shards. 0 removes the limit.
+     */
+    void setMemoryLimit(size_t bytes)
+    {
+        if(bytes != 0 && !sizeOf)
+        {
+            throw std::logic_error("A memory limit requires a function that reports the size of values");
+        }
+
+        usage->limit = bytes;
+
+        //Whole passes over the shards, so entries put by concurrent inserts can not end this early while another shard still has entries
+        bool evicted = true;
+        while(bytes != 0 && usage->bytes > bytes && evicted)
+        {
+            evicted = false;
+            for(size_t shardIndex = 0; shardIndex < shards.size() && usage->bytes > bytes; shardIndex++)
+            {
+                evicted = evictFrom(shardIndex) || evicted;
+            }
+        }
+    }
+
+    /**
+     * @return The memory limit in bytes, 0 if there is none.
+     */
+    size_t memoryLimit() const
+    {
+        return usage->limit;
+    }
+
+    /**
+     * @return Bytes currently used by the values in the cache, as reported by the size function.
+     */
+    size_t memoryUsage() const
+    {
+        return usage->bytes;
+    }
+
+    /**
+     * @return The highest value memoryUsage has reached.
+     */
+    size_t peakMemoryUsage() const
+    {
+        return usage->peakBytes;
+    }
+
+private:
+
+    struct Entry
+    {
+        Entry(V&& value, size_t bytes) :
+            value(std::move(value)),
+            bytes(bytes),
+            referenced(false)
+        {}
+
+        V value;
+        size_t bytes;
+        bool referenced;
+    };
+
+    struct Shard
+    {
+        Shard(size_t capacity) :
+            capacity(capacity),
+            hand(0)
+        {}
+
+        std::mutex mutex;
+        std::unordered_map<K, Entry> entries;
+
+        //Keys in clock order, the hand points at the next eviction candidate
+        std::vector<K> clock;
+        size_t capacity;
+        size_t hand;
+    };
+
+    /**
+     * Memory used by all shards and its limit. Held by pointer so the cache can be moved even though atomics can not.
+     */
+    struct Usage
+    {
+        std::atomic<size_t> bytes{0};
+        std::atomic<size_t> peakBytes{0};
+        std::atomic<size_t> limit{0};
+    };
+
+    /**
+     * Moves a value into its shard, evicting entries until it fits.
+     */
+    void insert(const K& key, V&& value)
+    {
+        size_t bytes = sizeOf ? sizeOf(value) : 0;
+        size_t shardIndex = getShardIndex(key);
+        Shard& shard = *shards[shardIndex];
+
+        size_t limit = usage->limit;
+        if(shard.capacity == 0 || (limit != 0 && bytes > limit))
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.entries.find(key);
+            if(it != shard.entries.end())
+            {
+                remove(shard, it);
+            }
+            return;
+        }
+
+        //The old value and any entry over the shard's capacity are removed before reserving, so the usage never counts both
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.entries.find(key);
+            if(it != shard.entries.end())
+            {
+                remove(shard, it);
+            }
+
+            while(shard.entries.size() >= shard.capacity)
+            {
+                evict(shard);
+            }
+        }
+
+        //Only one shard is locked at a time while making room, so inserts into different shards can not deadlock
+        while(!reserve(bytes))
+        {
+            if(!evictFromAnyShard(shardIndex))
+            {
+                //Everything left is reserved by inserts in other threads, which are evicted once they are in
+                std::this_thread::yield();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        //Another thread may have put the same key while this one made room
+        auto it = shard.entries.find(key);
+        if(it != shard.entries.end())
+        {
+            remove(shard, it);
+        }
+
+        while(shard.entries.size() >= shard.capacity)
+        {
+            evict(shard);
+        }
+
+        //New entries go just behind the hand so they are the last to be considered for eviction
+        shard.clock.insert(shard.clock.begin() + shard.hand, key);
+        shard.hand = (shard.hand + 1) % shard.clock.size();
+        shard.entries.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::move(value), bytes));
+    }
+
+    /**
+     * Adds bytes to the usage if they fit under the limit.
+     * @return False if the bytes do not fit
+     */
+    bool reserve(size_t bytes)
+    {
+        size_t limit = usage->limit;
+        size_t total = usage->bytes;
+        do
+        {
+            if(limit != 0 && total + bytes > limit)
+            {
+                return false;
+            }
+        }
+        while(!usage->bytes.compare_exchange_weak(total, total + bytes));
+
+        size_t peak = usage->peakBytes;
+        while(total + bytes > peak && !usage->peakBytes.compare_exchange_weak(peak, total + bytes))
+        {
+        }
+        return true;
+    }
+
+    /**
+     * Evicts one entry, from the shard at firstShard if it has any and otherwise from the shards after it in order.
+     * No shard may be locked by the calling thread.
+     * @return False if every shard was empty
+     */
+    bool evictFromAnyShard(size_t firstShard)
+    {
+        for(size_t i = 0; i < shards.size(); i++)
+        {
+            if(evictFrom((firstShard + i) % shards.size()))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Evicts one entry from the shard at shardIndex. The shard must not be locked by the calling thread.
+     * @return False if the shard was empty
+     */
+    bool evictFrom(size_t shardIndex)
+    {
+        Shard& shard = *shards[shardIndex];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if(shard.entries.empty())
+        {
+            return false;
+        }
+
+        evict(shard);
+        return true;
+    }
+
+    /**
+     * Advances the clock hand, giving referenced entries a second chance, until an entry is evicted.
+     * The shard must be locked and not empty.
+     */
+    void evict(Shard& shard)
+    {
+        while(true)
+        {
+            auto victim = shard.entries.find(shard.clock[shard.hand]);
+            if(victim->second.referenced)
+            {
+                victim->second.referenced = false;
+                shard.hand = (shard.hand + 1) % shard.clock.size();
+            }
+            else
+            {
+                remove(shard, victim);
+                return;
+            }
+        }
+    }
+
+    /**
+     * Removes an entry from a locked shard, keeping the hand on the entry after it.
+     */
+    void remove(Shard& shard, typename std::unordered_map<K, Entry>::iterator it)
+    {
+        size_t position = std::find(shard.clock.begin(), shard.clock.end(), it->first) - shard.clock.begin();
+        shard.clock.erase(shard.clock.begin() + position);
+        if(position < shard.hand)
+        {
+            shard.hand--;
+        }
+        if(shard.hand >= shard.clock.size())
+        {
+            shard.hand = 0;
+        }
+
+        usage->bytes -= it->second.bytes;
+        shard.entries.erase(it);
+    }
+
+    Shard& getShard(const K& key) const
+    {
+        return *shards[getShardIndex(key)];
+    }
+
+    size_t getShardIndex(const K& key) const
+    {
+        //std::hash of an integer is usually the integer itself, so the bits are mixed first. Otherwise keys
+        //that differ by a multiple of the shard count, like the chunks of neighbouring time steps, share a shard.
+        uint64_t hash = std::hash<K>()(key);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash % shards.size();
+    }
+
+    //Shards are held by pointer so the cache can be moved even though mutexes can not
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t maxSize;
+    std::function<size_t(const V&)> sizeOf;
+    std::unique_ptr<Usage> usage;
+};
+
+}
+#endif
@@ -0,0 +1,82 @@
+#ifndef KD_TREE_H
+#define KD_TREE_H
+
+#include "ocean_model_interfaces/util/Point.h"
+
+#include <vector>
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Static 2D k-d tree over the XY coordinates of a set of points. Used to find the closest
+ * point to a location without checking the distance to every point. The tree is built once
+ * and can not be modified afterwards.
+ */
+class KDTree
+{
+public:
+
+    /**
+     * Initalize an empty tree.
+     */
+    KDTree();
+
+    /**
+     * Builds the tree for a set of points. Only the x and y values of the points are used.
+     * @param points The points to index. The index of each point in this vector is what is returned by queries.
+     */
+    KDTree(const std::vector<Point>& points);
+
+    /**
+     * Finds the point closest to testPoint in the XY plane. If multiple points are the same
+     * distance away the lowest index is returned.
+     * @param testPoint Point to find the closest point for
+     *
+     * @return The index of the closest point, or -1 if the tree is empty.
+     */
+    int nearest(const Point& testPoint) const;
+
+    /**
+     * @return The number of points in the tree.
+     */
+    unsigned int size() const;
+
+private:
+
+    /**
+     * Recursively splits the points between begin and end along alternating axes.
+     */
+    void build(const std::vector<Point>& points, unsigned int begin, unsigned int end, unsigned int depth);
+
+    /**
+     * Recursively searches the points between begin and end for the closest point.
+     */
+    void nearest(unsigned int begin, unsigned int end, unsigned int depth, double x, double y, int& bestIndex, double& bestDistance) const;
+
+    /**
+     * Checks a single point in the tree and updates the best match if it is closer.
+     */
+    void checkPoint(unsigned int treeIndex, double x, double y, int& bestIndex, double& bestDistance) const;
+
+private:
+
+    /**
+     * Maximum number of points that are searched linearly instead of being split further.
+     */
+    static const unsigned int LEAF_SIZE = 8;
+
+    /**
+     * Original index of each point in tree order
+     */
+    std::vector<unsigned int> indices;
+
+    /**
+     * x,y of each point in tree order
+     */
+    std::vector<double> xs;
+    std::vector<double> ys;
+};
+
+}
+#endif
@@ -40,6 +40,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <unordered_map>
 #include <cstddef>
 #include <stdexcept>
+#include <utility>
 
 
 namespace ocean_model_interfaces
@@ -73,12 +74,22 @@ public:
      * @param value value to add to the list
      */
     void put(const K &key, const V &value)
+    {
+        put(key, V(value));
+    }
+
+    /**
+     * Move a value into the cache with a key
+     * @param key key corresponding to the value
+     * @param value value to move into the list
+     */
+    void put(const K &key, V &&value)
     {
         //find the key in the map
         auto it = item_map.find(key);
 
         //push the key and value to the front of the list
-        item_list.push_front(key_value_pair_t(key, value));
+        item_list.emplace_front(key, std::move(value));
 
         //if the key is already in the map erase it
         if (it != item_map.end()) 
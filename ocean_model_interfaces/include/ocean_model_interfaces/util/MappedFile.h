@@ -0,0 +1,62 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Read only memory map of a whole file. The operating system pages the file in as it is read
+ * and shares the pages between every process that maps the same file.
+ */
+class MappedFile
+{
+public:
+
+    /**
+     * Initalize an empty map.
+     */
+    MappedFile();
+
+    /**
+     * Maps a file for reading.
+     * @param filename Path of the file to map
+     *
+     * @throws std::runtime_error if the file can not be opened or mapped
+     */
+    MappedFile(const std::string& filename);
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+
+    /**
+     * Unmaps the file.
+     */
+    ~MappedFile();
+
+    /**
+     * @return The start of the file in memory, null if nothing is mapped.
+     */
+    const char* data() const;
+
+    /**
+     * @return The size of the file in bytes.
+     */
+    size_t size() const;
+
+private:
+
+    void unmap();
+
+private:
+    const char* mapping;
+    size_t length;
+};
+
+}
+#endif
@@ -0,0 +1,76 @@
+#ifndef MEMORY_STORAGE_BACKEND_H
+#define MEMORY_STORAGE_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+#include "ocean_model_interfaces/util/StorageBackend.h"
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Keeps model variables in memory, for tests and benchmarks that should not depend on files or on the
+ * netCDF library. Variables are added with setVariable before the backend is used. Reads do not lock,
+ * so any number of threads can read at once as long as no variable is being set.
+ */
+class MemoryStorageBackend : public StorageBackend
+{
+public:
+
+    /**
+     * Adds or replaces a variable.
+     * @param filename Model file the variable is read from
+     * @param variable Name of the variable
+     * @param shape Size of each dimension, the last dimension changes fastest in values
+     * @param values Every value of the variable
+     *
+     * @throws std::runtime_error if the number of values does not match the shape
+     */
+    void setVariable(const std::string& filename, const std::string& variable, const std::vector<size_t>& shape, std::vector<float> values);
+
+    /**
+     * @return The memory used by the stored values in bytes.
+     */
+    size_t getMemoryUsage() const;
+
+    bool hasVariable(const std::string& filename, const std::string& variable) override;
+
+    /**
+     * @throws std::runtime_error if the variable does not exist or the hyperslab is outside of it
+     */
+    void read(const std::string& filename, const std::string& variable,
+              const std::vector<size_t>& start, const std::vector<size_t>& count, float* out) override;
+
+    /**
+     * @throws std::runtime_error if the variable does not exist or the hyperslab is outside of it
+     */
+    void read(const std::string& filename, const std::string& variable,
+              const std::vector<size_t>& start, const std::vector<size_t>& count, double* out) override;
+
+private:
+    struct Variable
+    {
+        std::vector<size_t> shape;
+        std::vector<float> values;
+    };
+
+    const Variable& getVariable(const std::string& filename, const std::string& variable) const;
+
+    /**
+     * Copies a hyperslab one row of the last dimension at a time.
+     */
+    template<typename T>
+    void readValues(const std::string& filename, const std::string& variable,
+                    const std::vector<size_t>& start, const std::vector<size_t>& count, T* out) const;
+
+    static std::string getKey(const std::string& filename, const std::string& variable);
+
+private:
+    std::unordered_map<std::string, Variable> variables;
+};
+
+}
+#endif
@@ -2,73 +2,226 @@
 #define MULTI_DIMENSIONAL_VECTOR_H
 
 #include <vector>
+#include <array>
+#include <cstddef>
 #include <stdexcept>
+#include <string>
 
 namespace ocean_model_interfaces
 {
 
-template<typename T>
-class MultiDimensionalVector {
+/**
+ * Non-owning view of an N dimensional array. Views are cheap to copy and can have any strides, so a view can
+ * be a slice of a larger array without copying it. The viewed memory must outlive the view.
+ * Use a const T for a read only view.
+ */
+template<typename T, size_t N>
+class MultiDimensionalView {
 public:
-    MultiDimensionalVector() {}
+    MultiDimensionalView() : data(nullptr) {
+        extents.fill(0);
+        strides.fill(0);
+    }
 
-    MultiDimensionalVector(std::vector<size_t> dimensionSizes) {
-        this->dimensionSizes = dimensionSizes;
+    /**
+     * @param data The element at index 0 in every dimension
+     * @param extents Size of each dimension
+     * @param strides Number of elements between neighbouring indicies of each dimension
+     */
+    MultiDimensionalView(T* data, const std::array<size_t, N>& extents, const std::array<size_t, N>& strides) :
+        data(data),
+        extents(extents),
+        strides(strides) {}
+
+    /**
+     * Unchecked access. Takes one index per dimension, which must be in range.
+     */
+    template<typename... Indices>
+    T& operator()(Indices... indicies) const {
+        return data[getOffset(indicies...)];
+    }
 
-        int totalEntries = 1;
-        for(int i = 0; i < dimensionSizes.size(); i++) {
-            totalEntries *= dimensionSizes[i];
-        }
+    /**
+     * Checked access. Takes one index per dimension.
+     * @throws std::runtime_error if an index is out of range
+     */
+    template<typename... Indices>
+    T index(Indices... indicies) const {
+        checkIndicies(indicies...);
+        return data[getOffset(indicies...)];
+    }
 
-        data.resize(totalEntries);
+    /**
+     * @return The number of elements from the start of the view to an element, for one index per dimension.
+     */
+    template<typename... Indices>
+    size_t getOffset(Indices... indicies) const {
+        static_assert(sizeof...(Indices) == N, "One index is needed for each dimension");
+        const size_t values[N] = {static_cast<size_t>(indicies)...};
+
+        size_t offset = 0;
+        for(size_t i = 0; i < N; i++) {
+            offset += values[i] * strides[i];
+        }
+        return offset;
     }
 
-    T index(std::vector<size_t> indicies)  {
-        if(indicies.size() != dimensionSizes.size()) {
-            throw std::runtime_error("Number of provided indicies does not match the dimensions of the nD vector");
+    /**
+     * @return The view of one index of the first dimension, without copying.
+     */
+    MultiDimensionalView<T, N - 1> slice(size_t index) const {
+        static_assert(N > 1, "Only views with more than one dimension can be sliced");
+        std::array<size_t, N - 1> sliceExtents;
+        std::array<size_t, N - 1> sliceStrides;
+        for(size_t i = 1; i < N; i++) {
+            sliceExtents[i - 1] = extents[i];
+            sliceStrides[i - 1] = strides[i];
         }
+        return MultiDimensionalView<T, N - 1>(data + index * strides[0], sliceExtents, sliceStrides);
+    }
+
+    T* getDataArray() const {
+        return data;
+    }
 
-        for(int i = 0; i < indicies.size(); i++) {
-            if(0 > indicies[i] || indicies[i] >= dimensionSizes[i]) {
-                std::string message = "MultiDimensionalVector index out of bounds: dimension=" + std::to_string(i) + " index=" + std::to_string(indicies[i]) + " size=" + std::to_string(dimensionSizes[i]);
+    size_t size(size_t dimension) const {
+        return extents[dimension];
+    }
+
+    const std::array<size_t, N>& getExtents() const {
+        return extents;
+    }
+
+    const std::array<size_t, N>& getStrides() const {
+        return strides;
+    }
+
+private:
+    template<typename... Indices>
+    void checkIndicies(Indices... indicies) const {
+        static_assert(sizeof...(Indices) == N, "One index is needed for each dimension");
+        const size_t values[N] = {static_cast<size_t>(indicies)...};
+
+        for(size_t i = 0; i < N; i++) {
+            if(values[i] >= extents[i]) {
+                std::string message = "MultiDimensionalVector index out of bounds: dimension=" + std::to_string(i) + " index=" + std::to_string(values[i]) + " size=" + std::to_string(extents[i]);
                 throw std::runtime_error(message);
             }
         }
+    }
 
-        size_t single_index = getFlattenedIndex(indicies);
+private:
+    T* data;
+    std::array<size_t, N> extents;
+    std::array<size_t, N> strides;
+};
 
-        return data[single_index];
+/**
+ * N dimensional array stored contiguously in row major order, so the last dimension changes fastest.
+ * The rank is fixed at compile time, so indexing unrolls to one multiply and add per dimension with
+ * strides computed once. Offsets are 64 bit.
+ */
+template<typename T, size_t N>
+class MultiDimensionalVector {
+public:
+    MultiDimensionalVector() {
+        extents.fill(0);
+        strides.fill(0);
+    }
+
+    /**
+     * @param extents Size of each dimension
+     */
+    explicit MultiDimensionalVector(const std::array<size_t, N>& extents) :
+        extents(extents) {
+        size_t totalEntries = 1;
+        for(size_t i = N; i-- > 0;) {
+            strides[i] = totalEntries;
+            totalEntries *= extents[i];
+        }
+
+        data.resize(totalEntries);
+    }
+
+    /**
+     * Unchecked access. Takes one index per dimension, which must be in range.
+     */
+    template<typename... Indices>
+    T& operator()(Indices... indicies) {
+        return data[getOffset(indicies...)];
+    }
+
+    template<typename... Indices>
+    const T& operator()(Indices... indicies) const {
+        return data[getOffset(indicies...)];
+    }
+
+    /**
+     * Checked access. Takes one index per dimension.
+     * @throws std::runtime_error if an index is out of range
+     */
+    template<typename... Indices>
+    T index(Indices... indicies) const {
+        return view().index(indicies...);
+    }
+
+    /**
+     * @return The position in getDataArray of an element, for one index per dimension.
+     */
+    template<typename... Indices>
+    size_t getOffset(Indices... indicies) const {
+        return view().getOffset(indicies...);
     }
 
     T* getDataArray()  {
         return data.data();
     }
 
-    T* getDataArrayAtIndex(std::vector<size_t> indicies) {
-        size_t index = getFlattenedIndex(indicies);
-        return (data.data() + index);
+    const T* getDataArray() const {
+        return data.data();
     }
 
-    std::vector<size_t> size()  {
-        return dimensionSizes;
+    template<typename... Indices>
+    T* getDataArrayAtIndex(Indices... indicies) {
+        return data.data() + getOffset(indicies...);
     }
 
-private:
-    size_t getFlattenedIndex(std::vector<size_t> indicies) {
-        int single_index = 0;
-        int multiplier = 1;
-        for(int i = indicies.size() - 1; i >= 0; i--) {
-            single_index += multiplier * indicies[i];
-            multiplier *= dimensionSizes[i];
-        }
+    MultiDimensionalView<T, N> view() {
+        return MultiDimensionalView<T, N>(data.data(), extents, strides);
+    }
+
+    MultiDimensionalView<const T, N> view() const {
+        return MultiDimensionalView<const T, N>(data.data(), extents, strides);
+    }
+
+    /**
+     * @return The view of one index of the first dimension, without copying.
+     */
+    MultiDimensionalView<T, N - 1> slice(size_t index) {
+        return view().slice(index);
+    }
+
+    MultiDimensionalView<const T, N - 1> slice(size_t index) const {
+        return view().slice(index);
+    }
+
+    size_t getMemoryUsage() const {
+        return sizeof(MultiDimensionalVector<T, N>) + data.capacity() * sizeof(T);
+    }
+
+    size_t size(size_t dimension) const {
+        return extents[dimension];
+    }
 
-        return single_index;
+    const std::array<size_t, N>& getExtents() const {
+        return extents;
     }
 
 private:
     std::vector<T> data;
-    std::vector<size_t> dimensionSizes;
+    std::array<size_t, N> extents;
+    std::array<size_t, N> strides;
 };
 
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,100 @@
+#ifndef NETCDF_FILE_POOL_H
+#define NETCDF_FILE_POOL_H
+
+#include <string>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <cstddef>
+
+#include <netcdf>
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Keeps netCDF files open between reads so loading a chunk does not have to open and close
+ * every model file for each node, triangle or grid cell it reads. Variable handles are cached
+ * with the file they belong to. At most maxOpenFiles files are open at once, and the least
+ * recently used file is closed when another one has to be opened.
+ *
+ * The pool does not lock anything itself. Like every other netCDF call, it must only be used
+ * while holding getNetCDFMutex(). Handles returned by the pool stay valid until the pool is used
+ * to open a different file, so callers should finish with one file before asking for the next.
+ */
+class NetCDFFilePool
+{
+public:
+
+    /**
+     * Number of files kept open when no limit is given.
+     */
+    static const size_t DEFAULT_MAX_OPEN_FILES = 32;
+
+    /**
+     * @param maxOpenFiles Maximum number of files kept open at once. 0 is treated as 1.
+     */
+    NetCDFFilePool(size_t maxOpenFiles = DEFAULT_MAX_OPEN_FILES);
+
+    NetCDFFilePool(const NetCDFFilePool& other) = delete;
+    NetCDFFilePool& operator=(const NetCDFFilePool& other) = delete;
+
+    /**
+     * Returns an open handle to a file, opening it for reading if it is not already open.
+     * @param filename Path of the netCDF file
+     *
+     * @return The open file.
+     */
+    netCDF::NcFile& getFile(const std::string& filename);
+
+    /**
+     * Returns a variable from a file, opening the file if needed. Handles are looked up once
+     * per open file.
+     * @param filename Path of the netCDF file
+     * @param varName Name of the variable
+     *
+     * @return The variable. Null if the file does not have a variable with that name.
+     */
+    netCDF::NcVar getVar(const std::string& filename, const std::string& varName);
+
+    /**
+     * Closes every open file.
+     */
+    void closeAll();
+
+    /**
+     * @return The number of files currently open.
+     */
+    size_t getOpenFileCount() const;
+
+    /**
+     * @return The maximum number of files kept open at once.
+     */
+    size_t getMaxOpenFiles() const;
+
+private:
+
+    struct OpenFile
+    {
+        std::unique_ptr<netCDF::NcFile> file;
+        std::unordered_map<std::string, netCDF::NcVar> vars;
+
+        //Position of this file in recentlyUsed
+        std::list<std::string>::iterator usePosition;
+    };
+
+    /**
+     * Finds or opens a file and marks it as the most recently used.
+     */
+    OpenFile& open(const std::string& filename);
+
+private:
+    size_t maxOpenFiles;
+
+    //Filenames of the open files, most recently used first
+    std::list<std::string> recentlyUsed;
+    std::unordered_map<std::string, OpenFile> openFiles;
+};
+
+}
+#endif
@@ -0,0 +1,20 @@
+#ifndef NETCDF_MUTEX_H
+#define NETCDF_MUTEX_H
+
+#include <mutex>
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * The netCDF-C library is not thread safe. Any code that opens or reads netCDF files
+ * must hold this mutex so models can load chunks from several threads at once.
+ */
+inline std::mutex& getNetCDFMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+}
+#endif
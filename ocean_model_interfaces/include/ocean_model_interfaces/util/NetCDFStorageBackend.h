@@ -0,0 +1,49 @@
+#ifndef NETCDF_STORAGE_BACKEND_H
+#define NETCDF_STORAGE_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include "ocean_model_interfaces/util/StorageBackend.h"
+#include "ocean_model_interfaces/util/NetCDFFilePool.h"
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Reads model variables from netCDF files through a NetCDFFilePool. The netCDF library is not thread
+ * safe, so every call holds getNetCDFMutex() and reads from several threads run one at a time.
+ */
+class NetCDFStorageBackend : public StorageBackend
+{
+public:
+
+    /**
+     * @param filePool Pool the files are opened in, usually shared with the model structure
+     */
+    NetCDFStorageBackend(std::shared_ptr<NetCDFFilePool> filePool);
+
+    bool hasVariable(const std::string& filename, const std::string& variable) override;
+
+    void read(const std::string& filename, const std::string& variable,
+              const std::vector<size_t>& start, const std::vector<size_t>& count, float* out) override;
+
+    void read(const std::string& filename, const std::string& variable,
+              const std::vector<size_t>& start, const std::vector<size_t>& count, double* out) override;
+
+private:
+    /**
+     * Reads any type the netCDF library can convert the variable to.
+     */
+    template<typename T>
+    void readValues(const std::string& filename, const std::string& variable,
+                    const std::vector<size_t>& start, const std::vector<size_t>& count, T* out);
+
+private:
+    std::shared_ptr<NetCDFFilePool> filePool;
+};
+
+}
+#endif
@@ -0,0 +1,52 @@
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Reads model variables for the chunk classes, so FVCOMChunk and GeodeticGridChunk load the same way
+ * whatever the model is stored in. A variable is an n dimensional array in a model file, and reads
+ * always cover a hyperslab, a box of start[i] to start[i] + count[i] in each dimension.
+ *
+ * Implementations must allow reads from several threads at once, locking internally if they need to.
+ */
+class StorageBackend
+{
+public:
+    virtual ~StorageBackend() {}
+
+    /**
+     * @param filename Model file the variable is in
+     * @param variable Name of the variable
+     * @return True if the file has the variable.
+     */
+    virtual bool hasVariable(const std::string& filename, const std::string& variable) = 0;
+
+    /**
+     * Reads a hyperslab of a variable, with the last dimension changing fastest in out.
+     * @param filename Model file the variable is in
+     * @param variable Name of the variable
+     * @param start First index read in each dimension
+     * @param count Number of indices read in each dimension
+     * @param out Receives the product of count values
+     *
+     * @throws std::runtime_error if the variable does not exist. A hyperslab outside of the variable
+     * throws std::runtime_error or the underlying library's own exception.
+     */
+    virtual void read(const std::string& filename, const std::string& variable,
+                      const std::vector<size_t>& start, const std::vector<size_t>& count, float* out) = 0;
+
+    /**
+     * Same as read for floats, converting the values to double.
+     */
+    virtual void read(const std::string& filename, const std::string& variable,
+                      const std::vector<size_t>& start, const std::vector<size_t>& count, double* out) = 0;
+};
+
+}
+#endif
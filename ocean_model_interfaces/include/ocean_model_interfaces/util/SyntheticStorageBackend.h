@@ -0,0 +1,102 @@
+#ifndef SYNTHETIC_STORAGE_BACKEND_H
+#define SYNTHETIC_STORAGE_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+#include "ocean_model_interfaces/util/StorageBackend.h"
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Computes the values of synthetic model variables on every read instead of storing them, so models of any
+ * size can be benchmarked without the memory or disk to hold their data. Every variable has dimensions
+ * time, layer, then one or more element dimensions. Values are smooth in time, layer and element with a
+ * little deterministic noise, and the same index always gives the same value. The synthetic model writers
+ * use this backend to fill their netCDF files, so reading those files gives exactly the same values.
+ *
+ * Files are matched by name without their directory, so the backend works wherever the model was written.
+ */
+class SyntheticStorageBackend : public StorageBackend
+{
+public:
+    struct File
+    {
+        //Name of the file without its directory
+        std::string filename;
+
+        //Number of time steps in the file. Files are in time order.
+        unsigned int timeSteps;
+    };
+
+    struct Variable
+    {
+        std::string name;
+
+        //Size of each dimension after time, starting with the layer dimension
+        std::vector<size_t> shape;
+
+        //Values vary around mean by up to amplitude
+        float mean;
+        float amplitude;
+    };
+
+    /**
+     * @param files Files of the model in time order
+     * @param variables Variables in every file
+     */
+    SyntheticStorageBackend(const std::vector<File>& files, const std::vector<Variable>& variables);
+
+    /**
+     * @param variable Index of the variable in the variables the backend was created with
+     * @param time Time index in the whole model
+     * @param layer Index in the first dimension after time
+     * @param element Index in the remaining dimensions, flattened with the last changing fastest
+     * @return The value of the variable at the index.
+     */
+    float getValue(unsigned int variable, size_t time, size_t layer, size_t element) const;
+
+    bool hasVariable(const std::string& filename, const std::string& variable) override;
+
+    /**
+     * @throws std::runtime_error if the file or variable does not exist or the hyperslab is outside of it
+     */
+    void read(const std::string& filename, const std::string& variable,
+              const std::vector<size_t>& start, const std::vector<size_t>& count, float* out) override;
+
+    /**
+     * @throws std::runtime_error if the file or variable does not exist or the hyperslab is outside of it
+     */
+    void read(const std::string& filename, const std::string& variable,
+              const std::vector<size_t>& start, const std::vector<size_t>& count, double* out) override;
+
+private:
+    /**
+     * Fills a hyperslab one row of the last dimension at a time.
+     */
+    template<typename T>
+    void readValues(const std::string& filename, const std::string& variable,
+                    const std::vector<size_t>& start, const std::vector<size_t>& count, T* out) const;
+
+    /**
+     * @return The index of a file in files, or files.size() if there is no such file.
+     */
+    size_t findFile(const std::string& filename) const;
+
+private:
+    std::vector<File> files;
+    std::vector<Variable> variables;
+
+    //Time index in the whole model of the first step of each file
+    std::vector<size_t> fileStartTimes;
+
+    //Position in files and variables by name
+    std::unordered_map<std::string, size_t> fileIndices;
+    std::unordered_map<std::string, unsigned int> variableIndices;
+};
+
+}
+#endif
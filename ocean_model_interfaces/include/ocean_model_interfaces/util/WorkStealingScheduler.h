@@ -0,0 +1,78 @@
+#ifndef WORK_STEALING_SCHEDULER_H
+#define WORK_STEALING_SCHEDULER_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+#include <functional>
+
+namespace ocean_model_interfaces
+{
+
+/**
+ * Runs a fixed set of independent tasks on several threads. Tasks are numbered 0 to taskCount - 1
+ * and each worker starts with a contiguous range of them, so tasks that are next to each other
+ * (for example groups of points in neighboring chunks) mostly run on the same worker. A worker
+ * that runs out of tasks steals half of the remaining range from the back of another worker,
+ * which balances the load when some tasks take much longer than others.
+ */
+class WorkStealingScheduler
+{
+public:
+
+    /**
+     * @param threadCount Number of threads to run tasks on, including the calling thread. 0 is treated as 1.
+     */
+    WorkStealingScheduler(unsigned int threadCount);
+
+    /**
+     * Runs every task once and returns when all of them are done. The calling thread is used as worker 0.
+     * If a task throws, the remaining tasks that have not started are skipped and the first exception
+     * is rethrown here after all workers have stopped.
+     * @param taskCount Number of tasks to run
+     * @param task Called with the task number and the index of the worker running it
+     */
+    void run(size_t taskCount, const std::function<void(size_t task, unsigned int worker)>& task);
+
+    /**
+     * @return The number of threads tasks are run on.
+     */
+    unsigned int getThreadCount() const;
+
+private:
+
+    /**
+     * The range of tasks [begin, end) that a worker still has to run.
+     */
+    struct TaskRange
+    {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    /**
+     * Runs tasks from the worker's own range, stealing from the other workers when it is empty.
+     */
+    void work(unsigned int worker, const std::function<void(size_t, unsigned int)>& task);
+
+    /**
+     * Takes the next task from the front of the worker's own range.
+     * @return False if the range is empty.
+     */
+    bool popTask(unsigned int worker, size_t& task);
+
+    /**
+     * Moves half of the remaining tasks of another worker into this worker's range.
+     * @return False if every other worker is out of tasks.
+     */
+    bool stealTasks(unsigned int worker);
+
+private:
+    unsigned int threadCount;
+    std::vector<std::unique_ptr<TaskRange>> ranges;
+};
+
+}
+#endif
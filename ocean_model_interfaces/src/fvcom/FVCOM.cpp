@@ -1,8 +1,11 @@
 #include "ocean_model_interfaces/fvcom/FVCOM.h"
 #include "ocean_model_interfaces/model_interface/ModelData.h"
 #include "ocean_model_interfaces/util/Point.h"
+#include "ocean_model_interfaces/util/WorkStealingScheduler.h"
 
 #include <stdexcept>
+#include <algorithm>
+#include <vector>
 #include <math.h>
 #include  <limits>
 
@@ -10,17 +13,22 @@ using namespace ocean_model_interfaces;
 
 #define SECONDS_IN_DAY 86400
 
+static size_t chunkMemoryUsage(const std::shared_ptr<const FVCOMChunk>& chunk)
+{
+    return chunk->getMemoryUsage();
+}
+
 FVCOM::FVCOM() {}
 
 FVCOM::FVCOM(std::string filename) :
-    chunkCache(LRUCache<unsigned int, FVCOMChunk>(100)),
+    chunkCache(ConcurrentCache<unsigned int, ChunkHandle>(100, chunkMemoryUsage)),
     structure(FVCOMStructure(filename, 2000, 2000, 100, 10)),
     startLoad(nullptr),
     endLoad(nullptr)
 {}
 
 FVCOM::FVCOM(std::string filename, std::function<void(void)> startLoad, std::function<void(void)> endLoad) :
-    chunkCache(LRUCache<unsigned int, FVCOMChunk>(100)),
+    chunkCache(ConcurrentCache<unsigned int, ChunkHandle>(100, chunkMemoryUsage)),
     structure(FVCOMStructure(filename, 2000, 2000, 100, 10)),
     startLoad(startLoad),
     endLoad(endLoad)
@@ -28,9 +36,10 @@ FVCOM::FVCOM(std::string filename, std::function<void(void)> startLoad, std::fun
 
 }
 
-FVCOM::FVCOM(std::string filename, unsigned int xChunkSize, unsigned int yChunkSize, unsigned int siglayChunkSize, unsigned int timeChunkSize, unsigned int cacheSize) :
-    chunkCache(LRUCache<unsigned int, FVCOMChunk>(cacheSize)),
-    structure(FVCOMStructure(filename, xChunkSize, yChunkSize, siglayChunkSize, timeChunkSize)),
+FVCOM::FVCOM(std::string filename, unsigned int xChunkSize, unsigned int yChunkSize, unsigned int siglayChunkSize, unsigned int timeChunkSize, unsigned int cacheSize,
+             const std::string structureCacheFile) :
+    chunkCache(ConcurrentCache<unsigned int, ChunkHandle>(cacheSize, chunkMemoryUsage)),
+    structure(FVCOMStructure(filename, xChunkSize, yChunkSize, siglayChunkSize, timeChunkSize, structureCacheFile)),
     startLoad(nullptr),
     endLoad(nullptr)
 {}
@@ -42,27 +51,65 @@ FVCOM::FVCOM(std::string filename,
              unsigned int yChunkSize,
              unsigned int siglayChunkSize,
              unsigned int timeChunkSize,
-             unsigned int cacheSize) :
-        chunkCache(LRUCache<unsigned int, FVCOMChunk>(cacheSize)),
-        structure(FVCOMStructure(filename, xChunkSize, yChunkSize, siglayChunkSize, timeChunkSize)),
+             unsigned int cacheSize,
+             const std::string structureCacheFile) :
+        chunkCache(ConcurrentCache<unsigned int, ChunkHandle>(cacheSize, chunkMemoryUsage)),
+        structure(FVCOMStructure(filename, xChunkSize, yChunkSize, siglayChunkSize, timeChunkSize, structureCacheFile)),
         startLoad(startLoad),
         endLoad(endLoad)
 {}
 
-ModelData FVCOM::interpolate(Point interpolatePoint, double time)
-{    
-    int time1Index, time2Index;
-    double time1Percent;
+FVCOM::~FVCOM()
+{
+    stopPrefetching();
+}
 
-    int siglay1Index, siglay2Index;
-    double siglay1Percent;
+void FVCOM::setCacheMemoryLimit(size_t bytes)
+{
+    chunkCache.setMemoryLimit(bytes);
+}
+
+size_t FVCOM::getCacheMemoryUsage() const
+{
+    return chunkCache.memoryUsage();
+}
+
+size_t FVCOM::getPeakCacheMemoryUsage() const
+{
+    return chunkCache.peakMemoryUsage();
+}
+
+size_t FVCOM::getCachedChunkCount() const
+{
+    return chunkCache.size();
+}
+
+ModelData FVCOM::interpolate(Point interpolatePoint, double time, QueryContext& context)
+{
+    return interpolate(interpolatePoint, locate(interpolatePoint, time, context));
+}
+
+FVCOM::Location FVCOM::locate(Point interpolatePoint, double time, QueryContext& context)
+{
+    Location location;
+    location.containingTriangle = structure.getContainingTriangle(interpolatePoint, context);
 
-    int containingTriangle = structure.getContainingTriangle(interpolatePoint);
-    
     //Get indicies and ratio of time and siglay
-    structure.timeInterpolation(time, time1Index, time2Index, time1Percent);
-    structure.siglayInterpolation(interpolatePoint, siglay1Index, siglay2Index, siglay1Percent, containingTriangle);
+    structure.timeInterpolation(time, location.time1Index, location.time2Index, location.time1Percent, context);
+    structure.siglayInterpolation(interpolatePoint, location.siglay1Index, location.siglay2Index, location.siglay1Percent, location.containingTriangle, context);
 
+    return location;
+}
+
+ModelData FVCOM::interpolate(Point interpolatePoint, const Location& location)
+{
+    const int containingTriangle = location.containingTriangle;
+    const int time1Index = location.time1Index;
+    const int time2Index = location.time2Index;
+    const double time1Percent = location.time1Percent;
+    const int siglay1Index = location.siglay1Index;
+    const int siglay2Index = location.siglay2Index;
+    const double siglay1Percent = location.siglay1Percent;
 
     //Interpolate X, Y
     FVCOMChunk::NodeDataInterp siglay1Time1NodeData; 
@@ -134,9 +181,9 @@ FVCOMChunk::NodeDataInterp FVCOM::nodeInterpolation(const Point& interpolatePoin
     Point p2 = structure.getNodePointWithH(surroundingNodes[1]);
     Point p3 = structure.getNodePointWithH(surroundingNodes[2]);
 
-    const FVCOMChunk::NodeData& p1Data = getNodeData(surroundingNodes[0], siglayIndex, timeIndex);
-    const FVCOMChunk::NodeData& p2Data = getNodeData(surroundingNodes[1], siglayIndex, timeIndex);
-    const FVCOMChunk::NodeData& p3Data = getNodeData(surroundingNodes[2], siglayIndex, timeIndex);
+    FVCOMChunk::NodeData p1Data = getNodeData(surroundingNodes[0], siglayIndex, timeIndex);
+    FVCOMChunk::NodeData p2Data = getNodeData(surroundingNodes[1], siglayIndex, timeIndex);
+    FVCOMChunk::NodeData p3Data = getNodeData(surroundingNodes[2], siglayIndex, timeIndex);
 
     double totalArea = areaOfTriangle(p1, p2, p3);
 
@@ -175,6 +222,11 @@ const double FVCOM::areaOfTriangle(const Point& p1, const Point& p2, const Point
 }
 
 const ModelData FVCOM::getDataHelper(double x, double y, double z, double time)
+{
+    return getDataHelperWithContext(x, y, z, time, defaultContext);
+}
+
+const ModelData FVCOM::getDataHelperWithContext(double x, double y, double z, double time, QueryContext& context)
 {
     Point interpolatePoint;
     interpolatePoint.x = x;
@@ -182,15 +234,20 @@ const ModelData FVCOM::getDataHelper(double x, double y, double z, double time)
     interpolatePoint.z = z;
 
     //Throw an exception if the requested point is outside of the model extent
-    if(!structure.pointInModel(interpolatePoint, time / SECONDS_IN_DAY))
+    if(!structure.pointInModel(interpolatePoint, time / SECONDS_IN_DAY, context))
     {
         throw std::out_of_range("FVCOM request outside of model extent");
     }
 
-    return interpolate(interpolatePoint, time / SECONDS_IN_DAY);
+    return interpolate(interpolatePoint, time / SECONDS_IN_DAY, context);
 }
 
 const ModelData FVCOM::getDataOutOfRangeHelper(double x, double y, double z, double time)
+{
+    return getDataOutOfRangeHelperWithContext(x, y, z, time, defaultContext);
+}
+
+const ModelData FVCOM::getDataOutOfRangeHelperWithContext(double x, double y, double z, double time, QueryContext& context)
 {
     //if out of range XY then get closest node
     //if out of range time then get closest time
@@ -217,7 +274,7 @@ const ModelData FVCOM::getDataOutOfRangeHelper(double x, double y, double z, dou
     }
     else if(!structure.timeInModel(time / SECONDS_IN_DAY))
     {
-        data.depth = structure.getDepthAtPoint(interpolatePoint);
+        data.depth = structure.getDepthAtPoint(interpolatePoint, context);
         data.u = std::numeric_limits<double>::quiet_NaN();
         data.v = std::numeric_limits<double>::quiet_NaN();
         data.w = std::numeric_limits<double>::quiet_NaN();
@@ -226,9 +283,9 @@ const ModelData FVCOM::getDataOutOfRangeHelper(double x, double y, double z, dou
         data.temp = std::numeric_limits<double>::quiet_NaN();
         data.dye = std::numeric_limits<double>::quiet_NaN();
     }
-    else if(!structure.depthInModel(interpolatePoint))
+    else if(!structure.depthInModel(interpolatePoint, context))
     {
-        data.depth = structure.getDepthAtPoint(interpolatePoint);
+        data.depth = structure.getDepthAtPoint(interpolatePoint, context);
         data.u = std::numeric_limits<double>::quiet_NaN();
         data.v = std::numeric_limits<double>::quiet_NaN();
         data.w = std::numeric_limits<double>::quiet_NaN();
@@ -241,52 +298,245 @@ const ModelData FVCOM::getDataOutOfRangeHelper(double x, double y, double z, dou
     return data;
 }
 
-const FVCOMChunk::NodeData& FVCOM::getNodeData(int node, int siglayNodeIndex, int timeIndex)
+void FVCOM::getDataBatchHelper(const double* x, const double* y, const double* z, const double* time, size_t n, ModelDataSoA& out)
 {
-    FVCOMStructure::ChunkInfo nodeChunkInfo = structure.getChunkForNode(node, siglayNodeIndex, timeIndex);
-    if(!chunkCache.exists(nodeChunkInfo.id))
+    WorkStealingScheduler scheduler(batchThreadCount);
+    std::vector<QueryContext> contexts(scheduler.getThreadCount());
+    std::vector<Location> locations(n);
+    std::vector<unsigned char> located(n, 0);
+    std::vector<unsigned int> chunkIds(n);
+
+    //Locate in blocks of consecutive points so points along a path reuse the search hints of their worker
+    size_t blockCount = (n + BATCH_BLOCK_SIZE - 1) / BATCH_BLOCK_SIZE;
+    scheduler.run(blockCount, [&](size_t block, unsigned int worker)
+    {
+        QueryContext& context = contexts[worker];
+        size_t blockEnd = std::min(n, (block + 1) * BATCH_BLOCK_SIZE);
+        for(size_t i = block * BATCH_BLOCK_SIZE; i < blockEnd; i++)
+        {
+            Point interpolatePoint(x[i], y[i], z[i]);
+            double modelTime = time[i] / SECONDS_IN_DAY;
+
+            if(!structure.pointInModel(interpolatePoint, modelTime, context))
+            {
+                out.set(i, getDataOutOfRangeHelperWithContext(x[i], y[i], z[i], time[i], context), false);
+                continue;
+            }
+
+            locations[i] = locate(interpolatePoint, modelTime, context);
+            chunkIds[i] = structure.getChunkForTriangle(locations[i].containingTriangle, locations[i].siglay1Index, locations[i].time1Index).id;
+            located[i] = 1;
+        }
+    });
+
+    //Group the points by chunk so each chunk is visited by consecutive points on one worker
+    std::vector<std::pair<unsigned int, size_t>> order;
+    order.reserve(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        if(located[i])
+        {
+            order.push_back(std::make_pair(chunkIds[i], i));
+        }
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+                     [](const std::pair<unsigned int, size_t>& a, const std::pair<unsigned int, size_t>& b) { return a.first < b.first; });
+
+    std::vector<size_t> groupStarts;
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        if(i == 0 || order[i].first != order[i - 1].first)
+        {
+            groupStarts.push_back(i);
+        }
+    }
+    groupStarts.push_back(order.size());
+
+    scheduler.run(groupStarts.size() - 1, [&](size_t group, unsigned int worker)
+    {
+        for(size_t j = groupStarts[group]; j < groupStarts[group + 1]; j++)
+        {
+            size_t i = order[j].second;
+            out.set(i, interpolate(Point(x[i], y[i], z[i]), locations[i]), true);
+        }
+    });
+}
+
+void FVCOM::prefetchHelper(double x, double y, double z, double time, double radius, double timeWindow)
+{
+    Point center(x, y, z);
+
+    //Only the siglays around z are needed if the point is on the mesh, otherwise the depth is unknown
+    unsigned int siglayStart = 0;
+    unsigned int siglayEnd = structure.getNumSiglays() - 1;
+    if(structure.xyInModel(center))
     {
-        if(startLoad)
+        int containingTriangle = -1;
+        try
+        {
+            containingTriangle = structure.getContainingTriangle(center);
+        }
+        catch(const std::out_of_range& e)
+        {
+            //Inside the bounding box but off the mesh, so keep every siglay
+        }
+
+        if(containingTriangle >= 0)
         {
-            startLoad();
+            int siglay1Index, siglay2Index;
+            double siglay1Percent;
+            structure.siglayInterpolation(center, siglay1Index, siglay2Index, siglay1Percent, containingTriangle);
+
+            siglayStart = std::min(siglay1Index, siglay2Index);
+            siglayEnd = std::max(siglay1Index, siglay2Index);
         }
-        const std::vector<unsigned int>& nodesToLoad = structure.getNodesInChunk(nodeChunkInfo);
-        const std::vector<unsigned int>& trianglesToLoad = structure.getTrianglesInChunk(nodeChunkInfo);
+    }
 
-        chunkCache.put(nodeChunkInfo.id, FVCOMChunk(structure.getModelFiles(), nodesToLoad, trianglesToLoad, nodeChunkInfo));
-        if(endLoad)
+    std::vector<FVCOMStructure::ChunkInfo> chunks = structure.getChunksInRegion(x - radius, y - radius, x + radius, y + radius,
+                                                                                siglayStart, siglayEnd,
+                                                                                time / SECONDS_IN_DAY, (time + timeWindow) / SECONDS_IN_DAY);
+
+    for(const FVCOMStructure::ChunkInfo& chunkInfo : chunks)
+    {
+        if(chunkCache.exists(chunkInfo.id))
         {
-            endLoad();
+            continue;
         }
+
+        prefetchLoader.enqueue(chunkInfo.id, [this, chunkInfo]()
+        {
+            if(!chunkCache.exists(chunkInfo.id))
+            {
+                chunkCache.put(chunkInfo.id, readChunk(chunkInfo));
+            }
+        });
     }
+}
 
-    FVCOMChunk& nodeChunk = chunkCache.get(nodeChunkInfo.id);
-    const FVCOMChunk::NodeData& nodeData = nodeChunk.getNodeData(node, siglayNodeIndex, timeIndex);
+FVCOMChunk::NodeData FVCOM::getNodeData(int node, int siglayNodeIndex, int timeIndex)
+{
+    FVCOMStructure::ChunkInfo nodeChunkInfo = structure.getChunkForNode(node, siglayNodeIndex, timeIndex);
 
-    return nodeData;
+    return getChunk(nodeChunkInfo)->getNodeData(structure.getNodeIndexInChunk(node), siglayNodeIndex, timeIndex);
 }
 
-const FVCOMChunk::TriangleData& FVCOM::getTriangleData(int triangle, int siglayTriangleIndex, int timeIndex)
+FVCOMChunk::TriangleData FVCOM::getTriangleData(int triangle, int siglayTriangleIndex, int timeIndex)
 {
     FVCOMStructure::ChunkInfo triangleChunkInfo = structure.getChunkForTriangle(triangle, siglayTriangleIndex, timeIndex);
-    if(!chunkCache.exists(triangleChunkInfo.id))
+
+    return getChunk(triangleChunkInfo)->getTriangleData(structure.getTriangleIndexInChunk(triangle), siglayTriangleIndex, timeIndex);
+}
+
+FVCOM::ChunkHandle FVCOM::getChunk(const FVCOMStructure::ChunkInfo& chunkInfo)
+{
+    //Only the handle is copied while the shard is locked, the chunk is read after the lock is released
+    ChunkHandle chunk;
+    auto pin = [&chunk](ChunkHandle& cached) { chunk = cached; };
+
+    //A prefetch may already be loading this chunk, in which case wait for it instead of loading it again
+    if(!chunkCache.visit(chunkInfo.id, pin) &&
+       !(prefetchLoader.waitFor(chunkInfo.id) && chunkCache.visit(chunkInfo.id, pin)))
+    {
+        chunk = loadChunk(chunkInfo);
+        chunkCache.put(chunkInfo.id, chunk);
+    }
+
+    return chunk;
+}
+
+void FVCOM::writeChunkStore(const std::string& filename)
+{
+    ChunkStoreWriter writer(filename, structure.getChunkLayoutKey(), FVCOMChunk::getVariableNames(), structure.getNumChunks());
+
+    std::vector<const float*> values(FVCOMChunk::NUM_VARIABLES);
+    std::vector<size_t> counts(FVCOMChunk::NUM_VARIABLES);
+    for(const FVCOMStructure::ChunkInfo& chunkInfo : structure.getAllChunks())
     {
-        if(startLoad)
+        ChunkHandle chunk = readChunkFromModelFiles(chunkInfo);
+        for(unsigned int i = 0; i < FVCOMChunk::NUM_VARIABLES; i++)
         {
-            startLoad();
+            values[i] = chunk->getValues(FVCOMChunk::Variable(i));
+            counts[i] = chunk->getNumValues(FVCOMChunk::Variable(i));
         }
-        const std::vector<unsigned int>& nodesToLoad = structure.getNodesInChunk(triangleChunkInfo);
-        const std::vector<unsigned int>& trianglesToLoad = structure.getTrianglesInChunk(triangleChunkInfo);
+        writer.writeChunk(chunkInfo.id, values, counts);
+    }
+
+    writer.finish();
+}
 
-        chunkCache.put(triangleChunkInfo.id, FVCOMChunk(structure.getModelFiles(), nodesToLoad, trianglesToLoad, triangleChunkInfo));
-        if(endLoad)
+void FVCOM::setChunkStore(const std::string& filename)
+{
+    std::shared_ptr<const ChunkStore> store;
+    if(!filename.empty())
+    {
+        store = std::make_shared<const ChunkStore>(filename);
+        if(store->getKey() != structure.getChunkLayoutKey() || store->getVariables() != FVCOMChunk::getVariableNames())
         {
-            endLoad();
+            throw std::runtime_error("Chunk store " + filename + " was written for a different chunk layout");
         }
     }
 
-    FVCOMChunk& triangleChunk = chunkCache.get(triangleChunkInfo.id);
-    const FVCOMChunk::TriangleData& triangleData = triangleChunk.getTriangleData(triangle, siglayTriangleIndex, timeIndex);
+    //Background loads read the store, so none can be running while it is replaced
+    waitForPrefetch();
+    chunkStore = store;
+}
+
+void FVCOM::setStorageBackend(std::shared_ptr<StorageBackend> backend)
+{
+    //Background loads read through the backend, so none can be running while it is replaced
+    waitForPrefetch();
+    structure.setStorageBackend(backend);
+}
+
+FVCOM::ChunkHandle FVCOM::readChunk(const FVCOMStructure::ChunkInfo& chunkInfo)
+{
+    if(chunkStore)
+    {
+        return std::make_shared<const FVCOMChunk>(chunkStore, chunkInfo, structure.getNodesInChunk(chunkInfo).size(),
+                                                  structure.getTrianglesInChunk(chunkInfo).size());
+    }
+
+    return readChunkFromModelFiles(chunkInfo);
+}
+
+FVCOM::ChunkHandle FVCOM::readChunkFromModelFiles(const FVCOMStructure::ChunkInfo& chunkInfo)
+{
+    const std::vector<unsigned int>& nodesToLoad = structure.getNodesInChunk(chunkInfo);
+    const std::vector<unsigned int>& trianglesToLoad = structure.getTrianglesInChunk(chunkInfo);
+
+    //Reordered files store the nodes and triangles at different indices
+    std::vector<unsigned int> nodeFileIndices;
+    std::vector<unsigned int> triangleFileIndices;
+    if(structure.isReordered())
+    {
+        for(unsigned int node : nodesToLoad)
+        {
+            nodeFileIndices.push_back(structure.getNodeFileIndex(node));
+        }
+        for(unsigned int triangle : trianglesToLoad)
+        {
+            triangleFileIndices.push_back(structure.getTriangleFileIndex(triangle));
+        }
+    }
+
+    return std::make_shared<const FVCOMChunk>(structure.getModelFiles(), nodesToLoad, trianglesToLoad, chunkInfo, structure.getStorageBackend(),
+                                              nodeFileIndices, triangleFileIndices);
+}
+
+FVCOM::ChunkHandle FVCOM::loadChunk(const FVCOMStructure::ChunkInfo& chunkInfo)
+{
+    if(startLoad)
+    {
+        startLoad();
+    }
+
+    ChunkHandle chunk = readChunk(chunkInfo);
+
+    if(endLoad)
+    {
+        endLoad();
+    }
 
-    return triangleData;
+    return chunk;
 }
@@ -1,158 +1,241 @@
 #include "ocean_model_interfaces/fvcom/FVCOMChunk.h"
 #include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
+#include "ocean_model_interfaces/util/StorageBackend.h"
 
-#include <unordered_map>
 #include <vector>
-
-#include <netcdf>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace ocean_model_interfaces;
 
-FVCOMChunk::FVCOMChunk(const std::vector<FVCOMStructure::ModelFile> modelFiles, std::vector<unsigned int> nodesToLoad,
-                                               std::vector<unsigned int> trianglesToLoad,
-                                               FVCOMStructure::ChunkInfo chunkInfo) :
-    chunkInfo(chunkInfo)
-{
-    unsigned int startModelFile = getFileIndexForTimeIndex(modelFiles, chunkInfo.timeStart);
-    unsigned int endModelFile = getFileIndexForTimeIndex(modelFiles, chunkInfo.timeStart + chunkInfo.timeSize);
-    
-    nodes.reserve(nodesToLoad.size());
-    triangles.reserve(trianglesToLoad.size());
-
-    std::vector<float> uLoad;
-    std::vector<float> vLoad;
-    std::vector<float> wLoad;
-    std::vector<float> tempLoad;
-    std::vector<float> saltLoad;    
-    std::vector<float> dyeLoad;
-
-    //Initalize node data storage
-    for(unsigned int i = 0; i < nodesToLoad.size(); i++)
-    {
-        tempLoad.resize(chunkInfo.timeSize * chunkInfo.siglaySize);
-        saltLoad.resize(chunkInfo.timeSize * chunkInfo.siglaySize);
-        dyeLoad.resize(chunkInfo.timeSize * chunkInfo.siglaySize);
+//Elements this close together are read with one request, reading the values between them too.
+//Skipped elements cost a little extra data while every request has a large fixed overhead in HDF5.
+static const unsigned int MAX_READ_GAP = 32;
 
-        nodes.insert(std::make_pair(nodesToLoad[i], std::vector<FVCOMChunk::NodeData>(tempLoad.size())));
-    }
+//Largest number of elements read with one request, to bound the size of the read buffer
+static const unsigned int MAX_READ_SPAN = 4096;
 
-    //Initalize triange data storage
-    for(unsigned int i = 0; i < trianglesToLoad.size(); i++)
-    {
-        uLoad.resize(chunkInfo.timeSize * chunkInfo.siglaySize);
-        vLoad.resize(chunkInfo.timeSize * chunkInfo.siglaySize);
-        wLoad.resize(chunkInfo.timeSize * chunkInfo.siglaySize);
+/**
+ * A contiguous range of element indicies [start, start + count) read with a single request.
+ * The elements to load that are inside it are sortedElements[firstElement, endElement).
+ */
+struct ReadRange
+{
+    unsigned int start;
+    unsigned int count;
+    size_t firstElement;
+    size_t endElement;
+};
 
-        triangles.insert(std::make_pair(trianglesToLoad[i], std::vector<FVCOMChunk::TriangleData>(uLoad.size())));
+/**
+ * Groups the elements to load into ranges that can each be read with one request.
+ * @param elementsToLoad Node or triangle indicies in the order they are stored in the load buffers
+ * @param sortedElements Set to the pairs of (element index, position in elementsToLoad), sorted by element index
+ * @return The ranges to read in increasing order.
+ */
+static std::vector<ReadRange> planReads(const std::vector<unsigned int>& elementsToLoad, std::vector<std::pair<unsigned int, unsigned int>>& sortedElements)
+{
+    sortedElements.resize(elementsToLoad.size());
+    for(unsigned int i = 0; i < elementsToLoad.size(); i++)
+    {
+        sortedElements[i] = std::make_pair(elementsToLoad[i], i);
     }
-    bool dyeVarExists = true;
-    for(unsigned int i = 0; i < nodesToLoad.size(); i++)
+    std::sort(sortedElements.begin(), sortedElements.end());
+
+    std::vector<ReadRange> ranges;
+    for(size_t i = 0; i < sortedElements.size(); i++)
     {
-        unsigned int timeIndex = chunkInfo.timeStart;
-        unsigned int dataIndex = 0;
+        unsigned int element = sortedElements[i].first;
 
-        for(unsigned int f = startModelFile; f <= endModelFile; f++)
+        if(!ranges.empty())
         {
-            netCDF::NcFile dataFile(modelFiles[f].filename, netCDF::NcFile::read);
-            netCDF::NcVar tempVar = dataFile.getVar("temp");
-            netCDF::NcVar saltVar = dataFile.getVar("salinity");
-            netCDF::NcVar dyeVar = dataFile.getVar("DYE");
-
-            //Adjust time index for this file 
-            unsigned int adjustedTimeIndex = timeIndex - modelFiles[f].startTimeIndex;
-
-            //calculate the size of the time dimension that needs to be loaded
-            unsigned int timeCount = std::min(chunkInfo.timeSize - (timeIndex - chunkInfo.timeStart), modelFiles[f].timeDim - adjustedTimeIndex);
-
-            //set start and count variables
-            std::vector<size_t> start = {adjustedTimeIndex, chunkInfo.siglayStart, nodesToLoad[i]};
-            std::vector<size_t> count = {timeCount, chunkInfo.siglaySize, 1};
- 
-            //load data
-            tempVar.getVar(start, count, tempLoad.data() + dataIndex);
-            saltVar.getVar(start, count, saltLoad.data() + dataIndex);
-            //Load the dye variable if it exists
-            if(!dyeVar.isNull())
-            {
-                dyeVar.getVar(start, count, dyeLoad.data() + dataIndex);
-            }
-            else
+            ReadRange& range = ranges.back();
+            unsigned int rangeEnd = range.start + range.count;
+
+            if(element < rangeEnd + MAX_READ_GAP && element - range.start < MAX_READ_SPAN)
             {
-                dyeVarExists = false;
+                range.count = std::max(rangeEnd, element + 1) - range.start;
+                range.endElement = i + 1;
+                continue;
             }
-            
-
-            //Update time and data indicies
-            timeIndex += timeCount;
-            dataIndex += timeCount * chunkInfo.siglaySize;
-            dataFile.close();
         }
 
-        std::vector<FVCOMChunk::NodeData>& dataList = nodes[nodesToLoad[i]];
+        ReadRange range;
+        range.start = element;
+        range.count = 1;
+        range.firstElement = i;
+        range.endElement = i + 1;
+        ranges.push_back(range);
+    }
 
-        //populate vector of NodeData objects
-        for(unsigned int j = 0; j < tempLoad.size(); j++)
+    return ranges;
+}
+
+/**
+ * Reads a variable for every element in ranges from one file and scatters the values to the load buffer,
+ * where each element has valuesPerElement values ordered by time and then siglay.
+ * @param backend Storage to read from
+ * @param filename Model file to read
+ * @param variable Variable with dimensions time, siglay, element
+ * @param timeStart First time index to read in the file
+ * @param timeCount Number of times to read
+ * @param siglayStart First siglay index to read
+ * @param siglayCount Number of siglays to read
+ * @param sortedElements Elements to read sorted by index as returned by planReads
+ * @param ranges Ranges to read as returned by planReads
+ * @param valuesPerElement Number of values stored for each element in out
+ * @param dataIndex Offset of the first time read within each element's values
+ * @param readBuffer Scratch space for the values read
+ * @param out Load buffer to scatter the values into
+ */
+static void readElements(StorageBackend& backend, const std::string& filename, const std::string& variable,
+                         unsigned int timeStart, unsigned int timeCount,
+                         unsigned int siglayStart, unsigned int siglayCount,
+                         const std::vector<std::pair<unsigned int, unsigned int>>& sortedElements,
+                         const std::vector<ReadRange>& ranges,
+                         unsigned int valuesPerElement, unsigned int dataIndex,
+                         std::vector<float>& readBuffer, float* out)
+{
+    unsigned int valuesPerRead = timeCount * siglayCount;
+
+    for(const ReadRange& range : ranges)
+    {
+        std::vector<size_t> start = {timeStart, siglayStart, range.start};
+        std::vector<size_t> count = {timeCount, siglayCount, range.count};
+
+        readBuffer.resize(valuesPerRead * range.count);
+        backend.read(filename, variable, start, count, readBuffer.data());
+
+        //The buffer is ordered by time, siglay, then element
+        for(size_t e = range.firstElement; e < range.endElement; e++)
         {
-            FVCOMChunk::NodeData data;
-            data.temp = tempLoad[j];
-            data.salt = saltLoad[j];
+            unsigned int column = sortedElements[e].first - range.start;
+            float* elementOut = out + sortedElements[e].second * valuesPerElement + dataIndex;
 
-            if(dyeVarExists)
+            for(unsigned int j = 0; j < valuesPerRead; j++)
             {
-                data.dye = dyeLoad[j];
+                elementOut[j] = readBuffer[j * range.count + column];
             }
-            else
-            {
-                data.dye = 0;
-            }
-            dataList[j] = data;
         }
     }
-    for(unsigned int i = 0; i < trianglesToLoad.size(); i++)
-    {
-        unsigned int timeIndex = chunkInfo.timeStart;
-        unsigned int dataIndex = 0;
+}
 
-        for(unsigned int f = startModelFile; f <= endModelFile; f++)
-        {
-            netCDF::NcFile dataFile(modelFiles[f].filename, netCDF::NcFile::read);
-            netCDF::NcVar uVar = dataFile.getVar("u");
-            netCDF::NcVar vVar = dataFile.getVar("v");
-            netCDF::NcVar wVar = dataFile.getVar("ww");
+FVCOMChunk::FVCOMChunk(const std::vector<FVCOMStructure::ModelFile> modelFiles, std::vector<unsigned int> nodesToLoad,
+                                               std::vector<unsigned int> trianglesToLoad,
+                                               FVCOMStructure::ChunkInfo chunkInfo,
+                                               StorageBackend& backend,
+                                               const std::vector<unsigned int>& nodeFileIndices,
+                                               const std::vector<unsigned int>& triangleFileIndices) :
+    chunkInfo(chunkInfo)
+{
+    unsigned int startModelFile = getFileIndexForTimeIndex(modelFiles, chunkInfo.timeStart);
+    unsigned int endModelFile = getFileIndexForTimeIndex(modelFiles, chunkInfo.timeStart + chunkInfo.timeSize);
 
-            //Adjust time index for this file 
-            unsigned int adjustedTimeIndex = timeIndex - modelFiles[f].startTimeIndex;
+    //Number of values stored for each node or triangle
+    valuesPerElement = chunkInfo.timeSize * chunkInfo.siglaySize;
 
-            //calculate the size of the time dimension that needs to be loaded
-            unsigned int timeCount = std::min(chunkInfo.timeSize - (timeIndex - chunkInfo.timeStart), modelFiles[f].timeDim - adjustedTimeIndex);
+    //All variables share one buffer, node variables first
+    size_t nodeValues = nodesToLoad.size() * valuesPerElement;
+    size_t triangleValues = trianglesToLoad.size() * valuesPerElement;
+    loadedValues.resize(3 * nodeValues + 3 * triangleValues);
 
-            //set start and count variables
-            std::vector<size_t> start = {adjustedTimeIndex, chunkInfo.siglayStart, trianglesToLoad[i]};
-            std::vector<size_t> count = {timeCount, chunkInfo.siglaySize, 1};
+    float* temp = loadedValues.data();
+    float* salt = temp + nodeValues;
+    float* dye = salt + nodeValues;
+    float* u = dye + nodeValues;
+    float* v = u + triangleValues;
+    float* w = v + triangleValues;
 
-            uVar.getVar(start, count, uLoad.data() + dataIndex);
-            vVar.getVar(start, count, vLoad.data() + dataIndex);
-            wVar.getVar(start, count, wLoad.data() + dataIndex);
+    values[TEMP] = temp;
+    values[SALT] = salt;
+    values[DYE] = dye;
+    values[U] = u;
+    values[V] = v;
+    values[W] = w;
+    std::fill(numValues, numValues + U, nodeValues);
+    std::fill(numValues + U, numValues + NUM_VARIABLES, triangleValues);
 
-            //Update time and data indicies
-            timeIndex += timeCount;
-            dataIndex += timeCount * chunkInfo.siglaySize;
-            dataFile.close();
-        }
+    //Nearby elements are read together with one request per range instead of one request per element
+    std::vector<std::pair<unsigned int, unsigned int>> sortedNodes;
+    std::vector<std::pair<unsigned int, unsigned int>> sortedTriangles;
+    std::vector<ReadRange> nodeRanges = planReads(nodeFileIndices.empty() ? nodesToLoad : nodeFileIndices, sortedNodes);
+    std::vector<ReadRange> triangleRanges = planReads(triangleFileIndices.empty() ? trianglesToLoad : triangleFileIndices, sortedTriangles);
+    std::vector<float> readBuffer;
 
-        std::vector<FVCOMChunk::TriangleData>& dataList = triangles[trianglesToLoad[i]];
+    bool dyeVarExists = true;
+    unsigned int timeIndex = chunkInfo.timeStart;
+    unsigned int dataIndex = 0;
+    for(unsigned int f = startModelFile; f <= endModelFile; f++)
+    {
+        const std::string& filename = modelFiles[f].filename;
+
+        //Adjust time index for this file
+        unsigned int adjustedTimeIndex = timeIndex - modelFiles[f].startTimeIndex;
+
+        //calculate the size of the time dimension that needs to be loaded
+        unsigned int timeCount = std::min(chunkInfo.timeSize - (timeIndex - chunkInfo.timeStart), modelFiles[f].timeDim - adjustedTimeIndex);
+
+        const std::vector<std::string>& names = getVariableNames();
 
-        //populate vector of TriangleData objects
-        for(unsigned int j = 0 ; j < uLoad.size(); j++)
+        readElements(backend, filename, names[TEMP], adjustedTimeIndex, timeCount, chunkInfo.siglayStart, chunkInfo.siglaySize,
+                     sortedNodes, nodeRanges, valuesPerElement, dataIndex, readBuffer, temp);
+        readElements(backend, filename, names[SALT], adjustedTimeIndex, timeCount, chunkInfo.siglayStart, chunkInfo.siglaySize,
+                     sortedNodes, nodeRanges, valuesPerElement, dataIndex, readBuffer, salt);
+
+        //The dye variable is optional
+        if(backend.hasVariable(filename, names[DYE]))
+        {
+            readElements(backend, filename, names[DYE], adjustedTimeIndex, timeCount, chunkInfo.siglayStart, chunkInfo.siglaySize,
+                         sortedNodes, nodeRanges, valuesPerElement, dataIndex, readBuffer, dye);
+        }
+        else
         {
-            FVCOMChunk::TriangleData data;
-            data.u = uLoad[j];
-            data.v = vLoad[j];
-            data.w = wLoad[j];
-            dataList[j] = data;
+            dyeVarExists = false;
         }
+
+        readElements(backend, filename, names[U], adjustedTimeIndex, timeCount, chunkInfo.siglayStart, chunkInfo.siglaySize,
+                     sortedTriangles, triangleRanges, valuesPerElement, dataIndex, readBuffer, u);
+        readElements(backend, filename, names[V], adjustedTimeIndex, timeCount, chunkInfo.siglayStart, chunkInfo.siglaySize,
+                     sortedTriangles, triangleRanges, valuesPerElement, dataIndex, readBuffer, v);
+        readElements(backend, filename, names[W], adjustedTimeIndex, timeCount, chunkInfo.siglayStart, chunkInfo.siglaySize,
+                     sortedTriangles, triangleRanges, valuesPerElement, dataIndex, readBuffer, w);
+
+        //Update time and data indicies
+        timeIndex += timeCount;
+        dataIndex += timeCount * chunkInfo.siglaySize;
+    }
+
+    //Dye is only used if every file has it
+    if(!dyeVarExists)
+    {
+        std::fill(dye, dye + nodeValues, 0.0f);
     }
-    
+}
+
+FVCOMChunk::FVCOMChunk(std::shared_ptr<const ChunkStore> store, FVCOMStructure::ChunkInfo chunkInfo, size_t numNodes, size_t numTriangles) :
+    store(store),
+    chunkInfo(chunkInfo)
+{
+    valuesPerElement = chunkInfo.timeSize * chunkInfo.siglaySize;
+
+    for(unsigned int i = 0; i < NUM_VARIABLES; i++)
+    {
+        values[i] = store->getValues(chunkInfo.id, i, numValues[i]);
+    }
+
+    //Every node variable has a value for each node, time and siglay, and the same for triangles
+    if(!std::all_of(numValues, numValues + U, [&](size_t n) { return n == numNodes * valuesPerElement; }) ||
+       !std::all_of(numValues + U, numValues + NUM_VARIABLES, [&](size_t n) { return n == numTriangles * valuesPerElement; }))
+    {
+        throw std::runtime_error("Chunk " + std::to_string(chunkInfo.id) + " in the chunk store does not match the model");
+    }
+}
+
+const std::vector<std::string>& FVCOMChunk::getVariableNames()
+{
+    static const std::vector<std::string> names = {"temp", "salinity", "DYE", "u", "v", "ww"};
+    return names;
 }
 
 const unsigned int FVCOMChunk::getFileIndexForTimeIndex(const std::vector<FVCOMStructure::ModelFile>& modelFiles, const unsigned int timeIndex) const
@@ -167,17 +250,44 @@ const unsigned int FVCOMChunk::getFileIndexForTimeIndex(const std::vector<FVCOMS
     return modelFiles.size();
 }
 
-const FVCOMChunk::NodeData& FVCOMChunk::getNodeData(const unsigned int node, const unsigned int siglay, const unsigned int time)
+FVCOMChunk::NodeData FVCOMChunk::getNodeData(const unsigned int node, const unsigned int siglay, const unsigned int time) const
 {
-    std::vector<FVCOMChunk::NodeData>& data = nodes[node];
-    unsigned int index = (siglay - chunkInfo.siglayStart) + (time - chunkInfo.timeStart) * chunkInfo.siglaySize;
-    return data[index];
+    unsigned int index = getValueIndex(node, siglay, time);
+
+    FVCOMChunk::NodeData data;
+    data.temp = values[TEMP][index];
+    data.salt = values[SALT][index];
+    data.dye = values[DYE][index];
+    return data;
 }
 
-const FVCOMChunk::TriangleData& FVCOMChunk::getTriangleData(const unsigned int triangle, const unsigned int siglay, const unsigned int time)
+FVCOMChunk::TriangleData FVCOMChunk::getTriangleData(const unsigned int triangle, const unsigned int siglay, const unsigned int time) const
 {
-    const std::vector<FVCOMChunk::TriangleData>& data = triangles[triangle];
-    unsigned int index = (siglay - chunkInfo.siglayStart) + (time - chunkInfo.timeStart) * chunkInfo.siglaySize;
+    unsigned int index = getValueIndex(triangle, siglay, time);
 
-    return data[index];
+    FVCOMChunk::TriangleData data;
+    data.u = values[U][index];
+    data.v = values[V][index];
+    data.w = values[W][index];
+    return data;
+}
+
+unsigned int FVCOMChunk::getValueIndex(const unsigned int element, const unsigned int siglay, const unsigned int time) const
+{
+    return element * valuesPerElement + (time - chunkInfo.timeStart) * chunkInfo.siglaySize + (siglay - chunkInfo.siglayStart);
+}
+
+const float* FVCOMChunk::getValues(Variable variable) const
+{
+    return values[variable];
+}
+
+size_t FVCOMChunk::getNumValues(Variable variable) const
+{
+    return numValues[variable];
+}
+
+size_t FVCOMChunk::getMemoryUsage() const
+{
+    return sizeof(FVCOMChunk) + loadedValues.capacity() * sizeof(float);
 }
@@ -1,6 +1,9 @@
 #include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
 #include "ocean_model_interfaces/fvcom/FVCOM.h"
 #include "ocean_model_interfaces/util/UtilityFunctions.h"
+#include "ocean_model_interfaces/util/NetCDFMutex.h"
+#include "ocean_model_interfaces/util/MappedFile.h"
+#include "ocean_model_interfaces/util/NetCDFStorageBackend.h"
 
 #include <netcdf>
 #include <memory>
@@ -8,66 +11,154 @@
 #include <limits>
 #include <algorithm>
 #include <iterator>
+#include <map>
+#include <cstdint>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <utility>
+
+#include <unistd.h>
+#include <boost/filesystem.hpp>
 
 using namespace ocean_model_interfaces;
 
-FVCOMStructure::FVCOMStructure() {}
+/**
+ * @return Seconds elapsed since start
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+FVCOMStructure::FVCOMStructure() :
+    filePool(std::make_shared<NetCDFFilePool>()),
+    storageBackend(std::make_shared<NetCDFStorageBackend>(filePool))
+{}
 
 FVCOMStructure::FVCOMStructure(const std::string filename, int xChunkSize, int yChunkSize, int siglayChunkSize, int timeChunkSize) :
+    FVCOMStructure(filename, xChunkSize, yChunkSize, siglayChunkSize, timeChunkSize, "")
+{}
+
+FVCOMStructure::FVCOMStructure(const std::string filename, int xChunkSize, int yChunkSize, int siglayChunkSize, int timeChunkSize,
+                               const std::string structureCacheFile) :
+    filePool(std::make_shared<NetCDFFilePool>()),
+    storageBackend(std::make_shared<NetCDFStorageBackend>(filePool)),
     xChunkSize(xChunkSize),
     yChunkSize(yChunkSize),
     siglayChunkSize(siglayChunkSize),
-    timeChunkSize(timeChunkSize),
-    lastContainingTriangle(0)
+    timeChunkSize(timeChunkSize)
 {
-    loadStructureData(filename);
+    auto phaseStart = std::chrono::steady_clock::now();
+
+    std::string cacheKey;
+    bool cached = false;
+    if(!structureCacheFile.empty())
+    {
+        cacheKey = getStructureCacheKey(filename);
+        cached = readStructureCache(structureCacheFile, cacheKey, filename);
+    }
+
+    loadTimes.structureCache = secondsSince(phaseStart);
+
+    if(!cached)
+    {
+        {
+            std::lock_guard<std::mutex> lock(getNetCDFMutex());
+            loadStructureData(filename);
+        }
+
+        phaseStart = std::chrono::steady_clock::now();
+        splitIntoChunks();
+        loadTimes.splitIntoChunks = secondsSince(phaseStart);
 
-    splitIntoChunks();
+        if(!structureCacheFile.empty())
+        {
+            phaseStart = std::chrono::steady_clock::now();
+            writeStructureCache(structureCacheFile, cacheKey);
+            loadTimes.structureCache += secondsSince(phaseStart);
+        }
+    }
+
+    //The spatial indices are quick to rebuild, so they are not stored in the structure cache
+    phaseStart = std::chrono::steady_clock::now();
+    buildSpatialIndex();
+    loadTimes.buildSpatialIndex = secondsSince(phaseStart);
+}
+
+void FVCOMStructure::buildSpatialIndex()
+{
+    nodeTree = KDTree(nodes);
+
+    std::vector<BoundingVolumeHierarchy::Box> triangleBoxes(triangleToNodes.size());
+    for(unsigned int i = 0; i < triangleToNodes.size(); i++)
+    {
+        BoundingVolumeHierarchy::Box& box = triangleBoxes[i];
+        box.minX = box.maxX = nodes[triangleToNodes[i][0]].x;
+        box.minY = box.maxY = nodes[triangleToNodes[i][0]].y;
+        for(unsigned int j = 1; j < triangleToNodes[i].size(); j++)
+        {
+            const Point& node = nodes[triangleToNodes[i][j]];
+            box.minX = std::min(box.minX, node.x);
+            box.minY = std::min(box.minY, node.y);
+            box.maxX = std::max(box.maxX, node.x);
+            box.maxY = std::max(box.maxY, node.y);
+        }
+
+        //Pad the box slightly so points on an edge that pointInTriangle accepts
+        //because of rounding are never rejected by the box test
+        double padding = 1e-9 * (std::max(std::max(std::abs(box.minX), std::abs(box.maxX)),
+                                           std::max(std::abs(box.minY), std::abs(box.maxY))) + 1.0);
+        box.minX -= padding;
+        box.minY -= padding;
+        box.maxX += padding;
+        box.maxY += padding;
+    }
+    triangleTree = BoundingVolumeHierarchy(triangleBoxes);
 }
 
 void FVCOMStructure::loadStructureData(const std::string directory)
 {
-    unsigned int timeDim = 0;
+    auto phaseStart = std::chrono::steady_clock::now();
+
     std::vector<std::string> filenames = traverseDataFiles(directory);
 
-    //Set start times and time dimensions from files
+    //Read the time axis of each file once and keep it with the file while the files are sorted
+    std::vector<std::pair<ModelFile, std::vector<float>>> fileTimes;
     for(auto &filename : filenames)
     {
-        netCDF::NcFile dataFile(filename, netCDF::NcFile::read);
-        timeDim += dataFile.getDim("time").getSize();
-        
-        std::vector<float> tempTimes;
-        tempTimes.resize(dataFile.getDim("time").getSize());
-        netCDF::NcVar timeVar = dataFile.getVar("time");
-        timeVar.getVar(tempTimes.data());
+        netCDF::NcFile& dataFile = filePool->getFile(filename);
+
+        std::vector<float> tempTimes(dataFile.getDim("time").getSize());
+        dataFile.getVar("time").getVar(tempTimes.data());
+
         ModelFile modelFile;
         modelFile.filename = filename;
         modelFile.startTime = tempTimes[0];
-        modelFile.timeDim = dataFile.getDim("time").getSize();
-        modelFiles.push_back(modelFile);
+        modelFile.timeDim = tempTimes.size();
+        fileTimes.push_back(std::make_pair(modelFile, std::move(tempTimes)));
     }
-    
-    //sort filenames based on start ties
-    std::sort(modelFiles.begin(), modelFiles.end());
+
+    //sort files based on start times
+    std::sort(fileTimes.begin(), fileTimes.end(),
+              [](const std::pair<ModelFile, std::vector<float>>& a, const std::pair<ModelFile, std::vector<float>>& b) { return a.first < b.first; });
 
     //load time variables into one vector
-    times.resize(timeDim);
-    unsigned int currentIndex = 0;
-    for(auto &modelFile : modelFiles)
+    for(auto &fileTime : fileTimes)
     {
-        netCDF::NcFile dataFile(modelFile.filename, netCDF::NcFile::read);
-        netCDF::NcVar timeVar = dataFile.getVar("time");
-
         //Set the start time index for this file
-        modelFile.startTimeIndex = currentIndex;
+        fileTime.first.startTimeIndex = times.size();
+        times.insert(times.end(), fileTime.second.begin(), fileTime.second.end());
+        modelFiles.push_back(fileTime.first);
+    }
 
-        //Load times from this file
-        timeVar.getVar(times.data() + currentIndex);
+    loadTimes.readTimes = secondsSince(phaseStart);
+    phaseStart = std::chrono::steady_clock::now();
 
-        //move current index for next files
-        currentIndex += dataFile.getDim("time").getSize();
-    }
-    netCDF::NcFile dataFile(modelFiles[0].filename, netCDF::NcFile::read);
+    netCDF::NcFile& dataFile = filePool->getFile(modelFiles[0].filename);
 
     //Get dimensions of structure elements
     unsigned int nodeDim = dataFile.getDim("node").getSize();
@@ -82,38 +173,20 @@ void FVCOMStructure::loadStructureData(const std::string directory)
     netCDF::NcVar nvVar = dataFile.getVar("nv");
     netCDF::NcVar hVar = dataFile.getVar("h");
     netCDF::NcVar siglayVar = dataFile.getVar("siglay");
-    netCDF::NcVar centerSiglayVar = dataFile.getVar("siglay_center");
 
     //Load in as floats as that is what they are in the files
     //but they will be converted to doubles to maintain precision during calculations
-    std::vector<float> nodeX;
-    std::vector<float> nodeY;
-    std::vector<float> nodeH;
-
-    std::vector<float> triangleX;
-    std::vector<float> triangleY;
-
-    nodeX.resize(nodeDim);
-    nodeY.resize(nodeDim);
-    triangleX.resize(neleDim);
-    triangleY.resize(neleDim);
-    nodeH.resize(nodeDim);
+    std::vector<float> nodeX(nodeDim);
+    std::vector<float> nodeY(nodeDim);
+    std::vector<float> nodeH(nodeDim);
 
-    //Resize siglay 2d vectors
-    nodeSiglay.resize(nodeDim);
-
-    for(unsigned int i = 0; i < nodeSiglay.size(); i++)
-    {
-        nodeSiglay[i].resize(siglayDim);
-    }
+    std::vector<float> triangleX(neleDim);
+    std::vector<float> triangleY(neleDim);
 
-    //resize for multidimensional array
-    triangleToNodes.resize(neleDim);
-    
-    for(unsigned int i = 0; i < neleDim; i++)
-    {
-        triangleToNodes[i].resize(3);
-    }
+    //nv is stored as [3][nele] and siglay as [siglay][node], each is read in one request
+    //and transposed to one entry per triangle or node
+    std::vector<int> nv(3 * (size_t)neleDim);
+    std::vector<float> siglay(siglayDim * (size_t)nodeDim);
 
     //Assign all arrays for the structure variables
     xVar.getVar(nodeX.data());
@@ -121,52 +194,48 @@ void FVCOMStructure::loadStructureData(const std::string directory)
     xcVar.getVar(triangleX.data());
     ycVar.getVar(triangleY.data());
     hVar.getVar(nodeH.data());
-
-    //load nvVar into a multidimensional vector
-    for(unsigned int i = 0; i < neleDim; i++)
-    {
-        std::vector<size_t> start = {0, i};
-        std::vector<size_t> count = {3, 1};
-        nvVar.getVar(start, count, triangleToNodes[i].data());
-    }
-
-    //load node siglay into a multidimensional vector
-    for(unsigned int i = 0; i < nodeSiglay.size(); i++)
-    {
-        std::vector<size_t> start = {0, i};
-        std::vector<size_t> count = {siglayDim, 1};
-        siglayVar.getVar(start, count, nodeSiglay[i].data());
-    }
+    nvVar.getVar(nv.data());
+    siglayVar.getVar(siglay.data());
 
     //Convert to use point struct
     nodes.resize(nodeDim);
-    triangles.resize(neleDim);
+    nodeSiglay.resize(nodeDim);
     for(unsigned int i = 0; i < nodeDim; i++)
     {
         nodes[i].x = nodeX[i];
         nodes[i].y = nodeY[i];
         nodes[i].z = nodeH[i];
+
+        nodeSiglay[i].resize(siglayDim);
+        for(unsigned int j = 0; j < siglayDim; j++)
+        {
+            nodeSiglay[i][j] = siglay[(size_t)j * nodeDim + i];
+        }
     }
 
+    triangles.resize(neleDim);
+    triangleToNodes.resize(neleDim);
     for(unsigned int i = 0; i < neleDim; i++)
     {
         triangles[i].x = triangleX[i];
         triangles[i].y = triangleY[i];
         triangles[i].z = std::numeric_limits<double>::quiet_NaN();
         //Height data is not loaded for triangles so we set it to NaN.
-    }
-
 
-    //The nv variable from the netCDF indexes starting at 1
-    //Convert this to 0 by subtracting 1 from every value
-    for(unsigned int i = 0; i < neleDim; i++)
-    {
+        //The nv variable from the netCDF indexes starting at 1
+        //Convert this to 0 by subtracting 1 from every value
+        triangleToNodes[i].resize(3);
         for(unsigned int j = 0; j < 3; j++)
         {
-            triangleToNodes[i][j]--;
+            triangleToNodes[i][j] = nv[(size_t)j * neleDim + i] - 1;
         }
     }
 
+    loadFilePermutation(dataFile);
+
+    loadTimes.readMesh = secondsSince(phaseStart);
+    phaseStart = std::chrono::steady_clock::now();
+
     //Pre Processes model to get node to triangle conversion
     nodeToTriangles.resize(nodeDim);
 
@@ -181,6 +250,71 @@ void FVCOMStructure::loadStructureData(const std::string directory)
         }
     }
 
+    loadTimes.buildAdjacency = secondsSince(phaseStart);
+}
+
+/**
+ * Inverts a permutation read from a model file.
+ * @param original The original index of each element in the file
+ * @return The file index of each element by original index.
+ */
+static std::vector<unsigned int> invertPermutation(const std::vector<int>& original)
+{
+    std::vector<unsigned int> fileIndices(original.size(), original.size());
+    for(unsigned int i = 0; i < original.size(); i++)
+    {
+        if(original[i] < 0 || original[i] >= (int)original.size() || fileIndices[original[i]] != original.size())
+        {
+            throw std::runtime_error("Model file reordering is not a permutation");
+        }
+        fileIndices[original[i]] = i;
+    }
+    return fileIndices;
+}
+
+void FVCOMStructure::loadFilePermutation(netCDF::NcFile& dataFile)
+{
+    netCDF::NcVar originalNodeVar = dataFile.getVar("original_node");
+    netCDF::NcVar originalNeleVar = dataFile.getVar("original_nele");
+
+    //Files that were not reordered use the original numbering
+    if(originalNodeVar.isNull() || originalNeleVar.isNull())
+    {
+        nodeFileIndices.clear();
+        triangleFileIndices.clear();
+        return;
+    }
+
+    std::vector<int> originalNode(nodes.size());
+    std::vector<int> originalNele(triangles.size());
+    originalNodeVar.getVar(originalNode.data());
+    originalNeleVar.getVar(originalNele.data());
+
+    nodeFileIndices = invertPermutation(originalNode);
+    triangleFileIndices = invertPermutation(originalNele);
+
+    //Everything was loaded in file order, move it back to the original order
+    std::vector<Point> fileNodes = nodes;
+    std::vector<std::vector<float>> fileNodeSiglay = nodeSiglay;
+    for(unsigned int i = 0; i < fileNodes.size(); i++)
+    {
+        nodes[originalNode[i]] = fileNodes[i];
+        nodeSiglay[originalNode[i]] = fileNodeSiglay[i];
+    }
+
+    std::vector<Point> fileTriangles = triangles;
+    std::vector<std::vector<int>> fileTriangleToNodes = triangleToNodes;
+    for(unsigned int i = 0; i < fileTriangles.size(); i++)
+    {
+        triangles[originalNele[i]] = fileTriangles[i];
+
+        //nv holds file node indices as well
+        std::vector<int>& triangleNodes = triangleToNodes[originalNele[i]];
+        for(unsigned int j = 0; j < triangleNodes.size(); j++)
+        {
+            triangleNodes[j] = originalNode[fileTriangleToNodes[i][j]];
+        }
+    }
 }
 
 void FVCOMStructure::splitIntoChunks()
@@ -194,6 +328,8 @@ void FVCOMStructure::splitIntoChunks()
 
     nodesInChunk.resize(xDimChunks * yDimChunks);
     trianglesInChunk.resize(xDimChunks * yDimChunks);
+    nodeIndexInChunk.resize(nodes.size());
+    triangleIndexInChunk.resize(triangles.size());
     for(unsigned int i = 0; i < nodes.size(); i++)
     {
         FVCOMStructure::ChunkInfo chunk = getChunkForNode(i, 0, 0);
@@ -202,6 +338,7 @@ void FVCOMStructure::splitIntoChunks()
         //node locations do not change with depth or time.
         int chunkId = chunk.yChunk + (chunk.xChunk * yDimChunks);
 
+        nodeIndexInChunk[i] = nodesInChunk[chunkId].size();
         nodesInChunk[chunkId].push_back(i);
     }
 
@@ -213,10 +350,383 @@ void FVCOMStructure::splitIntoChunks()
         //node locations do not change with depth or time.
         int chunkId = chunk.yChunk + (chunk.xChunk * yDimChunks);
 
+        triangleIndexInChunk[i] = trianglesInChunk[chunkId].size();
         trianglesInChunk[chunkId].push_back(i);
     }
 }
 
+/**
+ * Identifies structure cache files and the layout they were written with
+ */
+static const char STRUCTURE_CACHE_MAGIC[8] = {'O', 'M', 'I', 'F', 'V', 'S', 'C', '\0'};
+static const uint64_t STRUCTURE_CACHE_VERSION = 1;
+
+/**
+ * Writes the values and arrays of a structure cache file. Each one is padded to a multiple of 8 bytes.
+ * The reader copies them from a memory map into the vectors of the structure.
+ */
+class StructureCacheWriter
+{
+public:
+    StructureCacheWriter(std::ostream& out) :
+        out(out),
+        position(0)
+    {}
+
+    template<typename T>
+    void write(const T& value)
+    {
+        writeBytes(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void writeArray(const std::vector<T>& values)
+    {
+        write<uint64_t>(values.size());
+        writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void writeString(const std::string& value)
+    {
+        write<uint64_t>(value.size());
+        writeBytes(value.data(), value.size());
+    }
+
+    /**
+     * Writes a list of lists as the offset of each list followed by all their values.
+     */
+    template<typename T>
+    void writeLists(const std::vector<std::vector<T>>& lists)
+    {
+        std::vector<uint64_t> offsets(1, 0);
+        std::vector<T> values;
+        for(const std::vector<T>& list : lists)
+        {
+            values.insert(values.end(), list.begin(), list.end());
+            offsets.push_back(values.size());
+        }
+        writeArray(offsets);
+        writeArray(values);
+    }
+
+private:
+    void writeBytes(const void* data, size_t size)
+    {
+        static const char padding[8] = {};
+
+        out.write(static_cast<const char*>(data), size);
+        out.write(padding, (8 - size % 8) % 8);
+        position += (size + 7) / 8 * 8;
+    }
+
+    std::ostream& out;
+    size_t position;
+};
+
+/**
+ * Reads the values written by StructureCacheWriter from a mapped file, checking that each one fits in the file.
+ */
+class StructureCacheReader
+{
+public:
+    StructureCacheReader(const MappedFile& file) :
+        position(file.data()),
+        end(file.data() + file.size())
+    {}
+
+    template<typename T>
+    T read()
+    {
+        T value;
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void readArray(std::vector<T>& values)
+    {
+        uint64_t count = read<uint64_t>();
+        if(count > (uint64_t)(end - position) / sizeof(T))
+        {
+            throw std::runtime_error("Structure cache file is truncated");
+        }
+        values.resize(count);
+        readBytes(values.data(), count * sizeof(T));
+    }
+
+    std::string readString()
+    {
+        std::vector<char> characters;
+        readArray(characters);
+        return std::string(characters.begin(), characters.end());
+    }
+
+    template<typename T>
+    void readLists(std::vector<std::vector<T>>& lists)
+    {
+        std::vector<uint64_t> offsets;
+        std::vector<T> values;
+        readArray(offsets);
+        readArray(values);
+        if(offsets.empty() || offsets.front() != 0 || offsets.back() != values.size())
+        {
+            throw std::runtime_error("Structure cache file has invalid list offsets");
+        }
+
+        lists.resize(offsets.size() - 1);
+        for(size_t i = 0; i < lists.size(); i++)
+        {
+            if(offsets[i] > offsets[i + 1])
+            {
+                throw std::runtime_error("Structure cache file has invalid list offsets");
+            }
+            lists[i].assign(values.begin() + offsets[i], values.begin() + offsets[i + 1]);
+        }
+    }
+
+private:
+    void readBytes(void* data, size_t size)
+    {
+        size_t paddedSize = (size + 7) / 8 * 8;
+        if(paddedSize > (size_t)(end - position))
+        {
+            throw std::runtime_error("Structure cache file is truncated");
+        }
+        if(size > 0)
+        {
+            std::memcpy(data, position, size);
+        }
+        position += paddedSize;
+    }
+
+    const char* position;
+    const char* end;
+};
+
+std::string FVCOMStructure::getStructureCacheKey(const std::string filename) const
+{
+    std::vector<std::string> filenames = traverseDataFiles(filename);
+    for(std::string& file : filenames)
+    {
+        file = boost::filesystem::absolute(file).string();
+    }
+    std::sort(filenames.begin(), filenames.end());
+
+    std::ostringstream key;
+    key << "chunks " << xChunkSize << " " << yChunkSize << " " << siglayChunkSize << " " << timeChunkSize << "\n";
+    for(const std::string& file : filenames)
+    {
+        key << file << " " << boost::filesystem::file_size(file) << " " << boost::filesystem::last_write_time(file) << "\n";
+    }
+
+    return key.str();
+}
+
+bool FVCOMStructure::readStructureCache(const std::string cacheFile, const std::string& key, const std::string filename)
+{
+    if(!boost::filesystem::exists(cacheFile))
+    {
+        return false;
+    }
+
+    try
+    {
+        MappedFile file(cacheFile);
+        StructureCacheReader reader(file);
+
+        //The magic is written as one padded 8 byte value, so it is read back the same way
+        std::array<char, 8> magic = reader.read<std::array<char, 8>>();
+        if(!std::equal(magic.begin(), magic.end(), STRUCTURE_CACHE_MAGIC) ||
+           reader.read<uint64_t>() != STRUCTURE_CACHE_VERSION ||
+           reader.readString() != key)
+        {
+            return false;
+        }
+
+        modelFiles.resize(reader.read<uint64_t>());
+        for(ModelFile& modelFile : modelFiles)
+        {
+            modelFile.filename = reader.readString();
+            modelFile.startTime = reader.read<float>();
+            modelFile.startTimeIndex = reader.read<uint32_t>();
+            modelFile.timeDim = reader.read<uint32_t>();
+        }
+
+        siglayDim = reader.read<uint32_t>();
+        reader.readArray(times);
+        reader.readArray(nodeFileIndices);
+        reader.readArray(triangleFileIndices);
+
+        std::vector<double> nodeValues;
+        std::vector<double> triangleValues;
+        std::vector<float> siglayValues;
+        std::vector<int> triangleNodeValues;
+        reader.readArray(nodeValues);
+        reader.readArray(triangleValues);
+        reader.readArray(siglayValues);
+        reader.readArray(triangleNodeValues);
+
+        unsigned int nodeDim = nodeValues.size() / 3;
+        unsigned int neleDim = triangleValues.size() / 3;
+        if(nodeValues.size() != 3 * nodeDim || triangleValues.size() != 3 * neleDim ||
+           siglayValues.size() != (size_t)nodeDim * siglayDim || triangleNodeValues.size() != 3 * neleDim)
+        {
+            throw std::runtime_error("Structure cache file has inconsistent sizes");
+        }
+
+        nodes.resize(nodeDim);
+        nodeSiglay.resize(nodeDim);
+        for(unsigned int i = 0; i < nodeDim; i++)
+        {
+            nodes[i] = Point(nodeValues[3 * i], nodeValues[3 * i + 1], nodeValues[3 * i + 2]);
+            nodeSiglay[i].assign(siglayValues.begin() + (size_t)i * siglayDim, siglayValues.begin() + (size_t)(i + 1) * siglayDim);
+        }
+
+        triangles.resize(neleDim);
+        triangleToNodes.resize(neleDim);
+        for(unsigned int i = 0; i < neleDim; i++)
+        {
+            triangles[i] = Point(triangleValues[3 * i], triangleValues[3 * i + 1], triangleValues[3 * i + 2]);
+            triangleToNodes[i].assign(triangleNodeValues.begin() + 3 * i, triangleNodeValues.begin() + 3 * (i + 1));
+        }
+
+        reader.readLists(nodeToTriangles);
+        reader.readLists(nodesInChunk);
+        reader.readLists(trianglesInChunk);
+        reader.readArray(nodeIndexInChunk);
+        reader.readArray(triangleIndexInChunk);
+
+        minX = reader.read<double>();
+        minY = reader.read<double>();
+        maxX = reader.read<double>();
+        maxY = reader.read<double>();
+        siglayDimChunks = reader.read<uint32_t>();
+        timeDimChunks = reader.read<uint32_t>();
+        yDimChunks = reader.read<uint32_t>();
+        xDimChunks = reader.read<uint32_t>();
+
+        if(nodeToTriangles.size() != nodeDim || nodeIndexInChunk.size() != nodeDim || triangleIndexInChunk.size() != neleDim ||
+           nodesInChunk.size() != (size_t)xDimChunks * yDimChunks || trianglesInChunk.size() != nodesInChunk.size())
+        {
+            throw std::runtime_error("Structure cache file has inconsistent sizes");
+        }
+    }
+    catch(const std::runtime_error& e)
+    {
+        //A damaged cache is treated like a missing one and replaced
+        clearStructureData();
+        return false;
+    }
+
+    //The cache stores absolute paths, use the names the model was opened with like loadStructureData does
+    std::map<std::string, std::string> givenNames;
+    for(const std::string& file : traverseDataFiles(filename))
+    {
+        givenNames[boost::filesystem::absolute(file).string()] = file;
+    }
+    for(ModelFile& modelFile : modelFiles)
+    {
+        modelFile.filename = givenNames[modelFile.filename];
+    }
+
+    return true;
+}
+
+void FVCOMStructure::writeStructureCache(const std::string cacheFile, const std::string& key) const
+{
+    //Write to a temporary file and rename it so other processes never read a partly written cache
+    std::string temporaryFile = cacheFile + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(temporaryFile, std::ios::binary | std::ios::trunc);
+    if(!out)
+    {
+        //The cache only speeds up later runs, so failing to write it does not stop this one
+        return;
+    }
+
+    StructureCacheWriter writer(out);
+    writer.write(STRUCTURE_CACHE_MAGIC);
+    writer.write<uint64_t>(STRUCTURE_CACHE_VERSION);
+    writer.writeString(key);
+
+    writer.write<uint64_t>(modelFiles.size());
+    for(const ModelFile& modelFile : modelFiles)
+    {
+        writer.writeString(boost::filesystem::absolute(modelFile.filename).string());
+        writer.write<float>(modelFile.startTime);
+        writer.write<uint32_t>(modelFile.startTimeIndex);
+        writer.write<uint32_t>(modelFile.timeDim);
+    }
+
+    writer.write<uint32_t>(siglayDim);
+    writer.writeArray(times);
+    writer.writeArray(nodeFileIndices);
+    writer.writeArray(triangleFileIndices);
+
+    std::vector<double> nodeValues;
+    std::vector<float> siglayValues;
+    for(unsigned int i = 0; i < nodes.size(); i++)
+    {
+        nodeValues.insert(nodeValues.end(), {nodes[i].x, nodes[i].y, nodes[i].z});
+        siglayValues.insert(siglayValues.end(), nodeSiglay[i].begin(), nodeSiglay[i].end());
+    }
+
+    std::vector<double> triangleValues;
+    std::vector<int> triangleNodeValues;
+    for(unsigned int i = 0; i < triangles.size(); i++)
+    {
+        triangleValues.insert(triangleValues.end(), {triangles[i].x, triangles[i].y, triangles[i].z});
+        triangleNodeValues.insert(triangleNodeValues.end(), triangleToNodes[i].begin(), triangleToNodes[i].end());
+    }
+
+    writer.writeArray(nodeValues);
+    writer.writeArray(triangleValues);
+    writer.writeArray(siglayValues);
+    writer.writeArray(triangleNodeValues);
+
+    writer.writeLists(nodeToTriangles);
+    writer.writeLists(nodesInChunk);
+    writer.writeLists(trianglesInChunk);
+    writer.writeArray(nodeIndexInChunk);
+    writer.writeArray(triangleIndexInChunk);
+
+    writer.write<double>(minX);
+    writer.write<double>(minY);
+    writer.write<double>(maxX);
+    writer.write<double>(maxY);
+    writer.write<uint32_t>(siglayDimChunks);
+    writer.write<uint32_t>(timeDimChunks);
+    writer.write<uint32_t>(yDimChunks);
+    writer.write<uint32_t>(xDimChunks);
+
+    out.close();
+    if(!out || std::rename(temporaryFile.c_str(), cacheFile.c_str()) != 0)
+    {
+        std::remove(temporaryFile.c_str());
+    }
+}
+
+void FVCOMStructure::clearStructureData()
+{
+    modelFiles.clear();
+    nodeFileIndices.clear();
+    triangleFileIndices.clear();
+    nodes.clear();
+    triangles.clear();
+    nodeSiglay.clear();
+    times.clear();
+    triangleToNodes.clear();
+    nodeToTriangles.clear();
+    nodesInChunk.clear();
+    trianglesInChunk.clear();
+    nodeIndexInChunk.clear();
+    triangleIndexInChunk.clear();
+
+    minX = std::numeric_limits<double>::max();
+    minY = std::numeric_limits<double>::max();
+    maxX = -std::numeric_limits<double>::max();
+    maxY = -std::numeric_limits<double>::max();
+}
+
 void FVCOMStructure::getModelExtent()
 {
     for(unsigned int i = 0; i < nodes.size(); i++)
@@ -268,51 +778,49 @@ bool FVCOMStructure::pointInTriangle(Point testPoint, int triangle) const
     return alpha >= 0 && beta >= 0 && gamma >= 0;
 }
 
-int FVCOMStructure::getContainingTriangle(Point testPoint, int closestNode)
+int FVCOMStructure::getContainingTriangle(Point testPoint, int closestNode) const
 {
-    if(pointInTriangle(testPoint, lastContainingTriangle))
-    {
-        return lastContainingTriangle;
-    }
-
     //Search all triangles that are connected to the closest node
     for(unsigned int i = 0; i < nodeToTriangles[closestNode].size(); i++)
     {
         //return the triangle for which the point is inside
         if(pointInTriangle(testPoint, nodeToTriangles[closestNode][i]))
         {
-            lastContainingTriangle = nodeToTriangles[closestNode][i];
             return nodeToTriangles[closestNode][i];
         }
     }
 
-    //if the point is not inside any of those triangles search all the triangles
-    for(unsigned int i = 0; i < triangles.size(); i++)
+    //if the point is not inside any of those triangles search every triangle whose bounding box contains the point
+    int triangle = triangleTree.findLowest(testPoint.x, testPoint.y,
+                                           [this, &testPoint](int i) { return pointInTriangle(testPoint, i); });
+    if(triangle != -1)
     {
-        if(pointInTriangle(testPoint, i))
-        {
-            lastContainingTriangle = i;
-            return i;
-        }
+        return triangle;
     }
 
-
     throw std::out_of_range("FVCOM request outside of model extent");
 }
 
-int FVCOMStructure::getContainingTriangle(Point testPoint)
+int FVCOMStructure::getContainingTriangle(Point testPoint) const
 {
-    if(pointInTriangle(testPoint, lastContainingTriangle))
-    {
-        return lastContainingTriangle;
-    }
-
     //Get the closest node to start the search for the containing triangle
     int closestNode = getClosestNode(testPoint);
 
     return getContainingTriangle(testPoint, closestNode);
 }
 
+int FVCOMStructure::getContainingTriangle(Point testPoint, QueryContext& context) const
+{
+    if(context.lastCell >= 0 && context.lastCell < (int)triangles.size() &&
+       pointInTriangle(testPoint, context.lastCell))
+    {
+        return context.lastCell;
+    }
+
+    context.lastCell = getContainingTriangle(testPoint);
+    return context.lastCell;
+}
+
 const std::vector<int>& FVCOMStructure::getNodesInTriangle(int triangle) const
 {
     return triangleToNodes[triangle];
@@ -323,22 +831,44 @@ const std::vector<FVCOMStructure::ModelFile> FVCOMStructure::getModelFiles() con
     return modelFiles;
 }
 
-int FVCOMStructure::getClosestNode(Point testPoint) const
+const bool FVCOMStructure::isReordered() const
 {
-    //Checks distance between testPoint and every node, this is slow and will probably need to be improved
-    double closestDistance = std::numeric_limits<double>::max();
-    int node = -1;
-    for(unsigned int i = 0; i < nodes.size(); i++)
-    {
+    return !nodeFileIndices.empty();
+}
 
-        if(distanceSquared(testPoint, nodes[i]) < closestDistance)
-        {
-            closestDistance = distanceSquared(testPoint, nodes[i]);
-            node = i;
-        }
-    }
+const unsigned int FVCOMStructure::getNodeFileIndex(unsigned int node) const
+{
+    return nodeFileIndices.empty() ? node : nodeFileIndices[node];
+}
+
+const unsigned int FVCOMStructure::getTriangleFileIndex(unsigned int triangle) const
+{
+    return triangleFileIndices.empty() ? triangle : triangleFileIndices[triangle];
+}
+
+const FVCOMStructure::LoadTimes& FVCOMStructure::getLoadTimes() const
+{
+    return loadTimes;
+}
+
+NetCDFFilePool& FVCOMStructure::getFilePool() const
+{
+    return *filePool;
+}
 
-    return node;
+StorageBackend& FVCOMStructure::getStorageBackend() const
+{
+    return *storageBackend;
+}
+
+void FVCOMStructure::setStorageBackend(std::shared_ptr<StorageBackend> backend)
+{
+    storageBackend = backend;
+}
+
+int FVCOMStructure::getClosestNode(Point testPoint) const
+{
+    return nodeTree.nearest(testPoint);
 }
 
 
@@ -361,6 +891,20 @@ int FVCOMStructure::getClosestTime(double time) const
 
 }
 
+int FVCOMStructure::getPreviousTimeIndex(double time, QueryContext& context) const
+{
+    //The hint is only used if time is strictly between two times, otherwise search so exact
+    //matches are handled the same way as without a hint
+    int hint = context.lastTimeIndex;
+    if(hint >= 0 && hint + 1 < (int)times.size() && times[hint] < time && time < times[hint + 1])
+    {
+        return hint;
+    }
+
+    context.lastTimeIndex = getPreviousTimeIndex(time);
+    return context.lastTimeIndex;
+}
+
 int FVCOMStructure::getPreviousTimeIndex(double time) const
 {
     auto lower = std::lower_bound(times.begin(), times.end(), time);
@@ -458,25 +1002,7 @@ FVCOMStructure::ChunkInfo FVCOMStructure::getChunkForNode(int node, int siglay,
         chunk.yChunk = yDimChunks - 1;
     }
 
-    chunk.id = chunk.timeChunk +
-           (chunk.siglayChunk * timeDimChunks) +
-           (chunk.yChunk * timeDimChunks * siglayDimChunks) +
-           (chunk.xChunk * timeDimChunks * siglayDimChunks * yDimChunks);
-
-
-    chunk.xStart = chunk.xChunk * xChunkSize - minX;
-    chunk.yStart = chunk.yChunk * yChunkSize - minX;
-    chunk.siglayStart = chunk.siglayChunk * siglayChunkSize;
-    chunk.timeStart = chunk.timeChunk * timeChunkSize;
-
-    chunk.xSize = xChunkSize;
-    chunk.ySize = yChunkSize;
-
-    unsigned int timeSize = times.size();
-    chunk.siglaySize = std::min(siglayChunkSize, siglayDim - chunk.siglayStart);
-    chunk.timeSize = std::min(timeChunkSize, timeSize - chunk.timeStart);
-
-    return chunk;
+    return getChunkInfo(chunk.xChunk, chunk.yChunk, chunk.siglayChunk, chunk.timeChunk);
 }
 
 
@@ -513,6 +1039,17 @@ FVCOMStructure::ChunkInfo FVCOMStructure::getChunkForTriangle(int triangle, int
         chunk.yChunk = yDimChunks - 1;
     }
 
+    return getChunkInfo(chunk.xChunk, chunk.yChunk, chunk.siglayChunk, chunk.timeChunk);
+}
+
+FVCOMStructure::ChunkInfo FVCOMStructure::getChunkInfo(unsigned int xChunk, unsigned int yChunk, unsigned int siglayChunk, unsigned int timeChunk) const
+{
+    FVCOMStructure::ChunkInfo chunk;
+    chunk.xChunk = xChunk;
+    chunk.yChunk = yChunk;
+    chunk.siglayChunk = siglayChunk;
+    chunk.timeChunk = timeChunk;
+
     chunk.id = chunk.timeChunk +
            (chunk.siglayChunk * timeDimChunks) +
            (chunk.yChunk * timeDimChunks * siglayDimChunks) +
@@ -533,9 +1070,86 @@ FVCOMStructure::ChunkInfo FVCOMStructure::getChunkForTriangle(int triangle, int
     return chunk;
 }
 
+std::vector<FVCOMStructure::ChunkInfo> FVCOMStructure::getAllChunks() const
+{
+    return getChunksInRegion(minX, minY, maxX, maxY, 0, siglayDim - 1, times.front(), times.back());
+}
+
+unsigned int FVCOMStructure::getNumChunks() const
+{
+    return xDimChunks * yDimChunks * siglayDimChunks * timeDimChunks;
+}
+
+std::string FVCOMStructure::getChunkLayoutKey() const
+{
+    //The chunk boundaries start at the model's minimum x and y, so they are part of the layout
+    std::ostringstream key;
+    key.precision(17);
+    key << "FVCOM\n"
+        << "chunks " << xChunkSize << " " << yChunkSize << " " << siglayChunkSize << " " << timeChunkSize << "\n"
+        << "origin " << minX << " " << minY << "\n"
+        << "nodes " << nodes.size() << " triangles " << triangles.size() << " siglays " << siglayDim << " times " << times.size() << "\n";
+    return key.str();
+}
+
+std::vector<FVCOMStructure::ChunkInfo> FVCOMStructure::getChunksInRegion(double regionMinX, double regionMinY, double regionMaxX, double regionMaxY,
+                                                                         unsigned int siglayStart, unsigned int siglayEnd,
+                                                                         double startTime, double endTime) const
+{
+    std::vector<FVCOMStructure::ChunkInfo> chunks;
+    if(regionMaxX < minX || regionMinX > maxX || regionMaxY < minY || regionMinY > maxY ||
+       endTime < times.front() || startTime > times.back() || siglayStart > siglayEnd)
+    {
+        return chunks;
+    }
+
+    //Clamp the region to the chunk grid, the same way nodes on the max edge are put in the last chunk
+    unsigned int xChunkStart = std::max(0.0, regionMinX - minX) / xChunkSize;
+    unsigned int yChunkStart = std::max(0.0, regionMinY - minY) / yChunkSize;
+    unsigned int xChunkEnd = std::min<unsigned int>((std::min(regionMaxX, maxX) - minX) / xChunkSize, xDimChunks - 1);
+    unsigned int yChunkEnd = std::min<unsigned int>((std::min(regionMaxY, maxY) - minY) / yChunkSize, yDimChunks - 1);
+
+    unsigned int siglayChunkStart = std::min(siglayStart, siglayDim - 1) / siglayChunkSize;
+    unsigned int siglayChunkEnd = std::min(siglayEnd, siglayDim - 1) / siglayChunkSize;
+
+    //Include the time slices on both sides of the range since both are used to interpolate
+    auto startIt = std::upper_bound(times.begin(), times.end(), startTime);
+    auto endIt = std::lower_bound(times.begin(), times.end(), endTime);
+    unsigned int timeIndexStart = startIt == times.begin() ? 0 : std::distance(times.begin(), startIt) - 1;
+    unsigned int timeIndexEnd = endIt == times.end() ? times.size() - 1 : std::distance(times.begin(), endIt);
+
+    for(unsigned int timeChunk = timeIndexStart / timeChunkSize; timeChunk <= timeIndexEnd / timeChunkSize; timeChunk++)
+    {
+        for(unsigned int siglayChunk = siglayChunkStart; siglayChunk <= siglayChunkEnd; siglayChunk++)
+        {
+            for(unsigned int xChunk = xChunkStart; xChunk <= xChunkEnd; xChunk++)
+            {
+                for(unsigned int yChunk = yChunkStart; yChunk <= yChunkEnd; yChunk++)
+                {
+                    unsigned int xyChunk = yChunk + (xChunk * yDimChunks);
+                    if(nodesInChunk[xyChunk].empty() && trianglesInChunk[xyChunk].empty())
+                    {
+                        continue;
+                    }
+
+                    chunks.push_back(getChunkInfo(xChunk, yChunk, siglayChunk, timeChunk));
+                }
+            }
+        }
+    }
+
+    return chunks;
+}
+
 void FVCOMStructure::timeInterpolation(double time, int& time1Index, int& time2Index, double& time1Percent) const
 {
-    time1Index = getPreviousTimeIndex(time);
+    QueryContext context;
+    timeInterpolation(time, time1Index, time2Index, time1Percent, context);
+}
+
+void FVCOMStructure::timeInterpolation(double time, int& time1Index, int& time2Index, double& time1Percent, QueryContext& context) const
+{
+    time1Index = getPreviousTimeIndex(time, context);
     double previousTime = getTime(time1Index);
 
     //Time is exactly on a time division, no interpolation needed.
@@ -553,13 +1167,66 @@ void FVCOMStructure::timeInterpolation(double time, int& time1Index, int& time2I
 }
 
 
-void FVCOMStructure::siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent)
+void FVCOMStructure::siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent) const
 {
     int containingTriangle = getContainingTriangle(interpolatePoint);
     siglayInterpolation(interpolatePoint, siglay1Index, siglay2Index, siglay1Percent, containingTriangle);
 }
 
-void FVCOMStructure::siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent, int containingTriangle)
+void FVCOMStructure::siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent, int containingTriangle) const
+{
+    QueryContext context;
+    siglayInterpolation(interpolatePoint, siglay1Index, siglay2Index, siglay1Percent, containingTriangle, context);
+}
+
+void FVCOMStructure::siglayInterpolation(Point& interpolatePoint, int& siglay1Index, int& siglay2Index, double& siglay1Percent, int containingTriangle, QueryContext& context) const
+{
+    if(!siglayBracketContains(interpolatePoint, containingTriangle, context.lastLayer))
+    {
+        findSiglayBracket(interpolatePoint, containingTriangle, siglay1Index, siglay2Index);
+        context.lastLayer = siglay1Index;
+    }
+    else
+    {
+        siglay1Index = context.lastLayer;
+        siglay2Index = context.lastLayer + 1;
+    }
+
+    if(siglay1Index == siglay2Index) //The point is above the 0th siglay so and there is no data there
+    {
+        siglay1Percent = 1.0;
+    }
+    else
+    {
+        Plane upperPlane = getTriangleSiglayPlane(containingTriangle, siglay1Index);
+        Plane lowerPlane = getTriangleSiglayPlane(containingTriangle, siglay2Index);
+
+        double upperH = (-upperPlane.d - upperPlane.a * interpolatePoint.x - upperPlane.b * interpolatePoint.y) / upperPlane.c;
+        double lowerH = (-lowerPlane.d - lowerPlane.a * interpolatePoint.x - lowerPlane.b * interpolatePoint.y) / lowerPlane.c;
+
+        siglay1Percent = (lowerH - interpolatePoint.z) / (lowerH - upperH);
+    }
+}
+
+bool FVCOMStructure::siglayBracketContains(const Point& interpolatePoint, int containingTriangle, int siglay1Index) const
+{
+    if(siglay1Index < 0 || siglay1Index + 1 >= (int)getNumSiglays())
+    {
+        return false;
+    }
+
+    //The point is strictly between two siglay planes if it is on opposite sides of them.
+    //Points exactly on a plane are left to the full search.
+    Plane upperPlane = getTriangleSiglayPlane(containingTriangle, siglay1Index);
+    Plane lowerPlane = getTriangleSiglayPlane(containingTriangle, siglay1Index + 1);
+
+    double upperDot = upperPlane.a * interpolatePoint.x + upperPlane.b * interpolatePoint.y + upperPlane.c * interpolatePoint.z + upperPlane.d;
+    double lowerDot = lowerPlane.a * interpolatePoint.x + lowerPlane.b * interpolatePoint.y + lowerPlane.c * interpolatePoint.z + lowerPlane.d;
+
+    return (upperDot > 0 && lowerDot < 0) || (upperDot < 0 && lowerDot > 0);
+}
+
+void FVCOMStructure::findSiglayBracket(const Point& interpolatePoint, int containingTriangle, int& siglay1Index, int& siglay2Index) const
 {
     siglay1Index = siglay2Index = -1;
 
@@ -606,24 +1273,9 @@ void FVCOMStructure::siglayInterpolation(Point& interpolatePoint, int& siglay1In
         siglay1Index = getNumSiglays() -1;
         siglay2Index = getNumSiglays() -1;
     }
-
-    if(siglay1Index == siglay2Index) //The point is above the 0th siglay so and there is no data there
-    {
-        siglay1Percent = 1.0;
-    }
-    else
-    {
-        Plane upperPlane = getTriangleSiglayPlane(containingTriangle, siglay1Index);
-        Plane lowerPlane = getTriangleSiglayPlane(containingTriangle, siglay2Index);
-
-        double upperH = (-upperPlane.d - upperPlane.a * interpolatePoint.x - upperPlane.b * interpolatePoint.y) / upperPlane.c;
-        double lowerH = (-lowerPlane.d - lowerPlane.a * interpolatePoint.x - lowerPlane.b * interpolatePoint.y) / lowerPlane.c;
-
-        siglay1Percent = (lowerH - interpolatePoint.z) / (lowerH - upperH);
-    }
 }
 
-double FVCOMStructure::getDepthAtPoint(Point& interpolatePoint, int containingTriangle)
+double FVCOMStructure::getDepthAtPoint(Point& interpolatePoint, int containingTriangle) const
 {
     const std::vector<int>& surroundingNodes = getNodesInTriangle(containingTriangle);
 
@@ -636,27 +1288,32 @@ double FVCOMStructure::getDepthAtPoint(Point& interpolatePoint, int containingTr
     return groundPlane.getHeight(interpolatePoint);
 }
 
-double FVCOMStructure::getDepthAtPoint(Point& interpolatePoint)
+double FVCOMStructure::getDepthAtPoint(Point& interpolatePoint) const
 {
     int containingTriangle = getContainingTriangle(interpolatePoint);
 
-    const std::vector<int>& surroundingNodes = getNodesInTriangle(containingTriangle);
+    return getDepthAtPoint(interpolatePoint, containingTriangle);
+}
 
-    Point p1 = getNodePointWithH(surroundingNodes[0]);
-    Point p2 = getNodePointWithH(surroundingNodes[1]);
-    Point p3 = getNodePointWithH(surroundingNodes[2]);
+double FVCOMStructure::getDepthAtPoint(Point& interpolatePoint, QueryContext& context) const
+{
+    int containingTriangle = getContainingTriangle(interpolatePoint, context);
 
-    Plane groundPlane(p1,p2,p3);
+    return getDepthAtPoint(interpolatePoint, containingTriangle);
+}
 
-    return groundPlane.getHeight(interpolatePoint);
+const bool FVCOMStructure::pointInModel(Point p, double time) const
+{
+    QueryContext context;
+    return pointInModel(p, time, context);
 }
 
-const bool FVCOMStructure::pointInModel(Point p, double time)
+const bool FVCOMStructure::pointInModel(Point p, double time, QueryContext& context) const
 {
     int containingTriangle = 0;
     try
     {
-        containingTriangle = getContainingTriangle(p);
+        containingTriangle = getContainingTriangle(p, context);
     }
     catch(const std::out_of_range& e)
     {
@@ -676,12 +1333,18 @@ const bool FVCOMStructure::timeInModel(double time) const
     return time >= times[0] && time <= times[times.size() - 1];
 }
 
-const bool FVCOMStructure::depthInModel(Point p)
+const bool FVCOMStructure::depthInModel(Point p) const
+{
+    QueryContext context;
+    return depthInModel(p, context);
+}
+
+const bool FVCOMStructure::depthInModel(Point p, QueryContext& context) const
 {
     int containingTriangle = 0;
     try
     {
-        containingTriangle = getContainingTriangle(p);
+        containingTriangle = getContainingTriangle(p, context);
     }
     catch(const std::out_of_range& e)
     {
@@ -715,7 +1378,32 @@ const std::vector<unsigned int>& FVCOMStructure::getTrianglesInChunk(FVCOMStruct
     return trianglesInChunk[chunkId];
 }
 
+const unsigned int FVCOMStructure::getNodeIndexInChunk(unsigned int node) const
+{
+    return nodeIndexInChunk[node];
+}
+
+const unsigned int FVCOMStructure::getTriangleIndexInChunk(unsigned int triangle) const
+{
+    return triangleIndexInChunk[triangle];
+}
+
 const unsigned int FVCOMStructure::getNumSiglays() const
 {
     return siglayDim;
 }
+
+const unsigned int FVCOMStructure::getNumNodes() const
+{
+    return nodes.size();
+}
+
+const unsigned int FVCOMStructure::getNumTriangles() const
+{
+    return triangles.size();
+}
+
+const unsigned int FVCOMStructure::getNumTimes() const
+{
+    return times.size();
+}
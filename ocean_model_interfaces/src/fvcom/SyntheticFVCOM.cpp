@@ -0,0 +1,210 @@
+#include "ocean_model_interfaces/fvcom/SyntheticFVCOM.h"
+#include "ocean_model_interfaces/fvcom/FVCOMChunk.h"
+#include "ocean_model_interfaces/util/NetCDFMutex.h"
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <mutex>
+
+#include <netcdf>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+using namespace ocean_model_interfaces;
+
+/**
+ * @return A value in [-1, 1] that looks random but is always the same for the same node and axis
+ */
+static double jitter(uint64_t node, uint64_t axis)
+{
+    uint64_t h = node * 0x9E3779B97F4A7C15ull ^ (axis << 62);
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return (h >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+/**
+ * @return The files of a synthetic model in time order.
+ */
+static std::vector<SyntheticStorageBackend::File> getFiles(const SyntheticFVCOMParameters& parameters)
+{
+    if(parameters.nodesX < 2 || parameters.nodesY < 2 || parameters.siglays == 0 ||
+       parameters.timeSteps == 0 || parameters.timeStepsPerFile == 0)
+    {
+        throw std::runtime_error("A synthetic FVCOM model needs at least 2 by 2 nodes, one siglay, and one time step in each file");
+    }
+
+    std::vector<SyntheticStorageBackend::File> files;
+    for(unsigned int start = 0; start < parameters.timeSteps; start += parameters.timeStepsPerFile)
+    {
+        char filename[64];
+        std::snprintf(filename, sizeof(filename), "synthetic_fvcom_%05u.nc", (unsigned int)files.size());
+
+        SyntheticStorageBackend::File file;
+        file.filename = filename;
+        file.timeSteps = std::min(parameters.timeStepsPerFile, parameters.timeSteps - start);
+        files.push_back(file);
+    }
+    return files;
+}
+
+std::shared_ptr<SyntheticStorageBackend> ocean_model_interfaces::createSyntheticFVCOMBackend(const SyntheticFVCOMParameters& parameters)
+{
+    size_t numNodes = (size_t)parameters.nodesX * parameters.nodesY;
+    size_t numTriangles = 2 * (size_t)(parameters.nodesX - 1) * (parameters.nodesY - 1);
+
+    //Roughly the range each variable has in a coastal model, in FVCOMChunk::Variable order
+    const float means[FVCOMChunk::NUM_VARIABLES] = {10.0f, 34.0f, 0.5f, 0.0f, 0.0f, 0.0f};
+    const float amplitudes[FVCOMChunk::NUM_VARIABLES] = {3.0f, 0.5f, 0.5f, 0.5f, 0.5f, 0.01f};
+
+    std::vector<SyntheticStorageBackend::Variable> variables;
+    const std::vector<std::string>& names = FVCOMChunk::getVariableNames();
+    for(unsigned int i = 0; i < FVCOMChunk::NUM_VARIABLES; i++)
+    {
+        SyntheticStorageBackend::Variable variable;
+        variable.name = names[i];
+        variable.shape = {parameters.siglays, i < FVCOMChunk::U ? numNodes : numTriangles};
+        variable.mean = means[i];
+        variable.amplitude = amplitudes[i];
+        variables.push_back(variable);
+    }
+
+    return std::make_shared<SyntheticStorageBackend>(getFiles(parameters), variables);
+}
+
+void ocean_model_interfaces::writeSyntheticFVCOM(const std::string& directory, const SyntheticFVCOMParameters& parameters)
+{
+    std::vector<SyntheticStorageBackend::File> files = getFiles(parameters);
+    std::shared_ptr<SyntheticStorageBackend> backend = createSyntheticFVCOMBackend(parameters);
+
+    unsigned int nodesX = parameters.nodesX;
+    unsigned int nodesY = parameters.nodesY;
+    size_t numNodes = (size_t)nodesX * nodesY;
+    size_t numTriangles = 2 * (size_t)(nodesX - 1) * (nodesY - 1);
+    double spacing = parameters.nodeSpacing;
+
+    //Nodes on a grid centered on 0, 0. Interior nodes are moved by up to a quarter of the spacing so the
+    //mesh is irregular, which never folds a triangle over.
+    std::vector<float> x(numNodes);
+    std::vector<float> y(numNodes);
+    std::vector<float> h(numNodes);
+    for(unsigned int j = 0; j < nodesY; j++)
+    {
+        for(unsigned int i = 0; i < nodesX; i++)
+        {
+            size_t n = (size_t)j * nodesX + i;
+            bool interior = i > 0 && i < nodesX - 1 && j > 0 && j < nodesY - 1;
+            double nodeX = (i - (nodesX - 1) / 2.0) * spacing + (interior ? 0.25 * spacing * jitter(n, 0) : 0.0);
+            double nodeY = (j - (nodesY - 1) / 2.0) * spacing + (interior ? 0.25 * spacing * jitter(n, 1) : 0.0);
+            x[n] = nodeX;
+            y[n] = nodeY;
+            h[n] = 100.0 + 50.0 * std::sin(nodeX / (17.0 * spacing)) * std::cos(nodeY / (13.0 * spacing));
+        }
+    }
+
+    //Two counter clockwise triangles in each grid cell. nv holds one based node numbers as [corner][triangle].
+    std::vector<int> nv(3 * numTriangles);
+    std::vector<float> xc(numTriangles);
+    std::vector<float> yc(numTriangles);
+    size_t t = 0;
+    for(unsigned int j = 0; j < nodesY - 1; j++)
+    {
+        for(unsigned int i = 0; i < nodesX - 1; i++)
+        {
+            size_t a = (size_t)j * nodesX + i;
+            size_t b = a + 1;
+            size_t c = a + nodesX;
+            size_t d = c + 1;
+            size_t corners[2][3] = {{a, b, d}, {a, d, c}};
+
+            for(int k = 0; k < 2; k++, t++)
+            {
+                for(int corner = 0; corner < 3; corner++)
+                {
+                    nv[corner * numTriangles + t] = corners[k][corner] + 1;
+                }
+                xc[t] = (x[corners[k][0]] + x[corners[k][1]] + x[corners[k][2]]) / 3.0f;
+                yc[t] = (y[corners[k][0]] + y[corners[k][1]] + y[corners[k][2]]) / 3.0f;
+            }
+        }
+    }
+
+    fs::create_directories(directory);
+
+    std::lock_guard<std::mutex> lock(getNetCDFMutex());
+
+    const std::vector<std::string>& names = FVCOMChunk::getVariableNames();
+    std::vector<float> values;
+    unsigned int startTime = 0;
+    for(const SyntheticStorageBackend::File& modelFile : files)
+    {
+        netCDF::NcFile file((fs::path(directory) / modelFile.filename).string(), netCDF::NcFile::replace);
+
+        netCDF::NcDim nodeDim = file.addDim("node", numNodes);
+        netCDF::NcDim neleDim = file.addDim("nele", numTriangles);
+        netCDF::NcDim siglayDim = file.addDim("siglay", parameters.siglays);
+        netCDF::NcDim timeDim = file.addDim("time", modelFile.timeSteps);
+        netCDF::NcDim threeDim = file.addDim("three", 3);
+
+        std::vector<float> times(modelFile.timeSteps);
+        for(unsigned int i = 0; i < modelFile.timeSteps; i++)
+        {
+            times[i] = (startTime + i) * parameters.timeStep;
+        }
+        file.addVar("time", netCDF::ncFloat, timeDim).putVar(times.data());
+
+        file.addVar("x", netCDF::ncFloat, nodeDim).putVar(x.data());
+        file.addVar("y", netCDF::ncFloat, nodeDim).putVar(y.data());
+        file.addVar("h", netCDF::ncFloat, nodeDim).putVar(h.data());
+        file.addVar("xc", netCDF::ncFloat, neleDim).putVar(xc.data());
+        file.addVar("yc", netCDF::ncFloat, neleDim).putVar(yc.data());
+        file.addVar("nv", netCDF::ncInt, std::vector<netCDF::NcDim>{threeDim, neleDim}).putVar(nv.data());
+
+        //Evenly spaced layers from the surface to the bottom, written one layer at a time
+        netCDF::NcVar siglayVar = file.addVar("siglay", netCDF::ncFloat, std::vector<netCDF::NcDim>{siglayDim, nodeDim});
+        values.assign(numNodes, 0.0f);
+        for(unsigned int k = 0; k < parameters.siglays; k++)
+        {
+            std::fill(values.begin(), values.end(), -(k + 0.5f) / parameters.siglays);
+            std::vector<size_t> start = {k, 0};
+            std::vector<size_t> count = {1, numNodes};
+            siglayVar.putVar(start, count, values.data());
+        }
+
+        for(unsigned int v = 0; v < FVCOMChunk::NUM_VARIABLES; v++)
+        {
+            netCDF::NcDim elementDim = v < FVCOMChunk::U ? nodeDim : neleDim;
+            netCDF::NcVar var = file.addVar(names[v], netCDF::ncFloat, std::vector<netCDF::NcDim>{timeDim, siglayDim, elementDim});
+
+            //One chunk per time step and layer, so data that is not written takes no space
+            std::vector<size_t> chunkSizes = {1, 1, elementDim.getSize()};
+            var.setChunking(netCDF::NcVar::nc_CHUNKED, chunkSizes);
+
+            if(!parameters.writeData)
+            {
+                continue;
+            }
+
+            //Write one time step at a time to bound memory for large meshes
+            std::vector<size_t> count = {1, parameters.siglays, elementDim.getSize()};
+            values.resize(count[1] * count[2]);
+            for(unsigned int i = 0; i < modelFile.timeSteps; i++)
+            {
+                std::vector<size_t> start = {i, 0, 0};
+                backend->read(modelFile.filename, names[v], start, count, values.data());
+                var.putVar(start, count, values.data());
+            }
+        }
+
+        startTime += modelFile.timeSteps;
+    }
+}
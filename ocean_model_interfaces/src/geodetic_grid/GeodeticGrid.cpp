@@ -2,52 +2,53 @@
 #include "ocean_model_interfaces/model_interface/ModelData.h"
 #include "ocean_model_interfaces/util/Point.h"
 #include "ocean_model_interfaces/util/UtilityFunctions.h"
+#include "ocean_model_interfaces/util/WorkStealingScheduler.h"
 
 #include <stdexcept>
+#include <algorithm>
+#include <vector>
 #include <math.h>
 #include  <limits>
 #include <assert.h>
 
 using namespace ocean_model_interfaces;
 
+static size_t chunkMemoryUsage(const std::shared_ptr<const GeodeticGridChunk>& chunk) {
+    return chunk->getMemoryUsage();
+}
+
 GeodeticGrid::GeodeticGrid() {}
 
 GeodeticGrid::GeodeticGrid(GeodeticGridParameters parameters) : structure(GeodeticGridStructure(parameters)),
                                                                 parameters(parameters){
-    chunkCache = LRUCache<unsigned int, GeodeticGridChunk>(parameters.cacheSize);
+    chunkCache = ConcurrentCache<unsigned int, ChunkHandle>(parameters.cacheSize, chunkMemoryUsage);
+    chunkCache.setMemoryLimit(parameters.cacheMemoryLimit);
 }
 
-const ModelData GeodeticGrid::getData(double x, double y, double z, double time)
-{
-    if(positionType == CoordinateType::XY) {
-        Point offsetPointLatLon = localXYToLatLon(origin, Point(x + offsetX, y + offsetY, z + offsetZ));
-        return this->getDataHelper(offsetPointLatLon.x, offsetPointLatLon.y, offsetPointLatLon.z, time + offsetTime);
-
-    } else {
-        assert(positionType == CoordinateType::LATLON);
+GeodeticGrid::~GeodeticGrid() {
+    stopPrefetching();
+}
 
-        double shiftedX = x;
-        double shiftedY = y;
-        if(offsetX != 0.0 || offsetY != 0.0) {
-            Point pointXY = latLonToLocalXY(origin, Point(x,y,z));
+void GeodeticGrid::setCacheMemoryLimit(size_t bytes) {
+    chunkCache.setMemoryLimit(bytes);
+}
 
-            pointXY.x += offsetX;
-            pointXY.y += offsetY;
+size_t GeodeticGrid::getCacheMemoryUsage() const {
+    return chunkCache.memoryUsage();
+}
 
-            Point offsetPointLatLon = localXYToLatLon(origin, pointXY);
-            shiftedX = offsetPointLatLon.x;
-            shiftedY = offsetPointLatLon.y;
-        }
+size_t GeodeticGrid::getPeakCacheMemoryUsage() const {
+    return chunkCache.peakMemoryUsage();
+}
 
-        return this->getDataHelper(shiftedX, shiftedY, z + offsetZ, time + offsetTime);
-    }
+size_t GeodeticGrid::getCachedChunkCount() const {
+    return chunkCache.size();
 }
 
-const ModelData GeodeticGrid::getDataOutOfRange(double x, double y, double z, double time)
+Point GeodeticGrid::toModelCoordinates(double x, double y, double z) const
 {
     if(positionType == CoordinateType::XY) {
-        Point offsetPointLatLon = localXYToLatLon(origin, Point(x + offsetX, y + offsetY, z + offsetZ));
-        return this->getDataOutOfRangeHelper(offsetPointLatLon.x, offsetPointLatLon.y, offsetPointLatLon.z, time + offsetTime);
+        return localXYToLatLon(origin, Point(x + offsetX, y + offsetY, z + offsetZ));
 
     } else {
         assert(positionType == CoordinateType::LATLON);
@@ -65,7 +66,7 @@ const ModelData GeodeticGrid::getDataOutOfRange(double x, double y, double z, do
             shiftedY = offsetPointLatLon.y;
         }
 
-        return this->getDataOutOfRangeHelper(shiftedX, shiftedY, z + offsetZ, time + offsetTime);
+        return Point(shiftedX, shiftedY, z + offsetZ);
     }
 }
 
@@ -78,32 +79,217 @@ const ModelData GeodeticGrid::getDataAtIndex(unsigned int timeIndex, unsigned in
     if(!structure.indexInRange(timeIndex, depthIndex, latIndex, lonIndex)) {
         throw std::runtime_error("Requested model indicies are out of range.");
     }
+    ModelData modelData = getChunk(timeIndex, depthIndex, latIndex, lonIndex)->getData(timeIndex, depthIndex, latIndex, lonIndex);
+
+    modelData.depth = structure.indexWaterColumnDepth(latIndex, lonIndex);
+
+    return modelData;
+}
+
+GeodeticGrid::ChunkHandle GeodeticGrid::getChunk(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex) {
     unsigned int chunkId = structure.getChunkIdFromIndicies(timeIndex, depthIndex, latIndex, lonIndex);
 
-    if(!chunkCache.exists(chunkId)) {
-        if(parameters.startLoad) {
-            parameters.startLoad();
+    //Only the handle is copied while the shard is locked, the chunk is read after the lock is released
+    ChunkHandle chunk;
+    auto pin = [&chunk](ChunkHandle& cached) { chunk = cached; };
+
+    //A prefetch may already be loading this chunk, in which case wait for it instead of loading it again
+    if(!chunkCache.visit(chunkId, pin) && !(prefetchLoader.waitFor(chunkId) && chunkCache.visit(chunkId, pin))) {
+        chunk = loadChunk(timeIndex, depthIndex, latIndex, lonIndex);
+        chunkCache.put(chunkId, chunk);
+    }
+
+    return chunk;
+}
+
+void GeodeticGrid::writeChunkStore(const std::string& filename) {
+    const std::vector<std::string>& variables = GeodeticGridChunk::getVariableNames();
+    ChunkStoreWriter writer(filename, structure.getChunkLayoutKey(), variables, structure.getNumChunks());
+
+    std::vector<std::vector<float>> values(variables.size());
+    std::vector<const float*> valuePointers(variables.size());
+    std::vector<size_t> counts(variables.size());
+    for(const GeodeticGridStructure::ChunkInfo& info : structure.getAllChunks()) {
+        ChunkHandle chunk = readChunkFromModelFiles(info);
+        for(unsigned int i = 0; i < variables.size(); i++) {
+            values[i] = chunk->getValues(variables[i]);
+            valuePointers[i] = values[i].data();
+            counts[i] = values[i].size();
+        }
+        writer.writeChunk(info.id, valuePointers, counts);
+    }
+
+    writer.finish();
+}
+
+void GeodeticGrid::setChunkStore(const std::string& filename) {
+    std::shared_ptr<const ChunkStore> store;
+    if(!filename.empty()) {
+        store = std::make_shared<const ChunkStore>(filename);
+        if(store->getKey() != structure.getChunkLayoutKey() || store->getVariables() != GeodeticGridChunk::getVariableNames()) {
+            throw std::runtime_error("Chunk store " + filename + " was written for a different chunk layout");
         }
+    }
+
+    //Background loads read the store, so none can be running while it is replaced
+    waitForPrefetch();
+    chunkStore = store;
+}
+
+void GeodeticGrid::setStorageBackend(std::shared_ptr<StorageBackend> backend) {
+    //Background loads read through the backend, so none can be running while it is replaced
+    waitForPrefetch();
+    structure.setStorageBackend(backend);
+}
+
+GeodeticGrid::ChunkHandle GeodeticGrid::readChunk(const GeodeticGridStructure::ChunkInfo& info) {
+    if(chunkStore) {
+        return std::make_shared<const GeodeticGridChunk>(info, *chunkStore, parameters.precision);
+    }
+
+    return readChunkFromModelFiles(info);
+}
+
+GeodeticGrid::ChunkHandle GeodeticGrid::readChunkFromModelFiles(const GeodeticGridStructure::ChunkInfo& info) {
+    return std::make_shared<const GeodeticGridChunk>(info, structure.getModelFiles(), structure.getStorageBackend(), parameters.precision);
+}
 
-        GeodeticGridStructure::ChunkInfo info = structure.getGridChunkInfo(timeIndex, depthIndex, latIndex, lonIndex);
-        chunkCache.put(info.id, GeodeticGridChunk(info, structure.getModelFiles()));
+GeodeticGrid::ChunkHandle GeodeticGrid::loadChunk(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex) {
+    if(parameters.startLoad) {
+        parameters.startLoad();
+    }
+
+    ChunkHandle chunk = readChunk(structure.getGridChunkInfo(timeIndex, depthIndex, latIndex, lonIndex));
+
+    if(parameters.endLoad) {
+        parameters.endLoad();
+    }
 
-        if(parameters.endLoad) {
-            parameters.endLoad();
+    return chunk;
+}
+
+void GeodeticGrid::getDataBatchHelper(const double* x, const double* y, const double* z, const double* time, size_t n, ModelDataSoA& out) {
+    struct Sample {
+        size_t point;
+        unsigned int chunkId;
+        unsigned int timeIndex;
+        unsigned int depthIndex;
+        unsigned int latIndex;
+        unsigned int lonIndex;
+        double weight;
+        ModelData data;
+    };
+
+    WorkStealingScheduler scheduler(batchThreadCount);
+    size_t blockCount = (n + BATCH_BLOCK_SIZE - 1) / BATCH_BLOCK_SIZE;
+    std::vector<std::vector<Sample>> blockSamples(blockCount);
+
+    //Find the interpolation weights of every point, keeping the samples of each block in request order
+    scheduler.run(blockCount, [&](size_t block, unsigned int worker) {
+        size_t blockEnd = std::min(n, (block + 1) * BATCH_BLOCK_SIZE);
+        for(size_t i = block * BATCH_BLOCK_SIZE; i < blockEnd; i++) {
+            Point point(x[i], y[i], z[i]);
+            if(!structure.timeInModel(time[i]) || !structure.xyInModel(point) || !structure.depthInModel(point)) {
+                out.set(i, getDataOutOfRangeHelper(x[i], y[i], z[i], time[i]), false);
+                continue;
+            }
+
+            GeodeticGridStructure::InterpolationStencil stencil;
+            structure.getInterpolationStencil(point, time[i], stencil);
+
+            ModelData data;
+            data.u = 0;
+            data.v = 0;
+            data.w = 0;
+            data.salt = 0;
+            data.temp = 0;
+            data.dye = 0;
+            data.depth = stencil.waterColumnDepth;
+            out.set(i, data, true);
+
+            for(unsigned int j = 0; j < stencil.size; j++) {
+                const GeodeticGridStructure::InterpolationStencil::GridPoint& gridPoint = stencil.points[j];
+                Sample sample;
+                sample.point = i;
+                sample.timeIndex = gridPoint.timeIndex;
+                sample.depthIndex = gridPoint.depthIndex;
+                sample.latIndex = gridPoint.latIndex;
+                sample.lonIndex = gridPoint.lonIndex;
+                sample.chunkId = structure.getChunkIdFromIndicies(sample.timeIndex, sample.depthIndex, sample.latIndex, sample.lonIndex);
+                sample.weight = gridPoint.weight;
+                blockSamples[block].push_back(sample);
+            }
+        }
+    });
+
+    //Read the samples grouped by chunk so every chunk is looked up, and loaded if needed, by one worker only once
+    std::vector<Sample*> order;
+    for(auto& samples : blockSamples) {
+        for(auto& sample : samples) {
+            order.push_back(&sample);
         }
     }
+    std::stable_sort(order.begin(), order.end(), [](const Sample* a, const Sample* b) { return a->chunkId < b->chunkId; });
 
-    GeodeticGridChunk& chunk = chunkCache.get(chunkId);
-    ModelData modelData = chunk.getData(timeIndex, depthIndex, latIndex, lonIndex);
-    modelData.depth = structure.indexWaterColumnDepth(latIndex, lonIndex);
+    std::vector<size_t> groupStarts;
+    for(size_t i = 0; i < order.size(); i++) {
+        if(i == 0 || order[i]->chunkId != order[i - 1]->chunkId) {
+            groupStarts.push_back(i);
+        }
+    }
+    groupStarts.push_back(order.size());
+
+    scheduler.run(groupStarts.size() - 1, [&](size_t group, unsigned int worker) {
+        size_t start = groupStarts[group];
+        size_t end = groupStarts[group + 1];
+        //The chunk is pinned for the whole group, so other threads can use the cache while it is read
+        const Sample& first = *order[start];
+        ChunkHandle chunk = getChunk(first.timeIndex, first.depthIndex, first.latIndex, first.lonIndex);
+        for(size_t i = start; i < end; i++) {
+            Sample& sample = *order[i];
+            sample.data = chunk->getData(sample.timeIndex, sample.depthIndex, sample.latIndex, sample.lonIndex);
+        }
+    });
+
+    //Accumulate in the same order as getDataHelper so the results match exactly
+    scheduler.run(blockCount, [&](size_t block, unsigned int worker) {
+        for(const Sample& sample : blockSamples[block]) {
+            size_t i = sample.point;
+            out.u[i] += sample.data.u * sample.weight;
+            out.v[i] += sample.data.v * sample.weight;
+            out.w[i] += sample.data.w * sample.weight;
+            out.salt[i] += sample.data.salt * sample.weight;
+            out.temp[i] += sample.data.temp * sample.weight;
+            out.dye[i] += sample.data.dye * sample.weight;
+        }
+    });
+}
 
-    return modelData;
+void GeodeticGrid::prefetchHelper(double x, double y, double z, double time, double radius, double timeWindow) {
+    Point center(x, y, 0);
+    Point minPoint = localXYToLatLon(center, Point(-radius, -radius, 0));
+    Point maxPoint = localXYToLatLon(center, Point(radius, radius, 0));
+    minPoint.z = z;
+    maxPoint.z = z;
+
+    std::vector<GeodeticGridStructure::ChunkInfo> chunks = structure.getChunksInRegion(minPoint, maxPoint, time, time + timeWindow);
+    for(const GeodeticGridStructure::ChunkInfo& info : chunks) {
+        if(chunkCache.exists(info.id)) {
+            continue;
+        }
+
+        prefetchLoader.enqueue(info.id, [this, info]() {
+            if(!chunkCache.exists(info.id)) {
+                chunkCache.put(info.id, readChunk(info));
+            }
+        });
+    }
 }
 
 const ModelData GeodeticGrid::getDataHelper(double x, double y, double z, double time) {
-    if(!structure.timeInModel(time) || !structure.depthInModel(Point(x,y,z)) || !structure.xyInModel(Point(x,y,z))) {
-        throw std::out_of_range("GeodeticGrid request outside of model extent");
-    }
+    //Throws if the point is outside of the model. The stencil is on the stack so queries do not allocate.
+    GeodeticGridStructure::InterpolationStencil stencil;
+    structure.getInterpolationStencil(Point(x,y,z), time, stencil);
 
     ModelData data;
     data.u = 0;
@@ -112,20 +298,20 @@ const ModelData GeodeticGrid::getDataHelper(double x, double y, double z, double
     data.salt = 0;
     data.temp = 0;
     data.dye = 0;
-    data.depth = structure.interpolateWaterColumnDepth(Point(x,y,z));
-    auto weights = structure.getDataInterpolationWeights(Point(x,y,z), time);
-
-    for (auto weight : weights) {
-        ModelData indexData = getDataAtIndex(std::get<0>(weight.first), std::get<1>(weight.first), std::get<2>(weight.first), std::get<3>(weight.first));
-        data.u += indexData.u * weight.second;
-        data.v += indexData.v * weight.second;
-        data.w += indexData.w * weight.second;
-        data.salt += indexData.salt * weight.second;
-        data.temp += indexData.temp * weight.second;
-        data.dye += indexData.dye * weight.second;
-
-       // std::cout << "WEIGHT/INDEX: " << weight.second << " " <<  std::get<0>(weight.first) << " " << std::get<1>(weight.first) << " " << std::get<2>(weight.first) << " " << std::get<3>(weight.first) << std::endl;
-      //  std::cout << "VALUE: " << indexData.dye << std::endl;
+    data.depth = stencil.waterColumnDepth;
+
+    //Neighbouring grid points are usually in the same chunk, so the cache is only searched when the chunk changes
+    ChunkHandle chunk;
+    unsigned int chunkId = 0;
+    for(unsigned int i = 0; i < stencil.size; i++) {
+        const GeodeticGridStructure::InterpolationStencil::GridPoint& gridPoint = stencil.points[i];
+        unsigned int pointChunkId = structure.getChunkIdFromIndicies(gridPoint.timeIndex, gridPoint.depthIndex, gridPoint.latIndex, gridPoint.lonIndex);
+        if(!chunk || pointChunkId != chunkId) {
+            chunk = getChunk(gridPoint.timeIndex, gridPoint.depthIndex, gridPoint.latIndex, gridPoint.lonIndex);
+            chunkId = pointChunkId;
+        }
+
+        chunk->addWeightedValues(chunk->getOffset(gridPoint.timeIndex, gridPoint.depthIndex, gridPoint.latIndex, gridPoint.lonIndex), gridPoint.weight, data);
     }
 
     return data;
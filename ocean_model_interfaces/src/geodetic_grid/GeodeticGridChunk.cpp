@@ -2,18 +2,57 @@
 #include "ocean_model_interfaces/model_interface/ModelData.h"
 
 #include <stdexcept>
+#include <algorithm>
 #include <math.h>
 #include  <limits>
 
 using namespace ocean_model_interfaces;
 
-GeodeticGridChunk::GeodeticGridChunk(GeodeticGridStructure::ChunkInfo info, std::vector<GeodeticGridStructure::ModelFile>& modelFiles) : info(info) {
-    std::vector<std::string> dataFieldStrings = {"u", "v", "w", "salt", "temp", "dye_01"};
+template<typename T>
+static void addWeighted(const T* pointValues, double weight, ModelData& data) {
+    data.u += pointValues[GeodeticGridChunk::U] * weight;
+    data.v += pointValues[GeodeticGridChunk::V] * weight;
+    data.w += pointValues[GeodeticGridChunk::W] * weight;
+    data.salt += pointValues[GeodeticGridChunk::SALT] * weight;
+    data.temp += pointValues[GeodeticGridChunk::TEMP] * weight;
+    data.dye += pointValues[GeodeticGridChunk::DYE] * weight;
+}
+
+template<typename T>
+static void copyValues(const T* pointValues, ModelData& data) {
+    data.u = pointValues[GeodeticGridChunk::U];
+    data.v = pointValues[GeodeticGridChunk::V];
+    data.w = pointValues[GeodeticGridChunk::W];
+    data.temp = pointValues[GeodeticGridChunk::TEMP];
+    data.salt = pointValues[GeodeticGridChunk::SALT];
+    data.dye = pointValues[GeodeticGridChunk::DYE];
+}
 
-    //Initialize the data fields and sizes
-    for(uint i = 0; i < dataFieldStrings.size(); i++) {
-        dataFields[dataFieldStrings[i]] = MultiDimensionalVector<double>({info.timeSize, info.depthSize, info.latSize, info.lonSize});
+GeodeticGridChunk::GeodeticGridChunk(GeodeticGridStructure::ChunkInfo info, std::vector<GeodeticGridStructure::ModelFile>& modelFiles, StorageBackend& backend,
+                                     GeodeticGridParameters::Precision precision) : info(info), precision(precision) {
+    if(precision == GeodeticGridParameters::FLOAT32) {
+        loadValues(modelFiles, backend, floatValues);
+    } else {
+        loadValues(modelFiles, backend, doubleValues);
     }
+}
+
+GeodeticGridChunk::GeodeticGridChunk(GeodeticGridStructure::ChunkInfo info, const ChunkStore& store,
+                                     GeodeticGridParameters::Precision precision) : info(info), precision(precision) {
+    if(precision == GeodeticGridParameters::FLOAT32) {
+        loadValues(store, floatValues);
+    } else {
+        loadValues(store, doubleValues);
+    }
+}
+
+template<typename T>
+void GeodeticGridChunk::loadValues(std::vector<GeodeticGridStructure::ModelFile>& modelFiles, StorageBackend& backend, MultiDimensionalVector<T, 5>& values) {
+    const std::vector<std::string>& dataFieldStrings = getVariableNames();
+    values = MultiDimensionalVector<T, 5>({info.timeSize, info.depthSize, info.latSize, info.lonSize, NUM_VARIABLES});
+
+    //Each variable is read whole in the precision of the chunk and then spread into the interleaved values
+    std::vector<T> fieldValues;
 
     unsigned int currentTimeIndexLoading = info.timeStart;
     unsigned int remainingTimeDimToLoad = info.timeSize;
@@ -21,16 +60,21 @@ GeodeticGridChunk::GeodeticGridChunk(GeodeticGridStructure::ChunkInfo info, std:
         unsigned int adjustedTimeStart = currentTimeIndexLoading - modelFiles[i].startTimeIndex;
 
         if(0 <= adjustedTimeStart && adjustedTimeStart < modelFiles[i].timeDim) {
-            netCDF::NcFile dataFile(modelFiles[i].filename, netCDF::NcFile::read);
 
             unsigned int timeDimToLoad = std::min(remainingTimeDimToLoad, modelFiles[i].timeDim);
             std::vector<size_t> start = {adjustedTimeStart, info.depthStart, info.latStart, info.lonStart};
             std::vector<size_t> count = {timeDimToLoad, info.depthSize, info.latSize, info.lonSize};
 
+            size_t gridPoints = (size_t)timeDimToLoad * info.depthSize * info.latSize * info.lonSize;
+            T* first = values.getDataArrayAtIndex(currentTimeIndexLoading - info.timeStart, 0, 0, 0, 0);
+            fieldValues.resize(gridPoints);
+
             //Load data for each of the data fields
-            for(uint j = 0; j < dataFieldStrings.size(); j++) {
-                netCDF::NcVar var = dataFile.getVar(dataFieldStrings[j]);
-                var.getVar(start, count, dataFields[dataFieldStrings[j]].getDataArrayAtIndex({currentTimeIndexLoading - info.timeStart,0,0,0}));
+            for(uint j = 0; j < NUM_VARIABLES; j++) {
+                backend.read(modelFiles[i].filename, dataFieldStrings[j], start, count, fieldValues.data());
+                for(size_t k = 0; k < gridPoints; k++) {
+                    first[k * NUM_VARIABLES + j] = fieldValues[k];
+                }
             }
 
             currentTimeIndexLoading += timeDimToLoad;
@@ -43,41 +87,109 @@ GeodeticGridChunk::GeodeticGridChunk(GeodeticGridStructure::ChunkInfo info, std:
     }
 }
 
-ModelData GeodeticGridChunk::getData(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex) {
-    ModelData data;
+template<typename T>
+void GeodeticGridChunk::loadValues(const ChunkStore& store, MultiDimensionalVector<T, 5>& values) {
+    values = MultiDimensionalVector<T, 5>({info.timeSize, info.depthSize, info.latSize, info.lonSize, NUM_VARIABLES});
+    T* chunkValuesArray = values.getDataArray();
+    size_t chunkValues = (size_t)info.timeSize * info.depthSize * info.latSize * info.lonSize;
+
+    for(uint i = 0; i < NUM_VARIABLES; i++) {
+        size_t count;
+        const float* storeValues = store.getValues(info.id, i, count);
+        if(count != chunkValues) {
+            throw std::runtime_error("Chunk " + std::to_string(info.id) + " in the chunk store does not match the model");
+        }
+
+        for(size_t k = 0; k < count; k++) {
+            chunkValuesArray[k * NUM_VARIABLES + i] = storeValues[k];
+        }
+    }
+}
+
+const std::vector<std::string>& GeodeticGridChunk::getVariableNames() {
+    static const std::vector<std::string> names = {"u", "v", "w", "salt", "temp", "dye_01"};
+    return names;
+}
 
-    data.u = dataFields["u"].index({timeIndex - info.timeStart, 
-                                    depthIndex - info.depthStart,
-                                    latIndex - info.latStart,
-                                    lonIndex - info.lonStart});
-
-    data.v = dataFields["v"].index({timeIndex - info.timeStart, 
-                                    depthIndex - info.depthStart,
-                                    latIndex - info.latStart,
-                                    lonIndex - info.lonStart});
-
-    data.w = dataFields["w"].index({timeIndex - info.timeStart, 
-                                    depthIndex - info.depthStart,
-                                    latIndex - info.latStart,
-                                    lonIndex - info.lonStart});
-
-    data.temp = dataFields["temp"].index({timeIndex - info.timeStart, 
-                                          depthIndex - info.depthStart,
-                                          latIndex - info.latStart,
-                                          lonIndex - info.lonStart});
-
-    data.salt = dataFields["salt"].index({timeIndex - info.timeStart, 
-                                          depthIndex - info.depthStart,
-                                          latIndex - info.latStart,
-                                          lonIndex - info.lonStart});
-
-    if (dataFields.find("dye_01") != dataFields.end()) {
-        data.dye = dataFields["dye_01"].index({timeIndex - info.timeStart, 
-                                            depthIndex - info.depthStart,
-                                            latIndex - info.latStart,
-                                            lonIndex - info.lonStart});
+std::vector<float> GeodeticGridChunk::getValues(const std::string& variable) const {
+    const std::vector<std::string>& names = getVariableNames();
+    size_t field = std::find(names.begin(), names.end(), variable) - names.begin();
+    if(field == NUM_VARIABLES) {
+        throw std::out_of_range("GeodeticGrid chunks have no variable " + variable);
+    }
+
+    std::vector<float> fieldValues((size_t)info.timeSize * info.depthSize * info.latSize * info.lonSize);
+    if(precision == GeodeticGridParameters::FLOAT32) {
+        const float* chunkValues = floatValues.getDataArray();
+        for(size_t k = 0; k < fieldValues.size(); k++) {
+            fieldValues[k] = chunkValues[k * NUM_VARIABLES + field];
+        }
     } else {
-        data.dye = std::numeric_limits<double>::quiet_NaN();
+        const double* chunkValues = doubleValues.getDataArray();
+        for(size_t k = 0; k < fieldValues.size(); k++) {
+            fieldValues[k] = chunkValues[k * NUM_VARIABLES + field];
+        }
+    }
+    return fieldValues;
+}
+
+size_t GeodeticGridChunk::getOffset(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex) const {
+    //Both precisions have the same layout
+    if(precision == GeodeticGridParameters::FLOAT32) {
+        return floatValues.getOffset(timeIndex - info.timeStart, depthIndex - info.depthStart, latIndex - info.latStart, lonIndex - info.lonStart, 0);
+    }
+    return doubleValues.getOffset(timeIndex - info.timeStart, depthIndex - info.depthStart, latIndex - info.latStart, lonIndex - info.lonStart, 0);
+}
+
+void GeodeticGridChunk::addWeightedValues(size_t offset, double weight, ModelData& data) const {
+    if(precision == GeodeticGridParameters::FLOAT32) {
+        addWeighted(floatValues.getDataArray() + offset, weight, data);
+    } else {
+        addWeighted(doubleValues.getDataArray() + offset, weight, data);
+    }
+}
+
+void GeodeticGridChunk::checkTimeSlice(unsigned int timeIndex, GeodeticGridParameters::Precision slicePrecision) const {
+    if(timeIndex - info.timeStart >= info.timeSize) {
+        throw std::runtime_error("GeodeticGridChunk index out of bounds");
+    }
+    if(slicePrecision != precision) {
+        throw std::runtime_error("GeodeticGridChunk values are not stored in the requested precision");
+    }
+}
+
+template<>
+MultiDimensionalView<const float, 4> GeodeticGridChunk::getTimeSlice<float>(unsigned int timeIndex) const {
+    checkTimeSlice(timeIndex, GeodeticGridParameters::FLOAT32);
+    return floatValues.slice(timeIndex - info.timeStart);
+}
+
+template<>
+MultiDimensionalView<const double, 4> GeodeticGridChunk::getTimeSlice<double>(unsigned int timeIndex) const {
+    checkTimeSlice(timeIndex, GeodeticGridParameters::FLOAT64);
+    return doubleValues.slice(timeIndex - info.timeStart);
+}
+
+GeodeticGridParameters::Precision GeodeticGridChunk::getPrecision() const {
+    return precision;
+}
+
+ModelData GeodeticGridChunk::getData(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex) const {
+    //Indicies below the start wrap around and fail the check too
+    if(timeIndex - info.timeStart >= info.timeSize ||
+       depthIndex - info.depthStart >= info.depthSize ||
+       latIndex - info.latStart >= info.latSize ||
+       lonIndex - info.lonStart >= info.lonSize) {
+        throw std::runtime_error("GeodeticGridChunk index out of bounds");
+    }
+
+    size_t offset = getOffset(timeIndex, depthIndex, latIndex, lonIndex);
+
+    ModelData data;
+    if(precision == GeodeticGridParameters::FLOAT32) {
+        copyValues(floatValues.getDataArray() + offset, data);
+    } else {
+        copyValues(doubleValues.getDataArray() + offset, data);
     }
 
     //Water column depth isn't included in the chunks so just set that to NaN for now and fill it in later.
@@ -85,3 +197,7 @@ ModelData GeodeticGridChunk::getData(unsigned int timeIndex, unsigned int depthI
 
     return data;
 }
+
+size_t GeodeticGridChunk::getMemoryUsage() const {
+    return sizeof(GeodeticGridChunk) - sizeof(floatValues) - sizeof(doubleValues) + floatValues.getMemoryUsage() + doubleValues.getMemoryUsage();
+}
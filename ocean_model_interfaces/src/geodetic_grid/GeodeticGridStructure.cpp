@@ -1,29 +1,61 @@
 #include "ocean_model_interfaces/geodetic_grid/GeodeticGridStructure.h"
 #include "ocean_model_interfaces/model_interface/ModelData.h"
 #include "ocean_model_interfaces/util/UtilityFunctions.h"
+#include "ocean_model_interfaces/util/NetCDFMutex.h"
+#include "ocean_model_interfaces/util/NetCDFStorageBackend.h"
 
 #include <stdexcept>
 #include <math.h>
 #include  <limits>
 #include <iostream>
+#include <algorithm>
+#include <sstream>
 #include <boost/filesystem.hpp>
 
 namespace fs = boost::filesystem;
 
 using namespace ocean_model_interfaces;
 
-GeodeticGridStructure::GeodeticGridStructure() {}
+GeodeticGridStructure::GeodeticGridStructure() :
+    filePool(std::make_shared<NetCDFFilePool>()),
+    storageBackend(std::make_shared<NetCDFStorageBackend>(filePool)) {}
 
-GeodeticGridStructure::GeodeticGridStructure(GeodeticGridParameters parameters) {
+GeodeticGridStructure::GeodeticGridStructure(GeodeticGridParameters parameters) :
+    filePool(std::make_shared<NetCDFFilePool>()),
+    storageBackend(std::make_shared<NetCDFStorageBackend>(filePool)) {
     this->parameters = parameters;
-    loadStructureData();
+    {
+        std::lock_guard<std::mutex> lock(getNetCDFMutex());
+        loadStructureData();
+    }
     determineChunksPerDimension();
 }
 
+/**
+ * Reads the layer depths, stored as [depth][lat][lon] in the model files, into a [lat][lon][depth] table
+ * so the depths of each column are next to each other.
+ */
+template<typename T>
+static MultiDimensionalVector<T, 3> loadColumnDepths(netCDF::NcVar& depthVar, unsigned int depthDim, unsigned int latDim, unsigned int lonDim) {
+    std::vector<T> layerDepths((size_t)depthDim * latDim * lonDim);
+    depthVar.getVar(layerDepths.data());
+
+    MultiDimensionalVector<T, 3> columnDepths({latDim, lonDim, depthDim});
+    size_t n = 0;
+    for(unsigned int depth = 0; depth < depthDim; depth++) {
+        for(unsigned int lat = 0; lat < latDim; lat++) {
+            for(unsigned int lon = 0; lon < lonDim; lon++) {
+                columnDepths(lat, lon, depth) = layerDepths[n++];
+            }
+        }
+    }
+    return columnDepths;
+}
+
 void GeodeticGridStructure::loadStructureData() {
     loadTime();
 
-    netCDF::NcFile singleDataFile(modelFiles[0].filename, netCDF::NcFile::read);
+    netCDF::NcFile& singleDataFile = filePool->getFile(modelFiles[0].filename);
     //Get dimensions of structure elements
     unsigned int latDim = singleDataFile.getDim("eta_rho").getSize();
     unsigned int lonDim = singleDataFile.getDim("xi_rho").getSize();
@@ -71,11 +103,29 @@ void GeodeticGridStructure::loadStructureData() {
     std::vector<size_t> lonCount = {1, lonDim};
     lonVar.getVar(lonStart, lonCount, longitudes.data());
 
-    depths = MultiDimensionalVector<double>({depthDim, latDim, lonDim});
-    depthVar.getVar(depths.getDataArray());
+    //netCDF converts the depths to the precision they are stored in
+    if(parameters.precision == GeodeticGridParameters::FLOAT32) {
+        floatColumnDepths = loadColumnDepths<float>(depthVar, depthDim, latDim, lonDim);
+
+        floatWaterColumnDepth = MultiDimensionalVector<float, 2>({latDim, lonDim});
+        waterColumnDepthVar.getVar(floatWaterColumnDepth.getDataArray());
+    } else {
+        doubleColumnDepths = loadColumnDepths<double>(depthVar, depthDim, latDim, lonDim);
+
+        doubleWaterColumnDepth = MultiDimensionalVector<double, 2>({latDim, lonDim});
+        waterColumnDepthVar.getVar(doubleWaterColumnDepth.getDataArray());
+    }
+}
 
-    waterColumnDepth = MultiDimensionalVector<double>({latDim, lonDim});
-    waterColumnDepthVar.getVar(waterColumnDepth.getDataArray());
+unsigned int GeodeticGridStructure::getDepthDim() const {
+    return parameters.precision == GeodeticGridParameters::FLOAT32 ? floatColumnDepths.size(2) : doubleColumnDepths.size(2);
+}
+
+double GeodeticGridStructure::getWaterColumnDepth(unsigned int latIndex, unsigned int lonIndex) const {
+    if(parameters.precision == GeodeticGridParameters::FLOAT32) {
+        return floatWaterColumnDepth(latIndex, lonIndex);
+    }
+    return doubleWaterColumnDepth(latIndex, lonIndex);
 }
 
 void GeodeticGridStructure::loadTime() {
@@ -85,7 +135,7 @@ void GeodeticGridStructure::loadTime() {
     //Set start times and time dimensions from files
     for(auto &filename : filenames)
     {
-        netCDF::NcFile dataFile(filename, netCDF::NcFile::read);
+        netCDF::NcFile& dataFile = filePool->getFile(filename);
 
         timeDim += dataFile.getDim("ocean_time").getSize();
         
@@ -114,7 +164,7 @@ void GeodeticGridStructure::loadTime() {
     unsigned int currentIndex = 0;
     for(auto &modelFile : modelFiles)
     {
-        netCDF::NcFile dataFile(modelFile.filename, netCDF::NcFile::read);
+        netCDF::NcFile& dataFile = filePool->getFile(modelFile.filename);
         netCDF::NcVar timeVar = dataFile.getVar("ocean_time");
 
         //Set the start time index for this file
@@ -131,7 +181,7 @@ void GeodeticGridStructure::loadTime() {
 void GeodeticGridStructure::determineChunksPerDimension() {
     //Round the integer division up so we have a partially filled chunk at the end
     timeDimChunks = (times.size() / parameters.timeChunkSize) + (times.size() % parameters.timeChunkSize != 0);
-    depthDimChunks = (depths.size()[0] / parameters.depthChunkSize) + (depths.size()[0] % parameters.depthChunkSize != 0);
+    depthDimChunks = (getDepthDim() / parameters.depthChunkSize) + (getDepthDim() % parameters.depthChunkSize != 0);
     latDimChunks = (latitudes.size() / parameters.latChunkSize) + (latitudes.size() % parameters.latChunkSize != 0);
     lonDimChunks = (longitudes.size() / parameters.lonChunkSize) + (longitudes.size() % parameters.lonChunkSize != 0);
 }
@@ -150,7 +200,7 @@ GeodeticGridStructure::ChunkInfo GeodeticGridStructure::getGridChunkInfo(unsigne
     info.lonStart = info.lonChunk * parameters.lonChunkSize;
 
     info.timeSize = std::min<unsigned int>(parameters.timeChunkSize, times.size() - info.timeStart);
-    info.depthSize = std::min<unsigned int>(parameters.depthChunkSize, depths.size()[0] - info.depthStart);
+    info.depthSize = std::min<unsigned int>(parameters.depthChunkSize, getDepthDim() - info.depthStart);
     info.latSize = std::min<unsigned int>(parameters.latChunkSize, latitudes.size() - info.latStart);
     info.lonSize = std::min<unsigned int>(parameters.lonChunkSize, longitudes.size() - info.lonStart);
 
@@ -166,9 +216,37 @@ unsigned int GeodeticGridStructure::getChunkIdFromIndicies(unsigned int timeInde
     return lonChunk + (latChunk * lonDimChunks) + (depthChunk * latDimChunks * lonDimChunks) + (timeChunk * depthDimChunks * latDimChunks * lonDimChunks);
 }
 
+std::vector<GeodeticGridStructure::ChunkInfo> GeodeticGridStructure::getAllChunks() {
+    std::vector<ChunkInfo> chunks;
+    for(unsigned int timeStart = 0; timeStart < times.size(); timeStart += parameters.timeChunkSize) {
+        for(unsigned int depthStart = 0; depthStart < getDepthDim(); depthStart += parameters.depthChunkSize) {
+            for(unsigned int latStart = 0; latStart < latitudes.size(); latStart += parameters.latChunkSize) {
+                for(unsigned int lonStart = 0; lonStart < longitudes.size(); lonStart += parameters.lonChunkSize) {
+                    chunks.push_back(getGridChunkInfo(timeStart, depthStart, latStart, lonStart));
+                }
+            }
+        }
+    }
+    return chunks;
+}
+
+unsigned int GeodeticGridStructure::getNumChunks() const {
+    return timeDimChunks * depthDimChunks * latDimChunks * lonDimChunks;
+}
+
+std::string GeodeticGridStructure::getChunkLayoutKey() const {
+    std::ostringstream key;
+    key << "GeodeticGrid\n"
+        << "chunks " << parameters.timeChunkSize << " " << parameters.depthChunkSize << " "
+        << parameters.latChunkSize << " " << parameters.lonChunkSize << "\n"
+        << "times " << times.size() << " depths " << getDepthDim()
+        << " lats " << latitudes.size() << " lons " << longitudes.size() << "\n";
+    return key.str();
+}
+
 bool GeodeticGridStructure::indexInRange(unsigned int timeIndex, unsigned int depthIndex, unsigned int latIndex, unsigned int lonIndex) {
     if(timeIndex >= times.size() ||
-       depthIndex >= depths.size()[0] ||
+       depthIndex >= getDepthDim() ||
        latIndex >= latitudes.size() ||
        lonIndex >= longitudes.size()) {
         return false;
@@ -192,16 +270,23 @@ bool GeodeticGridStructure::xyInModel(Point point) {
 }
 
 double GeodeticGridStructure::indexWaterColumnDepth(unsigned int latIndex, unsigned int lonIndex) {
-    return waterColumnDepth.index({latIndex, lonIndex});
+    if(parameters.precision == GeodeticGridParameters::FLOAT32) {
+        return floatWaterColumnDepth.index(latIndex, lonIndex);
+    }
+    return doubleWaterColumnDepth.index(latIndex, lonIndex);
 }
 
 double GeodeticGridStructure::interpolateWaterColumnDepth(Point point) {
-    std::map<std::pair<unsigned int, unsigned int>, double> xyWeights = getXYInterpolationWeights(point);
+    XYWeights xyWeights;
+    getXYInterpolationWeights(point, xyWeights);
 
-    double depth = 0;
-    for (auto const& xyWeight : xyWeights) {
+    return interpolateWaterColumnDepth(xyWeights);
+}
 
-        depth += waterColumnDepth.index({xyWeight.first.first, xyWeight.first.second}) * xyWeight.second;
+double GeodeticGridStructure::interpolateWaterColumnDepth(const XYWeights& xyWeights) {
+    double depth = 0;
+    for(unsigned int i = 0; i < 3; i++) {
+        depth += getWaterColumnDepth(xyWeights.latIndices[i], xyWeights.lonIndices[i]) * xyWeights.weights[i];
     }
 
     return depth;
@@ -211,7 +296,19 @@ std::vector<GeodeticGridStructure::ModelFile>& GeodeticGridStructure::getModelFi
     return modelFiles;
 }
 
-std::map<unsigned int, double> GeodeticGridStructure::getTimeInterpolationWeights(double time) {
+NetCDFFilePool& GeodeticGridStructure::getFilePool() {
+    return *filePool;
+}
+
+StorageBackend& GeodeticGridStructure::getStorageBackend() {
+    return *storageBackend;
+}
+
+void GeodeticGridStructure::setStorageBackend(std::shared_ptr<StorageBackend> backend) {
+    storageBackend = backend;
+}
+
+void GeodeticGridStructure::getTimeInterpolationWeights(double time, TimeWeights& weights) {
     // Search for first element x such that i ≤ x
     auto firstElementGreater = std::lower_bound(times.begin(), times.end(), time);
 
@@ -233,14 +330,14 @@ std::map<unsigned int, double> GeodeticGridStructure::getTimeInterpolationWeight
     double beforeWeight = (afterTime - time) / (afterTime - beforeTime);
     double afterWeight = 1 - beforeWeight;
 
-    std::map<unsigned int, double> weights;
-    weights.insert({beforeIndex, beforeWeight});
-    weights.insert({afterIndex, afterWeight});
-    return weights;
+    weights.indices[0] = beforeIndex;
+    weights.weights[0] = beforeWeight;
+    weights.indices[1] = afterIndex;
+    weights.weights[1] = afterWeight;
 }
 
 
-std::map<std::pair<unsigned int, unsigned int>, double> GeodeticGridStructure::getXYInterpolationWeights(Point point) {
+void GeodeticGridStructure::getXYInterpolationWeights(Point point, XYWeights& weights) {
     // Search for first element x such that i ≤ x
     auto latFirstElementGreater = std::lower_bound(latitudes.begin(), latitudes.end(), point.y);
     auto lonFirstElementGreater = std::lower_bound(longitudes.begin(), longitudes.end(), point.x);
@@ -274,151 +371,270 @@ std::map<std::pair<unsigned int, unsigned int>, double> GeodeticGridStructure::g
     double lonBefore = longitudes[lonBeforeIndex];
     double lonAfter = longitudes[lonAfterIndex];
 
-    std::vector<Point> tri1XY;
-    std::vector<std::pair<unsigned int, unsigned int>> tri1Index;
-
-    std::vector<Point> tri2XY;
-    std::vector<std::pair<unsigned int, unsigned int>> tri2Index;
-
     Point origin = Point(lonBefore,latBefore,0);
     Point xyPoint = latLonToLocalXY(origin, point);
 
-    tri1Index.push_back(std::make_pair(latBeforeIndex, lonBeforeIndex));
-    tri1XY.push_back(latLonToLocalXY(origin, Point(lonBefore, latBefore, 0)));
-
-    tri1Index.push_back(std::make_pair(latBeforeIndex, lonAfterIndex));
-    tri1XY.push_back(latLonToLocalXY(origin, Point(lonAfter, latBefore, 0)));
-
-    tri1Index.push_back(std::make_pair(latAfterIndex, lonBeforeIndex));
-    tri1XY.push_back(latLonToLocalXY(origin, Point(lonBefore, latAfter, 0)));
+    //The corners shared by both triangles of the grid cell
+    Point beforeAfterXY = latLonToLocalXY(origin, Point(lonAfter, latBefore, 0));
+    Point afterBeforeXY = latLonToLocalXY(origin, Point(lonBefore, latAfter, 0));
 
-    auto tri1Barycenter = calculateBarycentricCoordinates(tri1XY[0], tri1XY[1], tri1XY[2], xyPoint);
+    auto tri1Barycenter = calculateBarycentricCoordinates(latLonToLocalXY(origin, Point(lonBefore, latBefore, 0)),
+                                                          beforeAfterXY, afterBeforeXY, xyPoint);
 
-    tri2Index.push_back(std::make_pair(latAfterIndex, lonAfterIndex));
-    tri2XY.push_back(latLonToLocalXY(origin, Point(lonAfter, latAfter, 0)));
-
-    tri2Index.push_back(std::make_pair(latBeforeIndex, lonAfterIndex));
-    tri2XY.push_back(latLonToLocalXY(origin, Point(lonAfter, latBefore, 0)));
+    //Corners are stored in lat then lon order
+    if(std::get<0>(tri1Barycenter) >= 0 && std::get<1>(tri1Barycenter) >= 0 && std::get<2>(tri1Barycenter) >= 0) {
+        weights.latIndices[0] = latBeforeIndex;
+        weights.lonIndices[0] = lonBeforeIndex;
+        weights.weights[0] = std::get<0>(tri1Barycenter);
 
-    tri2Index.push_back(std::make_pair(latAfterIndex, lonBeforeIndex));
-    tri2XY.push_back(latLonToLocalXY(origin, Point(lonBefore, latAfter, 0)));
+        weights.latIndices[1] = latBeforeIndex;
+        weights.lonIndices[1] = lonAfterIndex;
+        weights.weights[1] = std::get<1>(tri1Barycenter);
 
-    auto tri2Barycenter = calculateBarycentricCoordinates(tri2XY[0], tri2XY[1], tri2XY[2], xyPoint);
-
-    std::map<std::pair<unsigned int, unsigned int>, double> weights;
-    if(std::get<0>(tri1Barycenter) >= 0 && std::get<1>(tri1Barycenter) >= 0 && std::get<2>(tri1Barycenter) >= 0) {
-        weights.insert({tri1Index[0], std::get<0>(tri1Barycenter)});
-        weights.insert({tri1Index[1], std::get<1>(tri1Barycenter)});
-        weights.insert({tri1Index[2], std::get<2>(tri1Barycenter)});
+        weights.latIndices[2] = latAfterIndex;
+        weights.lonIndices[2] = lonBeforeIndex;
+        weights.weights[2] = std::get<2>(tri1Barycenter);
 
     } else {
+        auto tri2Barycenter = calculateBarycentricCoordinates(latLonToLocalXY(origin, Point(lonAfter, latAfter, 0)),
+                                                              beforeAfterXY, afterBeforeXY, xyPoint);
         assert(std::get<0>(tri2Barycenter) >= 0 && std::get<1>(tri2Barycenter) >= 0 && std::get<2>(tri2Barycenter) >= 0);
-        weights.insert({tri2Index[0], std::get<0>(tri2Barycenter)});
-        weights.insert({tri2Index[1], std::get<1>(tri2Barycenter)});
-        weights.insert({tri2Index[2], std::get<2>(tri2Barycenter)});
-    }
 
-    return weights;
-}
+        weights.latIndices[0] = latBeforeIndex;
+        weights.lonIndices[0] = lonAfterIndex;
+        weights.weights[0] = std::get<1>(tri2Barycenter);
 
-double GeodeticGridStructure::interpolateDepthLayer(std::map<std::pair<unsigned int, unsigned int>, double> xyWeights, unsigned int layer) {
-    double val = 0;
+        weights.latIndices[1] = latAfterIndex;
+        weights.lonIndices[1] = lonBeforeIndex;
+        weights.weights[1] = std::get<2>(tri2Barycenter);
 
-    for (auto const& xyWeight : xyWeights) {
-        val += depths.index({layer, xyWeight.first.first, xyWeight.first.second}) * xyWeight.second;
+        weights.latIndices[2] = latAfterIndex;
+        weights.lonIndices[2] = lonAfterIndex;
+        weights.weights[2] = std::get<0>(tri2Barycenter);
     }
+}
 
-    return val;
+void GeodeticGridStructure::getDepthInterpolationWeights(Point point, const XYWeights& xyWeights, DepthWeights& weights) {
+    if(parameters.precision == GeodeticGridParameters::FLOAT32) {
+        getDepthInterpolationWeights(floatColumnDepths, point, xyWeights, weights);
+    } else {
+        getDepthInterpolationWeights(doubleColumnDepths, point, xyWeights, weights);
+    }
 }
 
-std::map<unsigned int, double> GeodeticGridStructure::getDepthInterpolationWeights(Point point, std::map<std::pair<unsigned int, unsigned int>, double> xyWeights) {
+template<typename T>
+void GeodeticGridStructure::getDepthInterpolationWeights(const MultiDimensionalVector<T, 3>& columnDepths, Point point, const XYWeights& xyWeights, DepthWeights& weights) {
+    //The layer depths of each grid point are next to each other
+    const T* columns[3];
+    for(unsigned int i = 0; i < 3; i++) {
+        columns[i] = columnDepths.slice(xyWeights.latIndices[i]).slice(xyWeights.lonIndices[i]).getDataArray();
+    }
 
-    std::vector<double> interpDepths;
+    //Layer depths are interpolated as they are searched, so no list of them is built
+    auto interpolateDepthLayer = [&](unsigned int layer) {
+        double val = 0;
+        for(unsigned int i = 0; i < 3; i++) {
+            val += columns[i][layer] * xyWeights.weights[i];
+        }
+        return val;
+    };
 
-    for(unsigned int i = 0; i < depths.size()[0]; i++) {
-        interpDepths.push_back(interpolateDepthLayer(xyWeights, i));
-    }
+    unsigned int numDepths = columnDepths.size(2);
+    double firstDepth = interpolateDepthLayer(0);
+    double secondDepth = interpolateDepthLayer(1);
+    double lastDepth = numDepths == 2 ? secondDepth : interpolateDepthLayer(numDepths - 1);
 
     int depthIndexShallow = 0; //The larger number
     int depthIndexDeep = 0; //The smaller number
+    double shallowDepth = 0;
+    double deepDepth = 0;
 
+    //Layers are sorted in every column, so their weighted sum is too. The pair of layers used is the last pair
+    //in index order whose depths include point.z, so a point exactly on a layer uses that layer and the one after it.
     //If depth[0] is the surface
-    if(interpDepths[0] > interpDepths[1]) {
-        if(point.z > interpDepths[0]) {
+    if(firstDepth > secondDepth) {
+        if(point.z > firstDepth) {
             depthIndexShallow = 0;
             depthIndexDeep = 0;
-        } else if(point.z < interpDepths[interpDepths.size() - 1]) {
-            depthIndexShallow = interpDepths.size() - 1;
-            depthIndexDeep = interpDepths.size() - 1;
+        } else if(point.z < lastDepth) {
+            depthIndexShallow = numDepths - 1;
+            depthIndexDeep = numDepths - 1;
         } else {
-            for(int i = 0; i < interpDepths.size() - 1; i++) {
-                if(interpDepths[i] >= point.z && point.z >= interpDepths[i+1]) {
-                    depthIndexShallow = i;
-                    depthIndexDeep = i+1;
+            //Number of layers at or above point.z
+            unsigned int low = 0;
+            unsigned int high = numDepths;
+            while(low < high) {
+                unsigned int mid = (low + high) / 2;
+                if(interpolateDepthLayer(mid) >= point.z) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
                 }
             }
+
+            if(low > 0) {
+                unsigned int i = std::min(low - 1, numDepths - 2);
+                depthIndexShallow = i;
+                depthIndexDeep = i+1;
+                shallowDepth = interpolateDepthLayer(i);
+                deepDepth = interpolateDepthLayer(i + 1);
+            }
         }
     } else {
         //If depth[0] is the seafloor
-        if(point.z < interpDepths[0]) {
+        if(point.z < firstDepth) {
             depthIndexShallow = 0;
             depthIndexDeep = 0;
-        } else if(point.z > interpDepths[interpDepths.size() - 1]) {
-            depthIndexShallow = interpDepths.size() - 1;
-            depthIndexDeep = interpDepths.size() - 1;
+        } else if(point.z > lastDepth) {
+            depthIndexShallow = numDepths - 1;
+            depthIndexDeep = numDepths - 1;
         } else {
-            for(int i = 0; i < interpDepths.size() - 1; i++) {
-
-                if(interpDepths[i] <= point.z && point.z <= interpDepths[i+1]) {
-                    depthIndexShallow = i+1;
-                    depthIndexDeep = i;
+            //Number of layers at or below point.z
+            unsigned int low = 0;
+            unsigned int high = numDepths;
+            while(low < high) {
+                unsigned int mid = (low + high) / 2;
+                if(interpolateDepthLayer(mid) <= point.z) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
                 }
             }
+
+            if(low > 0) {
+                unsigned int i = std::min(low - 1, numDepths - 2);
+                depthIndexShallow = i+1;
+                depthIndexDeep = i;
+                shallowDepth = interpolateDepthLayer(i + 1);
+                deepDepth = interpolateDepthLayer(i);
+            }
         }
     }
 
-    std::map<unsigned int, double> weights;
     if(depthIndexShallow ==depthIndexDeep) {
-        weights.insert({depthIndexShallow, 1.0});
+        weights.indices[0] = depthIndexShallow;
+        weights.weights[0] = 1.0;
+        weights.size = 1;
     } else {
-        double shallowDepth = interpDepths[depthIndexShallow];
-        double deepDepth = interpDepths[depthIndexDeep];
-
         double shallowWeight = (deepDepth - point.z) / (deepDepth - shallowDepth);
         double deepWeight = 1 - shallowWeight;
 
-        weights.insert({depthIndexShallow, shallowWeight});
-        weights.insert({depthIndexDeep, deepWeight});
+        //Stored in index order
+        unsigned int shallow = depthIndexShallow < depthIndexDeep ? 0 : 1;
+        weights.indices[shallow] = depthIndexShallow;
+        weights.weights[shallow] = shallowWeight;
+        weights.indices[1 - shallow] = depthIndexDeep;
+        weights.weights[1 - shallow] = deepWeight;
+        weights.size = 2;
     }
+}
 
-    return weights;
+/**
+ * Finds the indicies of the values on either side of [minValue, maxValue] in a sorted vector.
+ * Returns false if the range does not overlap the values.
+ */
+static bool getIndexRange(const std::vector<double>& values, double minValue, double maxValue, unsigned int& first, unsigned int& last) {
+    if(maxValue < values.front() || minValue > values.back()) {
+        return false;
+    }
+
+    auto lower = std::upper_bound(values.begin(), values.end(), minValue);
+    auto upper = std::lower_bound(values.begin(), values.end(), maxValue);
+    first = lower == values.begin() ? 0 : std::distance(values.begin(), lower) - 1;
+    last = upper == values.end() ? values.size() - 1 : std::distance(values.begin(), upper);
+
+    return true;
 }
 
-std::map<std::tuple<unsigned int, unsigned int, unsigned int, unsigned int>, double> GeodeticGridStructure::getDataInterpolationWeights(Point point, double time) {
-    std::map<std::tuple<unsigned int, unsigned int, unsigned int, unsigned int>, double> weights;
+std::vector<GeodeticGridStructure::ChunkInfo> GeodeticGridStructure::getChunksInRegion(Point minPoint, Point maxPoint, double startTime, double endTime) {
+    std::vector<ChunkInfo> chunks;
 
-    if(!timeInModel(time) || !depthInModel(point) || !xyInModel(point)) {
+    unsigned int timeFirst, timeLast, latFirst, latLast, lonFirst, lonLast;
+    if(!getIndexRange(times, startTime, endTime, timeFirst, timeLast) ||
+       !getIndexRange(latitudes, minPoint.y, maxPoint.y, latFirst, latLast) ||
+       !getIndexRange(longitudes, minPoint.x, maxPoint.x, lonFirst, lonLast)) {
+        return chunks;
+    }
+
+    //Find the depth layers around the depth range at the center of the box, clamped to the grid
+    Point center;
+    center.x = std::min(std::max((minPoint.x + maxPoint.x) / 2, longitudes.front()), longitudes.back());
+    center.y = std::min(std::max((minPoint.y + maxPoint.y) / 2, latitudes.front()), latitudes.back());
+    XYWeights xyWeights;
+    getXYInterpolationWeights(center, xyWeights);
+
+    unsigned int depthFirst = getDepthDim() - 1;
+    unsigned int depthLast = 0;
+    for(double z : {minPoint.z, maxPoint.z}) {
+        center.z = z;
+        DepthWeights depthWeights;
+        getDepthInterpolationWeights(center, xyWeights, depthWeights);
+        for(unsigned int i = 0; i < depthWeights.size; i++) {
+            depthFirst = std::min(depthFirst, depthWeights.indices[i]);
+            depthLast = std::max(depthLast, depthWeights.indices[i]);
+        }
+    }
+
+    for(unsigned int timeChunk = timeFirst / parameters.timeChunkSize; timeChunk <= timeLast / parameters.timeChunkSize; timeChunk++) {
+        for(unsigned int depthChunk = depthFirst / parameters.depthChunkSize; depthChunk <= depthLast / parameters.depthChunkSize; depthChunk++) {
+            for(unsigned int latChunk = latFirst / parameters.latChunkSize; latChunk <= latLast / parameters.latChunkSize; latChunk++) {
+                for(unsigned int lonChunk = lonFirst / parameters.lonChunkSize; lonChunk <= lonLast / parameters.lonChunkSize; lonChunk++) {
+                    chunks.push_back(getGridChunkInfo(timeChunk * parameters.timeChunkSize,
+                                                      depthChunk * parameters.depthChunkSize,
+                                                      latChunk * parameters.latChunkSize,
+                                                      lonChunk * parameters.lonChunkSize));
+                }
+            }
+        }
+    }
+
+    return chunks;
+}
+
+void GeodeticGridStructure::getInterpolationStencil(Point point, double time, InterpolationStencil& stencil) {
+    //Check XY before depth since the depth needs the point to be on the grid
+    if(!timeInModel(time) || !xyInModel(point)) {
+        throw std::out_of_range("GeodeticGrid request outside of model extent");
+    }
+
+    XYWeights xyWeights;
+    getXYInterpolationWeights(point, xyWeights);
+
+    stencil.waterColumnDepth = interpolateWaterColumnDepth(xyWeights);
+    if(!(0 >= point.z && point.z >= -stencil.waterColumnDepth)) {
         throw std::out_of_range("GeodeticGrid request outside of model extent");
     }
 
-    std::map<unsigned int, double> timeWeights = getTimeInterpolationWeights(time);
-    std::map<std::pair<unsigned int, unsigned int>, double> xyWeights = getXYInterpolationWeights(point);
-    std::map<unsigned int, double> depthWeights = getDepthInterpolationWeights(point, xyWeights);
-
-    for (auto const& timeWeight : timeWeights) {
-        for (auto const& depthWeight : depthWeights) {
-            for (auto const& xyWeights : xyWeights) {
-                unsigned int timeIndex = timeWeight.first;
-                unsigned int depthIndex = depthWeight.first;
-                unsigned int latIndex = xyWeights.first.first;
-                unsigned int lonIndex = xyWeights.first.second;
-                auto index = std::make_tuple(timeIndex, depthIndex, latIndex, lonIndex);
-
-                double weight = timeWeight.second * depthWeight.second * xyWeights.second;
-                weights.insert({index, weight});
+    TimeWeights timeWeights;
+    getTimeInterpolationWeights(time, timeWeights);
+
+    DepthWeights depthWeights;
+    getDepthInterpolationWeights(point, xyWeights, depthWeights);
+
+    stencil.size = 0;
+    for(unsigned int t = 0; t < 2; t++) {
+        for(unsigned int d = 0; d < depthWeights.size; d++) {
+            for(unsigned int c = 0; c < 3; c++) {
+                InterpolationStencil::GridPoint& gridPoint = stencil.points[stencil.size++];
+                gridPoint.timeIndex = timeWeights.indices[t];
+                gridPoint.depthIndex = depthWeights.indices[d];
+                gridPoint.latIndex = xyWeights.latIndices[c];
+                gridPoint.lonIndex = xyWeights.lonIndices[c];
+                gridPoint.weight = timeWeights.weights[t] * depthWeights.weights[d] * xyWeights.weights[c];
             }
         }
     }
+}
+
+std::map<std::tuple<unsigned int, unsigned int, unsigned int, unsigned int>, double> GeodeticGridStructure::getDataInterpolationWeights(Point point, double time) {
+    InterpolationStencil stencil;
+    getInterpolationStencil(point, time, stencil);
+
+    std::map<std::tuple<unsigned int, unsigned int, unsigned int, unsigned int>, double> weights;
+    for(unsigned int i = 0; i < stencil.size; i++) {
+        const InterpolationStencil::GridPoint& gridPoint = stencil.points[i];
+        weights.insert({std::make_tuple(gridPoint.timeIndex, gridPoint.depthIndex, gridPoint.latIndex, gridPoint.lonIndex), gridPoint.weight});
+    }
 
     return weights;
 }
@@ -0,0 +1,143 @@
+#include "ocean_model_interfaces/geodetic_grid/SyntheticGeodeticGrid.h"
+#include "ocean_model_interfaces/geodetic_grid/GeodeticGridChunk.h"
+#include "ocean_model_interfaces/util/NetCDFMutex.h"
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <algorithm>
+#include <mutex>
+
+#include <netcdf>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+using namespace ocean_model_interfaces;
+
+/**
+ * @brief The files of a synthetic model in time order.
+ */
+static std::vector<SyntheticStorageBackend::File> getFiles(const SyntheticGeodeticGridParameters& parameters) {
+    if(parameters.lats < 2 || parameters.lons < 2 || parameters.depths == 0 ||
+       parameters.timeSteps == 0 || parameters.timeStepsPerFile == 0) {
+        throw std::runtime_error("A synthetic geodetic grid needs at least 2 by 2 grid points, one depth, and one time step in each file");
+    }
+
+    std::vector<SyntheticStorageBackend::File> files;
+    for(unsigned int start = 0; start < parameters.timeSteps; start += parameters.timeStepsPerFile) {
+        char filename[64];
+        std::snprintf(filename, sizeof(filename), "synthetic_grid_%05u.nc", (unsigned int)files.size());
+
+        SyntheticStorageBackend::File file;
+        file.filename = filename;
+        file.timeSteps = std::min(parameters.timeStepsPerFile, parameters.timeSteps - start);
+        files.push_back(file);
+    }
+    return files;
+}
+
+std::shared_ptr<SyntheticStorageBackend> ocean_model_interfaces::createSyntheticGeodeticGridBackend(const SyntheticGeodeticGridParameters& parameters) {
+    //Roughly the range each variable has in an ocean model, in GeodeticGridChunk::getVariableNames order
+    const std::vector<std::string>& names = GeodeticGridChunk::getVariableNames();
+    const float means[] = {0.0f, 0.0f, 0.0f, 34.0f, 10.0f, 0.5f};
+    const float amplitudes[] = {0.5f, 0.5f, 0.01f, 0.5f, 3.0f, 0.5f};
+
+    std::vector<SyntheticStorageBackend::Variable> variables;
+    for(unsigned int i = 0; i < names.size(); i++) {
+        SyntheticStorageBackend::Variable variable;
+        variable.name = names[i];
+        variable.shape = {parameters.depths, parameters.lats, parameters.lons};
+        variable.mean = means[i];
+        variable.amplitude = amplitudes[i];
+        variables.push_back(variable);
+    }
+
+    return std::make_shared<SyntheticStorageBackend>(getFiles(parameters), variables);
+}
+
+void ocean_model_interfaces::writeSyntheticGeodeticGrid(const std::string& directory, const SyntheticGeodeticGridParameters& parameters) {
+    std::vector<SyntheticStorageBackend::File> files = getFiles(parameters);
+    std::shared_ptr<SyntheticStorageBackend> backend = createSyntheticGeodeticGridBackend(parameters);
+
+    size_t lats = parameters.lats;
+    size_t lons = parameters.lons;
+    size_t gridPoints = lats * lons;
+
+    //North aligned grid and a water column depth that varies smoothly between 500 and 1500 meters
+    std::vector<double> latitudes(gridPoints);
+    std::vector<double> longitudes(gridPoints);
+    std::vector<double> h(gridPoints);
+    for(size_t a = 0; a < lats; a++) {
+        for(size_t b = 0; b < lons; b++) {
+            latitudes[a * lons + b] = parameters.minLat + a * parameters.spacing;
+            longitudes[a * lons + b] = parameters.minLon + b * parameters.spacing;
+            h[a * lons + b] = 1000.0 + 500.0 * std::sin(a * 0.07) * std::cos(b * 0.05);
+        }
+    }
+
+    fs::create_directories(directory);
+
+    std::lock_guard<std::mutex> lock(getNetCDFMutex());
+
+    const std::vector<std::string>& names = GeodeticGridChunk::getVariableNames();
+    std::vector<double> depths(gridPoints);
+    std::vector<float> values;
+    unsigned int startTime = 0;
+    for(const SyntheticStorageBackend::File& modelFile : files) {
+        netCDF::NcFile file((fs::path(directory) / modelFile.filename).string(), netCDF::NcFile::replace);
+
+        netCDF::NcDim timeDim = file.addDim("ocean_time", modelFile.timeSteps);
+        netCDF::NcDim depthDim = file.addDim("s_rho", parameters.depths);
+        netCDF::NcDim latDim = file.addDim("eta_rho", lats);
+        netCDF::NcDim lonDim = file.addDim("xi_rho", lons);
+
+        std::vector<double> times(modelFile.timeSteps);
+        for(unsigned int i = 0; i < modelFile.timeSteps; i++) {
+            times[i] = (startTime + i) * parameters.timeStep;
+        }
+        file.addVar("ocean_time", netCDF::ncDouble, timeDim).putVar(times.data());
+
+        std::vector<netCDF::NcDim> gridDims = {latDim, lonDim};
+        file.addVar("lat_rho", netCDF::ncDouble, gridDims).putVar(latitudes.data());
+        file.addVar("lon_rho", netCDF::ncDouble, gridDims).putVar(longitudes.data());
+        file.addVar("h", netCDF::ncDouble, gridDims).putVar(h.data());
+
+        //Evenly spaced layers, the first at the bottom unless surfaceFirst, written one layer at a time
+        netCDF::NcVar depthVar = file.addVar("z_rho0", netCDF::ncDouble, std::vector<netCDF::NcDim>{depthDim, latDim, lonDim});
+        for(unsigned int s = 0; s < parameters.depths; s++) {
+            unsigned int layer = parameters.surfaceFirst ? parameters.depths - 1 - s : s;
+            for(size_t i = 0; i < gridPoints; i++) {
+                depths[i] = -h[i] * (1.0 - (layer + 0.5) / parameters.depths);
+            }
+            std::vector<size_t> start = {s, 0, 0};
+            std::vector<size_t> count = {1, lats, lons};
+            depthVar.putVar(start, count, depths.data());
+        }
+
+        for(const std::string& name : names) {
+            netCDF::NcVar var = file.addVar(name, netCDF::ncFloat, std::vector<netCDF::NcDim>{timeDim, depthDim, latDim, lonDim});
+
+            //One chunk per time step and layer, so data that is not written takes no space
+            std::vector<size_t> chunkSizes = {1, 1, lats, lons};
+            var.setChunking(netCDF::NcVar::nc_CHUNKED, chunkSizes);
+
+            if(!parameters.writeData) {
+                continue;
+            }
+
+            //Write one time step at a time to bound memory for large grids
+            std::vector<size_t> count = {1, parameters.depths, lats, lons};
+            values.resize(parameters.depths * gridPoints);
+            for(unsigned int i = 0; i < modelFile.timeSteps; i++) {
+                std::vector<size_t> start = {i, 0, 0, 0};
+                backend->read(modelFile.filename, name, start, count, values.data());
+                var.putVar(start, count, values.data());
+            }
+        }
+
+        startTime += modelFile.timeSteps;
+    }
+}
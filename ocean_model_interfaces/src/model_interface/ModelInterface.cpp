@@ -2,6 +2,7 @@
 #include "ocean_model_interfaces/util/UtilityFunctions.h"
 
 #include <stdexcept>
+#include <vector>
 #include <math.h>
 #include  <limits>
 #include <assert.h>
@@ -22,25 +23,98 @@ ModelInterface::~ModelInterface() {}
 
 const ModelData ModelInterface::getData(double x, double y, double z, double time)
 {
+    return getData(x, y, z, time, defaultContext);
+}
 
-    if(positionType == CoordinateType::XY) {
+const ModelData ModelInterface::getData(double x, double y, double z, double time, QueryContext& context)
+{
+    Point modelPoint = toModelCoordinates(x, y, z);
 
-        return this->getDataHelper(x + offsetX, y + offsetY, z + offsetZ, time + offsetTime);
+    return this->getDataHelperWithContext(modelPoint.x, modelPoint.y, modelPoint.z, time + offsetTime, context);
+}
 
-    } else {
-        assert(positionType == CoordinateType::LATLON);
+const ModelData ModelInterface::getDataOutOfRange(double x, double y, double z, double time)
+{
+    return getDataOutOfRange(x, y, z, time, defaultContext);
+}
 
-        //Convert the lat lon to xy based on the origin and shift based on the offset        
-        Point pointXY = latLonToLocalXY(origin, Point(x,y,z));
+const ModelData ModelInterface::getDataOutOfRange(double x, double y, double z, double time, QueryContext& context)
+{
+    Point modelPoint = toModelCoordinates(x, y, z);
+
+    return this->getDataOutOfRangeHelperWithContext(modelPoint.x, modelPoint.y, modelPoint.z, time + offsetTime, context);
+}
+
+void ModelInterface::prefetch(double x, double y, double z, double time, double radius, double timeWindow)
+{
+    Point modelPoint = toModelCoordinates(x, y, z);
+
+    this->prefetchHelper(modelPoint.x, modelPoint.y, modelPoint.z, time + offsetTime, radius, timeWindow);
+}
+
+void ModelInterface::waitForPrefetch()
+{
+    prefetchLoader.wait();
+}
+
+void ModelInterface::prefetchHelper(double x, double y, double z, double time, double radius, double timeWindow) {}
 
-        return this->getDataHelper(pointXY.x + offsetX, pointXY.y + offsetY, z + offsetZ, time + offsetTime);
+void ModelInterface::stopPrefetching()
+{
+    prefetchLoader.stop();
+}
+
+const ModelData ModelInterface::getDataHelperWithContext(double x, double y, double z, double time, QueryContext& context)
+{
+    return this->getDataHelper(x, y, z, time);
+}
+
+const ModelData ModelInterface::getDataOutOfRangeHelperWithContext(double x, double y, double z, double time, QueryContext& context)
+{
+    return this->getDataOutOfRangeHelper(x, y, z, time);
+}
+
+void ModelInterface::getDataBatch(const double* x, const double* y, const double* z, const double* time, size_t n, ModelDataSoA& out)
+{
+    std::vector<double> modelX(n);
+    std::vector<double> modelY(n);
+    std::vector<double> modelZ(n);
+    std::vector<double> modelTime(n);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        Point modelPoint = toModelCoordinates(x[i], y[i], z[i]);
+        modelX[i] = modelPoint.x;
+        modelY[i] = modelPoint.y;
+        modelZ[i] = modelPoint.z;
+        modelTime[i] = time[i] + offsetTime;
+    }
+
+    out.resize(n);
+    this->getDataBatchHelper(modelX.data(), modelY.data(), modelZ.data(), modelTime.data(), n, out);
+}
+
+void ModelInterface::getDataBatchHelper(const double* x, const double* y, const double* z, const double* time, size_t n, ModelDataSoA& out)
+{
+    QueryContext context;
+    for(size_t i = 0; i < n; i++)
+    {
+        try
+        {
+            out.set(i, this->getDataHelperWithContext(x[i], y[i], z[i], time[i], context), true);
+        }
+        catch(const std::out_of_range& e)
+        {
+            out.set(i, this->getDataOutOfRangeHelperWithContext(x[i], y[i], z[i], time[i], context), false);
+        }
     }
 }
 
-const ModelData ModelInterface::getDataOutOfRange(double x, double y, double z, double time)
+Point ModelInterface::toModelCoordinates(double x, double y, double z) const
 {
     if(positionType == CoordinateType::XY) {
-        return this->getDataOutOfRangeHelper(x + offsetX, y + offsetY, z + offsetZ, time + offsetTime);
+
+        return Point(x + offsetX, y + offsetY, z + offsetZ);
 
     } else {
         assert(positionType == CoordinateType::LATLON);
@@ -48,8 +122,7 @@ const ModelData ModelInterface::getDataOutOfRange(double x, double y, double z,
         //Convert the lat lon to xy based on the origin and shift based on the offset        
         Point pointXY = latLonToLocalXY(origin, Point(x,y,z));
 
-
-        return this->getDataOutOfRangeHelper(pointXY.x + offsetX, pointXY.y + offsetY, z + offsetZ, time + offsetTime);
+        return Point(pointXY.x + offsetX, pointXY.y + offsetY, z + offsetZ);
     }
 }
 
@@ -68,3 +141,11 @@ void ModelInterface::setOrigin(Point origin) {
 void ModelInterface::setCoordinateType(CoordinateType type) {
     this->positionType = type;
 }
+
+void ModelInterface::setBatchThreadCount(unsigned int threadCount) {
+    this->batchThreadCount = threadCount > 0 ? threadCount : 1;
+}
+
+unsigned int ModelInterface::getBatchThreadCount() const {
+    return batchThreadCount;
+}
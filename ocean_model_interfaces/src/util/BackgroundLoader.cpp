@@ -0,0 +1,146 @@
+#include "ocean_model_interfaces/util/BackgroundLoader.h"
+
+#include <exception>
+
+using namespace ocean_model_interfaces;
+
+BackgroundLoader::BackgroundLoader() {}
+
+BackgroundLoader::BackgroundLoader(const BackgroundLoader& other) {}
+
+BackgroundLoader::BackgroundLoader(BackgroundLoader&& other)
+{
+    other.stop();
+}
+
+BackgroundLoader& BackgroundLoader::operator=(const BackgroundLoader& other)
+{
+    stop();
+    return *this;
+}
+
+BackgroundLoader& BackgroundLoader::operator=(BackgroundLoader&& other)
+{
+    stop();
+    if(&other != this)
+    {
+        other.stop();
+    }
+    return *this;
+}
+
+BackgroundLoader::~BackgroundLoader()
+{
+    stop();
+}
+
+bool BackgroundLoader::enqueue(unsigned int key, std::function<void(void)> load)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if(queuedKeys.count(key) > 0 || (loading && loadingKey == key) || queue.size() >= MAX_PENDING)
+    {
+        return false;
+    }
+
+    if(!thread.joinable())
+    {
+        stopping = false;
+        thread = std::thread(&BackgroundLoader::run, this);
+    }
+
+    queue.push_back(std::make_pair(key, load));
+    queuedKeys.insert(key);
+    workAvailable.notify_one();
+
+    return true;
+}
+
+bool BackgroundLoader::waitFor(unsigned int key)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if(queuedKeys.count(key) > 0)
+    {
+        for(auto it = queue.begin(); it != queue.end(); it++)
+        {
+            if(it->first == key)
+            {
+                queue.erase(it);
+                break;
+            }
+        }
+        queuedKeys.erase(key);
+        return false;
+    }
+
+    if(loading && loadingKey == key)
+    {
+        loadFinished.wait(lock, [this, key]() { return !(loading && loadingKey == key); });
+        return true;
+    }
+
+    return false;
+}
+
+void BackgroundLoader::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    loadFinished.wait(lock, [this]() { return queue.empty() && !loading; });
+}
+
+void BackgroundLoader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.clear();
+        queuedKeys.clear();
+        stopping = true;
+        workAvailable.notify_all();
+        loadFinished.notify_all();
+    }
+
+    if(thread.joinable())
+    {
+        thread.join();
+    }
+}
+
+size_t BackgroundLoader::pending()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() + (loading ? 1 : 0);
+}
+
+void BackgroundLoader::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true)
+    {
+        workAvailable.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if(stopping)
+        {
+            return;
+        }
+
+        std::function<void(void)> load = queue.front().second;
+        loadingKey = queue.front().first;
+        loading = true;
+        queue.pop_front();
+        queuedKeys.erase(loadingKey);
+
+        lock.unlock();
+        try
+        {
+            load();
+        }
+        catch(const std::exception& e)
+        {
+            //Loads are only hints, the chunk will be loaded again when it is actually needed
+        }
+        lock.lock();
+
+        loading = false;
+        loadFinished.notify_all();
+    }
+}
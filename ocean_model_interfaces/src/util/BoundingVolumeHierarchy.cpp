@@ -0,0 +1,84 @@
+#include "ocean_model_interfaces/util/BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace ocean_model_interfaces;
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() {}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(const std::vector<Box>& boxes)
+{
+    if(boxes.empty())
+    {
+        return;
+    }
+
+    indices.resize(boxes.size());
+    for(unsigned int i = 0; i < boxes.size(); i++)
+    {
+        indices[i] = i;
+    }
+
+    //A tree with n leaves has at most 2n - 1 nodes
+    nodes.reserve(2 * (boxes.size() / LEAF_SIZE + 1));
+    nodes.push_back(Node());
+    build(boxes, 0, 0, boxes.size());
+
+    leafBoxes.resize(indices.size());
+    for(unsigned int i = 0; i < indices.size(); i++)
+    {
+        leafBoxes[i] = boxes[indices[i]];
+    }
+}
+
+void BoundingVolumeHierarchy::build(const std::vector<Box>& boxes, unsigned int nodeIndex, unsigned int begin, unsigned int end)
+{
+    Box box;
+    box.minX = std::numeric_limits<double>::max();
+    box.minY = std::numeric_limits<double>::max();
+    box.maxX = -std::numeric_limits<double>::max();
+    box.maxY = -std::numeric_limits<double>::max();
+
+    for(unsigned int i = begin; i < end; i++)
+    {
+        const Box& shapeBox = boxes[indices[i]];
+        box.minX = std::min(box.minX, shapeBox.minX);
+        box.minY = std::min(box.minY, shapeBox.minY);
+        box.maxX = std::max(box.maxX, shapeBox.maxX);
+        box.maxY = std::max(box.maxY, shapeBox.maxY);
+    }
+
+    nodes[nodeIndex].box = box;
+
+    if(end - begin <= LEAF_SIZE)
+    {
+        nodes[nodeIndex].first = begin;
+        nodes[nodeIndex].count = end - begin;
+        return;
+    }
+
+    //Split at the median box center along the longest axis
+    bool splitOnX = (box.maxX - box.minX) >= (box.maxY - box.minY);
+    unsigned int middle = begin + (end - begin) / 2;
+    std::nth_element(indices.begin() + begin, indices.begin() + middle, indices.begin() + end,
+                     [&boxes, splitOnX](unsigned int a, unsigned int b)
+                     {
+                         return splitOnX ? boxes[a].minX + boxes[a].maxX < boxes[b].minX + boxes[b].maxX :
+                                           boxes[a].minY + boxes[a].maxY < boxes[b].minY + boxes[b].maxY;
+                     });
+
+    unsigned int leftChild = nodes.size();
+    nodes[nodeIndex].first = leftChild;
+    nodes[nodeIndex].count = 0;
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+
+    build(boxes, leftChild, begin, middle);
+    build(boxes, leftChild + 1, middle, end);
+}
+
+unsigned int BoundingVolumeHierarchy::size() const
+{
+    return indices.size();
+}
@@ -0,0 +1,265 @@
+#include "ocean_model_interfaces/util/ChunkStore.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <limits>
+
+#include <unistd.h>
+
+using namespace ocean_model_interfaces;
+
+/**
+ * Identifies chunk store files and the layout they were written with
+ */
+static const char CHUNK_STORE_MAGIC[8] = {'O', 'M', 'I', 'C', 'H', 'S', 'T', '\0'};
+static const uint64_t CHUNK_STORE_VERSION = 1;
+
+//Variable arrays start on cache line boundaries so reading a chunk never touches a line of its neighbours
+static const size_t CHUNK_STORE_ALIGNMENT = 64;
+
+/**
+ * Reads the header values written by ChunkStoreWriter, checking that each one fits in the file.
+ */
+class ChunkStoreHeaderReader
+{
+public:
+    ChunkStoreHeaderReader(const MappedFile& file) :
+        position(file.data()),
+        end(file.data() + file.size())
+    {}
+
+    uint64_t readValue()
+    {
+        uint64_t value;
+        readBytes(&value, sizeof(value));
+        return value;
+    }
+
+    std::string readString()
+    {
+        uint64_t size = readValue();
+        uint64_t paddedSize = (size + 7) / 8 * 8;
+        if(size > paddedSize || paddedSize > (uint64_t)(end - position))
+        {
+            throw std::runtime_error("Chunk store header is truncated");
+        }
+        std::string value(position, size);
+        position += paddedSize;
+        return value;
+    }
+
+    /**
+     * @return The number of header bytes left in the file
+     */
+    uint64_t remaining() const
+    {
+        return end - position;
+    }
+
+private:
+    void readBytes(void* data, size_t size)
+    {
+        if(size > (size_t)(end - position))
+        {
+            throw std::runtime_error("Chunk store header is truncated");
+        }
+        std::memcpy(data, position, size);
+        position += size;
+    }
+
+    const char* position;
+    const char* end;
+};
+
+ChunkStore::ChunkStore(const std::string& filename) :
+    file(filename)
+{
+    ChunkStoreHeaderReader reader(file);
+
+    char magic[8];
+    uint64_t magicValue = reader.readValue();
+    std::memcpy(magic, &magicValue, sizeof(magic));
+    if(!std::equal(magic, magic + 8, CHUNK_STORE_MAGIC) || reader.readValue() != CHUNK_STORE_VERSION)
+    {
+        throw std::runtime_error(filename + " is not a chunk store");
+    }
+
+    uint64_t indexOffset = reader.readValue();
+    uint64_t chunkCount = reader.readValue();
+    uint64_t variableCount = reader.readValue();
+
+    //Check the counts before anything is sized by them. Every variable name takes at least its length value
+    //and every chunk takes an index entry for each variable.
+    if(variableCount > reader.remaining() / sizeof(uint64_t) || chunkCount > std::numeric_limits<unsigned int>::max() ||
+       (variableCount != 0 && chunkCount > file.size() / sizeof(IndexEntry) / variableCount))
+    {
+        throw std::runtime_error("Chunk store " + filename + " is truncated");
+    }
+    numChunks = chunkCount;
+    variables.resize(variableCount);
+    key = reader.readString();
+    for(std::string& variable : variables)
+    {
+        variable = reader.readString();
+    }
+
+    uint64_t indexSize = (uint64_t)numChunks * variables.size() * sizeof(IndexEntry);
+    if(indexOffset % 8 != 0 || indexOffset > file.size() || indexSize > file.size() - indexOffset)
+    {
+        throw std::runtime_error("Chunk store " + filename + " is truncated");
+    }
+    index = reinterpret_cast<const IndexEntry*>(file.data() + indexOffset);
+
+    //Check every entry once so reading a chunk never has to. A chunk is written with all of its variables or
+    //none of them, and hasChunk only looks at the first.
+    for(uint64_t chunk = 0; chunk < numChunks; chunk++)
+    {
+        const IndexEntry* entries = index + chunk * variables.size();
+        bool written = !variables.empty() && entries[0].offset != 0;
+        for(size_t i = 0; i < variables.size(); i++)
+        {
+            const IndexEntry& entry = entries[i];
+            bool valid = written ? entry.offset != 0 && entry.offset % sizeof(float) == 0 && entry.offset <= indexOffset &&
+                                   entry.count <= (indexOffset - entry.offset) / sizeof(float)
+                                 : entry.offset == 0 && entry.count == 0;
+            if(!valid)
+            {
+                throw std::runtime_error("Chunk store " + filename + " has an invalid index");
+            }
+        }
+    }
+}
+
+const std::string& ChunkStore::getKey() const
+{
+    return key;
+}
+
+const std::vector<std::string>& ChunkStore::getVariables() const
+{
+    return variables;
+}
+
+unsigned int ChunkStore::getNumChunks() const
+{
+    return numChunks;
+}
+
+bool ChunkStore::hasChunk(unsigned int chunkId) const
+{
+    //Data never starts at offset 0 since that is the header, so 0 marks a chunk that was not written
+    return chunkId < numChunks && !variables.empty() && index[(size_t)chunkId * variables.size()].offset != 0;
+}
+
+const float* ChunkStore::getValues(unsigned int chunkId, unsigned int variable, size_t& count) const
+{
+    const IndexEntry& entry = getIndexEntry(chunkId, variable);
+    count = entry.count;
+    return reinterpret_cast<const float*>(file.data() + entry.offset);
+}
+
+const ChunkStore::IndexEntry& ChunkStore::getIndexEntry(unsigned int chunkId, unsigned int variable) const
+{
+    if(!hasChunk(chunkId) || variable >= variables.size())
+    {
+        throw std::out_of_range("Chunk " + std::to_string(chunkId) + " is not in the chunk store");
+    }
+    return index[(size_t)chunkId * variables.size() + variable];
+}
+
+ChunkStoreWriter::ChunkStoreWriter(const std::string& filename, const std::string& key, const std::vector<std::string>& variables, unsigned int numChunks) :
+    filename(filename),
+    temporaryFile(filename + "." + std::to_string(getpid()) + ".tmp"),
+    out(temporaryFile, std::ios::binary | std::ios::trunc),
+    position(0),
+    variableCount(variables.size()),
+    index((size_t)numChunks * variables.size() * 2, 0),
+    finished(false)
+{
+    if(!out)
+    {
+        throw std::runtime_error("Could not write chunk store " + temporaryFile);
+    }
+
+    uint64_t magicValue;
+    std::memcpy(&magicValue, CHUNK_STORE_MAGIC, sizeof(magicValue));
+
+    uint64_t header[] = {magicValue, CHUNK_STORE_VERSION, 0, numChunks, variables.size()};
+    indexOffsetPosition = 2 * sizeof(uint64_t);
+    writeBytes(header, sizeof(header));
+
+    writeString(key);
+    for(const std::string& variable : variables)
+    {
+        writeString(variable);
+    }
+}
+
+ChunkStoreWriter::~ChunkStoreWriter()
+{
+    if(!finished)
+    {
+        out.close();
+        std::remove(temporaryFile.c_str());
+    }
+}
+
+void ChunkStoreWriter::writeChunk(unsigned int chunkId, const std::vector<const float*>& values, const std::vector<size_t>& counts)
+{
+    if((size_t)chunkId * variableCount * 2 >= index.size() || values.size() != variableCount || counts.size() != variableCount)
+    {
+        throw std::runtime_error("Chunk " + std::to_string(chunkId) + " does not match the chunk store layout");
+    }
+
+    for(size_t i = 0; i < variableCount; i++)
+    {
+        pad(CHUNK_STORE_ALIGNMENT);
+
+        index[((size_t)chunkId * variableCount + i) * 2] = position;
+        index[((size_t)chunkId * variableCount + i) * 2 + 1] = counts[i];
+        writeBytes(values[i], counts[i] * sizeof(float));
+    }
+}
+
+void ChunkStoreWriter::finish()
+{
+    pad(sizeof(uint64_t));
+    uint64_t indexOffset = position;
+    writeBytes(index.data(), index.size() * sizeof(uint64_t));
+
+    out.seekp(indexOffsetPosition);
+    out.write(reinterpret_cast<const char*>(&indexOffset), sizeof(indexOffset));
+    out.close();
+
+    if(!out || std::rename(temporaryFile.c_str(), filename.c_str()) != 0)
+    {
+        throw std::runtime_error("Could not write chunk store " + filename);
+    }
+    finished = true;
+}
+
+void ChunkStoreWriter::writeBytes(const void* data, size_t size)
+{
+    out.write(static_cast<const char*>(data), size);
+    if(!out)
+    {
+        throw std::runtime_error("Could not write chunk store " + temporaryFile);
+    }
+    position += size;
+}
+
+void ChunkStoreWriter::writeString(const std::string& value)
+{
+    uint64_t size = value.size();
+    writeBytes(&size, sizeof(size));
+    writeBytes(value.data(), value.size());
+    pad(sizeof(uint64_t));
+}
+
+void ChunkStoreWriter::pad(size_t alignment)
+{
+    static const char padding[CHUNK_STORE_ALIGNMENT] = {};
+    writeBytes(padding, (alignment - position % alignment) % alignment);
+}
@@ -0,0 +1,116 @@
+#include "ocean_model_interfaces/util/KDTree.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace ocean_model_interfaces;
+
+KDTree::KDTree() {}
+
+KDTree::KDTree(const std::vector<Point>& points)
+{
+    indices.resize(points.size());
+    for(unsigned int i = 0; i < points.size(); i++)
+    {
+        indices[i] = i;
+    }
+
+    build(points, 0, indices.size(), 0);
+
+    //Store the coordinates in tree order so queries walk through contiguous memory
+    xs.resize(indices.size());
+    ys.resize(indices.size());
+    for(unsigned int i = 0; i < indices.size(); i++)
+    {
+        xs[i] = points[indices[i]].x;
+        ys[i] = points[indices[i]].y;
+    }
+}
+
+void KDTree::build(const std::vector<Point>& points, unsigned int begin, unsigned int end, unsigned int depth)
+{
+    if(end - begin <= LEAF_SIZE)
+    {
+        return;
+    }
+
+    unsigned int middle = begin + (end - begin) / 2;
+    bool splitOnX = depth % 2 == 0;
+
+    //Partition so everything before middle is <= the splitting point and everything after is >=
+    std::nth_element(indices.begin() + begin, indices.begin() + middle, indices.begin() + end,
+                     [&points, splitOnX](unsigned int a, unsigned int b)
+                     {
+                         return splitOnX ? points[a].x < points[b].x : points[a].y < points[b].y;
+                     });
+
+    build(points, begin, middle, depth + 1);
+    build(points, middle + 1, end, depth + 1);
+}
+
+int KDTree::nearest(const Point& testPoint) const
+{
+    int bestIndex = -1;
+    double bestDistance = std::numeric_limits<double>::max();
+
+    if(!indices.empty())
+    {
+        nearest(0, indices.size(), 0, testPoint.x, testPoint.y, bestIndex, bestDistance);
+    }
+
+    return bestIndex;
+}
+
+unsigned int KDTree::size() const
+{
+    return indices.size();
+}
+
+void KDTree::checkPoint(unsigned int treeIndex, double x, double y, int& bestIndex, double& bestDistance) const
+{
+    double distance = (x - xs[treeIndex]) * (x - xs[treeIndex]) + (y - ys[treeIndex]) * (y - ys[treeIndex]);
+    int index = indices[treeIndex];
+
+    if(distance < bestDistance || (distance == bestDistance && index < bestIndex))
+    {
+        bestDistance = distance;
+        bestIndex = index;
+    }
+}
+
+void KDTree::nearest(unsigned int begin, unsigned int end, unsigned int depth, double x, double y, int& bestIndex, double& bestDistance) const
+{
+    if(end - begin <= LEAF_SIZE)
+    {
+        for(unsigned int i = begin; i < end; i++)
+        {
+            checkPoint(i, x, y, bestIndex, bestDistance);
+        }
+        return;
+    }
+
+    unsigned int middle = begin + (end - begin) / 2;
+    checkPoint(middle, x, y, bestIndex, bestDistance);
+
+    double difference = (depth % 2 == 0) ? x - xs[middle] : y - ys[middle];
+
+    //Search the side of the split that contains the point first, then only search the other
+    //side if the splitting line is closer than the best point found so far. Points equal to the
+    //split can be on either side, so equal distances must also be searched.
+    if(difference < 0)
+    {
+        nearest(begin, middle, depth + 1, x, y, bestIndex, bestDistance);
+        if(difference * difference <= bestDistance)
+        {
+            nearest(middle + 1, end, depth + 1, x, y, bestIndex, bestDistance);
+        }
+    }
+    else
+    {
+        nearest(middle + 1, end, depth + 1, x, y, bestIndex, bestDistance);
+        if(difference * difference <= bestDistance)
+        {
+            nearest(begin, middle, depth + 1, x, y, bestIndex, bestDistance);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include "ocean_model_interfaces/util/MappedFile.h"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace ocean_model_interfaces;
+
+MappedFile::MappedFile() :
+    mapping(nullptr),
+    length(0)
+{}
+
+MappedFile::MappedFile(const std::string& filename) :
+    mapping(nullptr),
+    length(0)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        throw std::runtime_error("Could not open " + filename);
+    }
+
+    struct stat status;
+    if(fstat(fd, &status) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("Could not read the size of " + filename);
+    }
+
+    length = status.st_size;
+
+    //mmap does not accept a length of 0, an empty file is left unmapped
+    if(length > 0)
+    {
+        void* address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if(address == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("Could not map " + filename);
+        }
+        mapping = static_cast<const char*>(address);
+    }
+
+    //The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& other) :
+    mapping(other.mapping),
+    length(other.length)
+{
+    other.mapping = nullptr;
+    other.length = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+    if(&other != this)
+    {
+        unmap();
+        mapping = other.mapping;
+        length = other.length;
+        other.mapping = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+const char* MappedFile::data() const
+{
+    return mapping;
+}
+
+size_t MappedFile::size() const
+{
+    return length;
+}
+
+void MappedFile::unmap()
+{
+    if(mapping != nullptr)
+    {
+        munmap(const_cast<char*>(mapping), length);
+    }
+    mapping = nullptr;
+    length = 0;
+}
@@ -0,0 +1,127 @@
+#include "ocean_model_interfaces/util/MemoryStorageBackend.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+
+using namespace ocean_model_interfaces;
+
+void MemoryStorageBackend::setVariable(const std::string& filename, const std::string& variable, const std::vector<size_t>& shape, std::vector<float> values)
+{
+    size_t size = 1;
+    for(size_t dimension : shape)
+    {
+        size *= dimension;
+    }
+    if(size != values.size())
+    {
+        throw std::runtime_error("The values of " + variable + " do not match its shape");
+    }
+
+    Variable& stored = variables[getKey(filename, variable)];
+    stored.shape = shape;
+    stored.values = std::move(values);
+}
+
+size_t MemoryStorageBackend::getMemoryUsage() const
+{
+    size_t bytes = 0;
+    for(const auto& variable : variables)
+    {
+        bytes += variable.second.values.capacity() * sizeof(float);
+    }
+    return bytes;
+}
+
+bool MemoryStorageBackend::hasVariable(const std::string& filename, const std::string& variable)
+{
+    return variables.find(getKey(filename, variable)) != variables.end();
+}
+
+void MemoryStorageBackend::read(const std::string& filename, const std::string& variable,
+                                const std::vector<size_t>& start, const std::vector<size_t>& count, float* out)
+{
+    readValues(filename, variable, start, count, out);
+}
+
+void MemoryStorageBackend::read(const std::string& filename, const std::string& variable,
+                                const std::vector<size_t>& start, const std::vector<size_t>& count, double* out)
+{
+    readValues(filename, variable, start, count, out);
+}
+
+const MemoryStorageBackend::Variable& MemoryStorageBackend::getVariable(const std::string& filename, const std::string& variable) const
+{
+    auto it = variables.find(getKey(filename, variable));
+    if(it == variables.end())
+    {
+        throw std::runtime_error(filename + " does not have the variable " + variable);
+    }
+    return it->second;
+}
+
+template<typename T>
+void MemoryStorageBackend::readValues(const std::string& filename, const std::string& variable,
+                                      const std::vector<size_t>& start, const std::vector<size_t>& count, T* out) const
+{
+    const Variable& stored = getVariable(filename, variable);
+    const std::vector<size_t>& shape = stored.shape;
+
+    if(start.size() != shape.size() || count.size() != shape.size())
+    {
+        throw std::runtime_error("Read of " + variable + " has the wrong number of dimensions");
+    }
+    for(size_t i = 0; i < shape.size(); i++)
+    {
+        if(start[i] > shape[i] || count[i] > shape[i] - start[i])
+        {
+            throw std::runtime_error("Read of " + variable + " is outside of the variable");
+        }
+    }
+    if(std::find(count.begin(), count.end(), 0) != count.end())
+    {
+        return;
+    }
+
+    //A scalar variable is a single value
+    if(shape.empty())
+    {
+        out[0] = stored.values[0];
+        return;
+    }
+
+    //Walk every row of the last dimension, position holding the index of the row in each other dimension
+    size_t last = shape.size() - 1;
+    std::vector<size_t> position(start.begin(), start.end());
+    while(true)
+    {
+        size_t offset = 0;
+        for(size_t i = 0; i < shape.size(); i++)
+        {
+            offset = offset * shape[i] + position[i];
+        }
+        out = std::copy(stored.values.begin() + offset, stored.values.begin() + offset + count[last], out);
+
+        //Advance to the next row, carrying into earlier dimensions until one has rows left
+        size_t dimension = last;
+        while(true)
+        {
+            if(dimension == 0)
+            {
+                return;
+            }
+            dimension--;
+            if(++position[dimension] < start[dimension] + count[dimension])
+            {
+                break;
+            }
+            position[dimension] = start[dimension];
+        }
+    }
+}
+
+std::string MemoryStorageBackend::getKey(const std::string& filename, const std::string& variable)
+{
+    //Variable names can not contain a newline, so the key is never ambiguous
+    return filename + "\n" + variable;
+}
@@ -0,0 +1,70 @@
+#include "ocean_model_interfaces/util/NetCDFFilePool.h"
+
+#include <algorithm>
+
+using namespace ocean_model_interfaces;
+
+NetCDFFilePool::NetCDFFilePool(size_t maxOpenFiles) :
+    maxOpenFiles(std::max<size_t>(1, maxOpenFiles))
+{}
+
+netCDF::NcFile& NetCDFFilePool::getFile(const std::string& filename)
+{
+    return *open(filename).file;
+}
+
+netCDF::NcVar NetCDFFilePool::getVar(const std::string& filename, const std::string& varName)
+{
+    OpenFile& openFile = open(filename);
+
+    auto it = openFile.vars.find(varName);
+    if(it == openFile.vars.end())
+    {
+        it = openFile.vars.insert(std::make_pair(varName, openFile.file->getVar(varName))).first;
+    }
+
+    return it->second;
+}
+
+void NetCDFFilePool::closeAll()
+{
+    //Destroying the NcFile objects closes the files
+    openFiles.clear();
+    recentlyUsed.clear();
+}
+
+size_t NetCDFFilePool::getOpenFileCount() const
+{
+    return openFiles.size();
+}
+
+size_t NetCDFFilePool::getMaxOpenFiles() const
+{
+    return maxOpenFiles;
+}
+
+NetCDFFilePool::OpenFile& NetCDFFilePool::open(const std::string& filename)
+{
+    auto it = openFiles.find(filename);
+    if(it != openFiles.end())
+    {
+        recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, it->second.usePosition);
+        return it->second;
+    }
+
+    //Open the file before closing anything so a file that fails to open leaves the pool unchanged
+    std::unique_ptr<netCDF::NcFile> file(new netCDF::NcFile(filename, netCDF::NcFile::read));
+
+    if(openFiles.size() >= maxOpenFiles)
+    {
+        openFiles.erase(recentlyUsed.back());
+        recentlyUsed.pop_back();
+    }
+
+    recentlyUsed.push_front(filename);
+
+    OpenFile& openFile = openFiles[filename];
+    openFile.file = std::move(file);
+    openFile.usePosition = recentlyUsed.begin();
+    return openFile;
+}
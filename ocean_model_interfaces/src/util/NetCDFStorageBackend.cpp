@@ -0,0 +1,43 @@
+#include "ocean_model_interfaces/util/NetCDFStorageBackend.h"
+#include "ocean_model_interfaces/util/NetCDFMutex.h"
+
+#include <stdexcept>
+#include <mutex>
+
+using namespace ocean_model_interfaces;
+
+NetCDFStorageBackend::NetCDFStorageBackend(std::shared_ptr<NetCDFFilePool> filePool) :
+    filePool(filePool)
+{}
+
+bool NetCDFStorageBackend::hasVariable(const std::string& filename, const std::string& variable)
+{
+    std::lock_guard<std::mutex> lock(getNetCDFMutex());
+    return !filePool->getVar(filename, variable).isNull();
+}
+
+void NetCDFStorageBackend::read(const std::string& filename, const std::string& variable,
+                                const std::vector<size_t>& start, const std::vector<size_t>& count, float* out)
+{
+    readValues(filename, variable, start, count, out);
+}
+
+void NetCDFStorageBackend::read(const std::string& filename, const std::string& variable,
+                                const std::vector<size_t>& start, const std::vector<size_t>& count, double* out)
+{
+    readValues(filename, variable, start, count, out);
+}
+
+template<typename T>
+void NetCDFStorageBackend::readValues(const std::string& filename, const std::string& variable,
+                                      const std::vector<size_t>& start, const std::vector<size_t>& count, T* out)
+{
+    std::lock_guard<std::mutex> lock(getNetCDFMutex());
+
+    netCDF::NcVar var = filePool->getVar(filename, variable);
+    if(var.isNull())
+    {
+        throw std::runtime_error(filename + " does not have the variable " + variable);
+    }
+    var.getVar(start, count, out);
+}
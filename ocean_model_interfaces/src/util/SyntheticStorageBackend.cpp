@@ -0,0 +1,163 @@
+#include "ocean_model_interfaces/util/SyntheticStorageBackend.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+using namespace ocean_model_interfaces;
+
+/**
+ * @return A value in [-1, 1] that looks random but is always the same for the same index
+ */
+static double hashNoise(uint64_t variable, uint64_t time, uint64_t layer, uint64_t element)
+{
+    //splitmix64 finalizer over the combined index
+    uint64_t h = element * 0x9E3779B97F4A7C15ull ^ (layer << 48) ^ (time << 20) ^ (variable << 58);
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return (h >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+SyntheticStorageBackend::SyntheticStorageBackend(const std::vector<File>& files, const std::vector<Variable>& variables) :
+    files(files),
+    variables(variables)
+{
+    size_t startTime = 0;
+    for(size_t i = 0; i < files.size(); i++)
+    {
+        fileStartTimes.push_back(startTime);
+        fileIndices[files[i].filename] = i;
+        startTime += files[i].timeSteps;
+    }
+    for(unsigned int i = 0; i < variables.size(); i++)
+    {
+        if(variables[i].shape.empty())
+        {
+            throw std::runtime_error("Synthetic variable " + variables[i].name + " needs a layer dimension");
+        }
+        variableIndices[variables[i].name] = i;
+    }
+}
+
+float SyntheticStorageBackend::getValue(unsigned int variable, size_t time, size_t layer, size_t element) const
+{
+    const Variable& v = variables[variable];
+
+    //Smooth along the elements and through time so interpolation sees gradients, with a little noise
+    //so no two neighbouring values are the same
+    double spatial = std::sin(element * 0.0007 + variable);
+    double temporal = std::sin(time * 0.26 + layer * 0.5 + variable);
+    double noise = hashNoise(variable, time, layer, element);
+
+    return static_cast<float>(v.mean + v.amplitude * (0.6 * spatial + 0.3 * temporal + 0.1 * noise));
+}
+
+bool SyntheticStorageBackend::hasVariable(const std::string& filename, const std::string& variable)
+{
+    return findFile(filename) != files.size() && variableIndices.find(variable) != variableIndices.end();
+}
+
+void SyntheticStorageBackend::read(const std::string& filename, const std::string& variable,
+                                   const std::vector<size_t>& start, const std::vector<size_t>& count, float* out)
+{
+    readValues(filename, variable, start, count, out);
+}
+
+void SyntheticStorageBackend::read(const std::string& filename, const std::string& variable,
+                                   const std::vector<size_t>& start, const std::vector<size_t>& count, double* out)
+{
+    readValues(filename, variable, start, count, out);
+}
+
+template<typename T>
+void SyntheticStorageBackend::readValues(const std::string& filename, const std::string& variable,
+                                         const std::vector<size_t>& start, const std::vector<size_t>& count, T* out) const
+{
+    size_t file = findFile(filename);
+    auto variableIt = variableIndices.find(variable);
+    if(file == files.size() || variableIt == variableIndices.end())
+    {
+        throw std::runtime_error(filename + " does not have the variable " + variable);
+    }
+    unsigned int v = variableIt->second;
+
+    //Full shape of the variable in this file, time first
+    std::vector<size_t> shape = variables[v].shape;
+    shape.insert(shape.begin(), files[file].timeSteps);
+
+    if(start.size() != shape.size() || count.size() != shape.size())
+    {
+        throw std::runtime_error("Read of " + variable + " has the wrong number of dimensions");
+    }
+    for(size_t i = 0; i < shape.size(); i++)
+    {
+        if(start[i] > shape[i] || count[i] > shape[i] - start[i])
+        {
+            throw std::runtime_error("Read of " + variable + " is outside of the variable");
+        }
+    }
+    if(std::find(count.begin(), count.end(), 0) != count.end())
+    {
+        return;
+    }
+
+    //Walk every row of the last dimension, position holding the index of the row in each other dimension
+    size_t last = shape.size() - 1;
+    std::vector<size_t> position(start.begin(), start.end());
+    while(true)
+    {
+        size_t time = fileStartTimes[file] + position[0];
+        size_t layer = position[1];
+        size_t element = 0;
+        for(size_t i = 2; i < shape.size(); i++)
+        {
+            element = element * shape[i] + position[i];
+        }
+
+        //A variable with only time and layer dimensions has a single element
+        if(last == 1)
+        {
+            for(size_t i = 0; i < count[1]; i++)
+            {
+                *out++ = getValue(v, time, layer + i, 0);
+            }
+        }
+        else
+        {
+            for(size_t i = 0; i < count[last]; i++)
+            {
+                *out++ = getValue(v, time, layer, element + i);
+            }
+        }
+
+        //Advance to the next row, carrying into earlier dimensions until one has rows left
+        size_t dimension = last;
+        while(true)
+        {
+            if(dimension == 0)
+            {
+                return;
+            }
+            dimension--;
+            if(++position[dimension] < start[dimension] + count[dimension])
+            {
+                break;
+            }
+            position[dimension] = start[dimension];
+        }
+    }
+}
+
+size_t SyntheticStorageBackend::findFile(const std::string& filename) const
+{
+    auto it = fileIndices.find(fs::path(filename).filename().string());
+    return it == fileIndices.end() ? files.size() : it->second;
+}
@@ -0,0 +1,154 @@
+#include "ocean_model_interfaces/util/WorkStealingScheduler.h"
+
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+using namespace ocean_model_interfaces;
+
+WorkStealingScheduler::WorkStealingScheduler(unsigned int threadCount) :
+    threadCount(std::max(1u, threadCount))
+{
+    for(unsigned int i = 0; i < this->threadCount; i++)
+    {
+        ranges.push_back(std::unique_ptr<TaskRange>(new TaskRange()));
+    }
+}
+
+unsigned int WorkStealingScheduler::getThreadCount() const
+{
+    return threadCount;
+}
+
+void WorkStealingScheduler::run(size_t taskCount, const std::function<void(size_t task, unsigned int worker)>& task)
+{
+    unsigned int workers = std::min<size_t>(threadCount, taskCount);
+
+    //No need to start any threads if there is only one worker
+    if(workers <= 1)
+    {
+        for(size_t i = 0; i < taskCount; i++)
+        {
+            task(i, 0);
+        }
+        return;
+    }
+
+    //Split the tasks into contiguous ranges, giving the remainder to the first workers
+    size_t begin = 0;
+    for(unsigned int i = 0; i < threadCount; i++)
+    {
+        size_t count = i < workers ? taskCount / workers + (i < taskCount % workers ? 1 : 0) : 0;
+        ranges[i]->begin = begin;
+        ranges[i]->end = begin + count;
+        begin += count;
+    }
+
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    std::atomic<bool> failed(false);
+
+    //Stop handing out tasks after the first exception and remember it so it can be rethrown
+    std::function<void(size_t, unsigned int)> guardedTask = [&](size_t i, unsigned int worker) {
+        if(failed)
+        {
+            return;
+        }
+
+        try
+        {
+            task(i, worker);
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if(!error)
+            {
+                error = std::current_exception();
+            }
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned int i = 1; i < workers; i++)
+    {
+        threads.push_back(std::thread(&WorkStealingScheduler::work, this, i, std::cref(guardedTask)));
+    }
+
+    work(0, guardedTask);
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkStealingScheduler::work(unsigned int worker, const std::function<void(size_t, unsigned int)>& task)
+{
+    size_t next;
+    while(true)
+    {
+        if(popTask(worker, next))
+        {
+            task(next, worker);
+        }
+        else if(!stealTasks(worker))
+        {
+            //Tasks are never added after run starts, so once every range is empty this worker is done
+            return;
+        }
+    }
+}
+
+bool WorkStealingScheduler::popTask(unsigned int worker, size_t& task)
+{
+    TaskRange& range = *ranges[worker];
+    std::lock_guard<std::mutex> lock(range.mutex);
+
+    if(range.begin >= range.end)
+    {
+        return false;
+    }
+
+    task = range.begin++;
+    return true;
+}
+
+bool WorkStealingScheduler::stealTasks(unsigned int worker)
+{
+    for(unsigned int offset = 1; offset < threadCount; offset++)
+    {
+        TaskRange& victim = *ranges[(worker + offset) % threadCount];
+
+        size_t stolenBegin;
+        size_t stolenEnd;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if(victim.begin >= victim.end)
+            {
+                continue;
+            }
+
+            //Take the back half, leaving the victim the tasks next to the ones it is working on
+            size_t stolen = (victim.end - victim.begin + 1) / 2;
+            stolenEnd = victim.end;
+            stolenBegin = victim.end - stolen;
+            victim.end = stolenBegin;
+        }
+
+        TaskRange& own = *ranges[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = stolenBegin;
+        own.end = stolenEnd;
+        return true;
+    }
+
+    return false;
+}
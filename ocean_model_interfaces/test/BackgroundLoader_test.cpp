@@ -0,0 +1,114 @@
+#include "ocean_model_interfaces/util/BackgroundLoader.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+
+using namespace ocean_model_interfaces;
+
+TEST(BackgroundLoaderTest, RunsLoads) {
+    BackgroundLoader loader;
+    std::atomic<int> count(0);
+
+    for(unsigned int i = 0; i < 10; i++) {
+        EXPECT_TRUE(loader.enqueue(i, [&count]() { count++; }));
+    }
+
+    loader.wait();
+    EXPECT_EQ(10, count);
+    EXPECT_EQ(0, loader.pending());
+}
+
+TEST(BackgroundLoaderTest, DuplicateKeys) {
+    BackgroundLoader loader;
+    std::atomic<bool> release(false);
+    std::atomic<int> count(0);
+
+    //Block the thread so the following loads stay queued
+    loader.enqueue(0, [&release]() { while(!release) { std::this_thread::yield(); } });
+    EXPECT_TRUE(loader.enqueue(1, [&count]() { count++; }));
+    EXPECT_FALSE(loader.enqueue(1, [&count]() { count++; }));
+
+    release = true;
+    loader.wait();
+    EXPECT_EQ(1, count);
+}
+
+TEST(BackgroundLoaderTest, WaitForQueuedLoad) {
+    BackgroundLoader loader;
+    std::atomic<bool> release(false);
+    std::atomic<int> count(0);
+
+    loader.enqueue(0, [&release]() { while(!release) { std::this_thread::yield(); } });
+    loader.enqueue(1, [&count]() { count++; });
+
+    //A queued load is removed so the caller can load it itself
+    EXPECT_FALSE(loader.waitFor(1));
+    EXPECT_FALSE(loader.waitFor(2));
+
+    release = true;
+    loader.wait();
+    EXPECT_EQ(0, count);
+}
+
+TEST(BackgroundLoaderTest, WaitForRunningLoad) {
+    BackgroundLoader loader;
+    std::atomic<bool> started(false);
+    std::atomic<bool> finished(false);
+
+    loader.enqueue(5, [&started, &finished]() {
+        started = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        finished = true;
+    });
+
+    while(!started) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_TRUE(loader.waitFor(5));
+    EXPECT_TRUE(finished);
+}
+
+TEST(BackgroundLoaderTest, IgnoresExceptions) {
+    BackgroundLoader loader;
+    std::atomic<int> count(0);
+
+    loader.enqueue(0, []() { throw std::runtime_error("load failed"); });
+    loader.enqueue(1, [&count]() { count++; });
+
+    loader.wait();
+    EXPECT_EQ(1, count);
+}
+
+TEST(BackgroundLoaderTest, StopAndRestart) {
+    BackgroundLoader loader;
+    std::atomic<bool> release(false);
+    std::atomic<int> count(0);
+
+    loader.enqueue(0, [&release]() { while(!release) { std::this_thread::yield(); } });
+    loader.enqueue(1, [&count]() { count++; });
+
+    std::thread releaser([&release]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        release = true;
+    });
+
+    //Queued loads are dropped
+    loader.stop();
+    releaser.join();
+    EXPECT_EQ(0, count);
+    EXPECT_EQ(0, loader.pending());
+
+    loader.enqueue(1, [&count]() { count++; });
+    loader.wait();
+    EXPECT_EQ(1, count);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,63 @@
+#include "ocean_model_interfaces/util/BoundingVolumeHierarchy.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using namespace ocean_model_interfaces;
+
+TEST(BoundingVolumeHierarchyTest, EmptyHierarchy)
+{
+    BoundingVolumeHierarchy bvh;
+    EXPECT_EQ(bvh.size(), 0);
+    EXPECT_EQ(bvh.findLowest(0, 0, [](int) { return true; }), -1);
+}
+
+TEST(BoundingVolumeHierarchyTest, MatchesBruteForce)
+{
+    std::mt19937 generator(4321);
+    std::uniform_real_distribution<double> position(-1000, 1000);
+    std::uniform_real_distribution<double> size(0, 50);
+
+    std::vector<BoundingVolumeHierarchy::Box> boxes;
+    for(unsigned int i = 0; i < 3000; i++)
+    {
+        BoundingVolumeHierarchy::Box box;
+        box.minX = position(generator);
+        box.minY = position(generator);
+        box.maxX = box.minX + size(generator);
+        box.maxY = box.minY + size(generator);
+        boxes.push_back(box);
+    }
+
+    BoundingVolumeHierarchy bvh(boxes);
+    EXPECT_EQ(bvh.size(), boxes.size());
+
+    std::uniform_real_distribution<double> queryPosition(-1200, 1200);
+    for(unsigned int i = 0; i < 2000; i++)
+    {
+        double x = queryPosition(generator);
+        double y = queryPosition(generator);
+
+        //Only accept odd shapes so the test function is used and not just the boxes
+        auto test = [](int shape) { return shape % 2 == 1; };
+
+        int expected = -1;
+        for(unsigned int j = 0; j < boxes.size(); j++)
+        {
+            if(boxes[j].contains(x, y) && test(j))
+            {
+                expected = j;
+                break;
+            }
+        }
+
+        EXPECT_EQ(bvh.findLowest(x, y, test), expected);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
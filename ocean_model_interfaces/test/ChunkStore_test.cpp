@@ -0,0 +1,172 @@
+#include "ocean_model_interfaces/util/ChunkStore.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace ocean_model_interfaces;
+
+static const std::string TEST_FILE = "./ChunkStore_test.bin";
+
+TEST(ChunkStoreTest, ReadsWrittenChunks) {
+    std::vector<std::string> variables = {"temp", "u"};
+    std::vector<float> temp0 = {1, 2, 3};
+    std::vector<float> u0 = {4, 5};
+    std::vector<float> temp2 = {6};
+    std::vector<float> u2;
+
+    {
+        ChunkStoreWriter writer(TEST_FILE, "layout", variables, 3);
+        writer.writeChunk(2, {temp2.data(), u2.data()}, {temp2.size(), u2.size()});
+        writer.writeChunk(0, {temp0.data(), u0.data()}, {temp0.size(), u0.size()});
+        writer.finish();
+    }
+
+    ChunkStore store(TEST_FILE);
+    EXPECT_EQ("layout", store.getKey());
+    EXPECT_EQ(variables, store.getVariables());
+    EXPECT_EQ(3, store.getNumChunks());
+    EXPECT_TRUE(store.hasChunk(0));
+    EXPECT_FALSE(store.hasChunk(1));
+    EXPECT_TRUE(store.hasChunk(2));
+    EXPECT_FALSE(store.hasChunk(3));
+
+    size_t count;
+    const float* values = store.getValues(0, 0, count);
+    EXPECT_EQ(temp0, std::vector<float>(values, values + count));
+    values = store.getValues(0, 1, count);
+    EXPECT_EQ(u0, std::vector<float>(values, values + count));
+    values = store.getValues(2, 0, count);
+    EXPECT_EQ(temp2, std::vector<float>(values, values + count));
+    store.getValues(2, 1, count);
+    EXPECT_EQ(0, count);
+
+    //Every variable starts on a cache line
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(store.getValues(0, 1, count)) % 64);
+
+    EXPECT_THROW(store.getValues(1, 0, count), std::out_of_range);
+    EXPECT_THROW(store.getValues(0, 2, count), std::out_of_range);
+
+    std::remove(TEST_FILE.c_str());
+}
+
+TEST(ChunkStoreTest, UnfinishedStoreIsNotWritten) {
+    std::remove(TEST_FILE.c_str());
+    {
+        std::vector<float> values = {1};
+        ChunkStoreWriter writer(TEST_FILE, "layout", {"temp"}, 1);
+        writer.writeChunk(0, {values.data()}, {values.size()});
+        EXPECT_THROW(writer.writeChunk(1, {values.data()}, {values.size()}), std::runtime_error);
+    }
+
+    EXPECT_FALSE(std::ifstream(TEST_FILE).good());
+}
+
+TEST(ChunkStoreTest, InvalidFiles) {
+    {
+        std::ofstream out(TEST_FILE, std::ios::binary);
+        out << "not a chunk store";
+    }
+    EXPECT_THROW(ChunkStore store(TEST_FILE), std::runtime_error);
+
+    //A store cut off before its index is rejected when it is opened
+    {
+        std::vector<float> values(100, 1.0f);
+        ChunkStoreWriter writer(TEST_FILE, "layout", {"temp"}, 1);
+        writer.writeChunk(0, {values.data()}, {values.size()});
+        writer.finish();
+    }
+    std::string contents;
+    {
+        std::ifstream in(TEST_FILE, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(TEST_FILE, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), contents.size() - 8);
+    }
+    EXPECT_THROW(ChunkStore store(TEST_FILE), std::runtime_error);
+
+    //Counts in the header that do not fit in the file are rejected before anything is sized by them
+    auto writeWithCount = [&contents](size_t position, uint64_t count) {
+        std::string corrupted = contents;
+        corrupted.replace(position, sizeof(count), reinterpret_cast<const char*>(&count), sizeof(count));
+        std::ofstream out(TEST_FILE, std::ios::binary | std::ios::trunc);
+        out.write(corrupted.data(), corrupted.size());
+    };
+    const size_t numChunksPosition = 24;
+    const size_t numVariablesPosition = 32;
+    for(uint64_t count : {(uint64_t)1 << 40, (uint64_t)1 << 61, std::numeric_limits<uint64_t>::max()}) {
+        writeWithCount(numVariablesPosition, count);
+        EXPECT_THROW(ChunkStore store(TEST_FILE), std::runtime_error);
+    }
+    for(uint64_t count : {((uint64_t)1 << 32) + 1, (uint64_t)1 << 30, std::numeric_limits<uint64_t>::max()}) {
+        writeWithCount(numChunksPosition, count);
+        EXPECT_THROW(ChunkStore store(TEST_FILE), std::runtime_error);
+    }
+
+    //The unchanged store still opens
+    writeWithCount(numChunksPosition, 1);
+    EXPECT_EQ(1u, ChunkStore(TEST_FILE).getNumChunks());
+
+    std::remove(TEST_FILE.c_str());
+    EXPECT_THROW(ChunkStore store(TEST_FILE), std::runtime_error);
+}
+
+TEST(ChunkStoreTest, InvalidIndex) {
+    std::vector<float> temp = {1, 2, 3};
+    std::vector<float> u = {4, 5};
+    {
+        ChunkStoreWriter writer(TEST_FILE, "layout", {"temp", "u"}, 2);
+        writer.writeChunk(0, {temp.data(), u.data()}, {temp.size(), u.size()});
+        writer.finish();
+    }
+    std::string contents;
+    {
+        std::ifstream in(TEST_FILE, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    //Each index entry is an offset and a count, ordered by chunk and then variable
+    uint64_t indexOffset;
+    std::memcpy(&indexOffset, contents.data() + 16, sizeof(indexOffset));
+    uint64_t writtenOffset;
+    std::memcpy(&writtenOffset, contents.data() + indexOffset + 16, sizeof(writtenOffset));
+    auto writeWithEntry = [&](size_t chunk, size_t variable, uint64_t offset, uint64_t count) {
+        std::string corrupted = contents;
+        size_t position = indexOffset + (chunk * 2 + variable) * 16;
+        corrupted.replace(position, sizeof(offset), reinterpret_cast<const char*>(&offset), sizeof(offset));
+        corrupted.replace(position + 8, sizeof(count), reinterpret_cast<const char*>(&count), sizeof(count));
+        std::ofstream out(TEST_FILE, std::ios::binary | std::ios::trunc);
+        out.write(corrupted.data(), corrupted.size());
+    };
+
+    //A variable of a written chunk that points at the header
+    writeWithEntry(0, 1, 0, (uint64_t)1 << 40);
+    EXPECT_THROW(ChunkStore store(TEST_FILE), std::runtime_error);
+
+    //A chunk with only some of its variables
+    writeWithEntry(1, 1, writtenOffset, 1);
+    EXPECT_THROW(ChunkStore store(TEST_FILE), std::runtime_error);
+
+    //A missing chunk with values
+    writeWithEntry(1, 0, 0, 3);
+    EXPECT_THROW(ChunkStore store(TEST_FILE), std::runtime_error);
+
+    writeWithEntry(1, 0, 0, 0);
+    EXPECT_FALSE(ChunkStore(TEST_FILE).hasChunk(1));
+
+    std::remove(TEST_FILE.c_str());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,263 @@
+#include "ocean_model_interfaces/util/ConcurrentCache.h"
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+using namespace ocean_model_interfaces;
+
+//Counts copies so tests can check that values are moved into the cache
+struct CopyCounter {
+    static int copies;
+
+    CopyCounter(int value = 0) : value(value) {}
+    CopyCounter(const CopyCounter& other) : value(other.value) { copies++; }
+    CopyCounter(CopyCounter&& other) = default;
+
+    int value;
+};
+
+int CopyCounter::copies = 0;
+
+TEST(ConcurrentCacheTest, SimplePut) {
+    ConcurrentCache<int, int> cache(1);
+    cache.put(7, 777);
+    EXPECT_TRUE(cache.exists(7));
+    EXPECT_EQ(777, cache.get(7));
+    EXPECT_EQ(1, cache.size());
+}
+
+TEST(ConcurrentCacheTest, MissingValue) {
+    ConcurrentCache<int, int> cache(1);
+    EXPECT_THROW(cache.get(7), std::range_error);
+    EXPECT_FALSE(cache.visit(7, [](int&) {}));
+}
+
+TEST(ConcurrentCacheTest, ReplaceValue) {
+    ConcurrentCache<int, int> cache(4);
+    cache.put(1, 10);
+    cache.put(1, 20);
+    EXPECT_EQ(20, cache.get(1));
+    EXPECT_EQ(1, cache.size());
+}
+
+TEST(ConcurrentCacheTest, KeepsAllValuesWithinCapacity) {
+    const int capacity = 50;
+    ConcurrentCache<int, int> cache(capacity);
+
+    for(int i = 0; i < 1000; i++) {
+        cache.put(i, i * 2);
+        EXPECT_LE(cache.size(), capacity);
+    }
+
+    EXPECT_EQ(capacity, cache.size());
+    EXPECT_EQ(capacity, cache.capacity());
+
+    //Every remaining value must still be correct
+    for(int i = 0; i < 1000; i++) {
+        int value = -1;
+        if(cache.visit(i, [&value](int& v) { value = v; })) {
+            EXPECT_EQ(i * 2, value);
+        }
+    }
+}
+
+TEST(ConcurrentCacheTest, SmallCachesShareEntries) {
+    //Keys that differ by the capacity do not evict each other
+    ConcurrentCache<unsigned int, int> cache(10);
+    cache.put(0, 0);
+    cache.put(10, 10);
+    EXPECT_TRUE(cache.exists(0));
+    EXPECT_TRUE(cache.exists(10));
+    EXPECT_EQ(2, cache.size());
+}
+
+TEST(ConcurrentCacheTest, SpreadsStridedKeys) {
+    //Keys that are all a multiple of the shard count still spread across the shards
+    ConcurrentCache<unsigned int, int> cache(64);
+    for(unsigned int i = 0; i < 32; i++) {
+        cache.put(i * ConcurrentCache<unsigned int, int>::DEFAULT_SHARD_COUNT, i);
+    }
+    EXPECT_GT(cache.size(), 24);
+}
+
+TEST(ConcurrentCacheTest, SecondChance) {
+    //A single shard so the eviction order is deterministic
+    ConcurrentCache<int, int> cache(3, 1);
+    cache.put(0, 0);
+    cache.put(1, 1);
+    cache.put(2, 2);
+
+    //Referencing 0 gives it a second chance, so 1 is evicted instead
+    cache.get(0);
+    cache.put(3, 3);
+
+    EXPECT_TRUE(cache.exists(0));
+    EXPECT_FALSE(cache.exists(1));
+    EXPECT_TRUE(cache.exists(2));
+    EXPECT_TRUE(cache.exists(3));
+}
+
+TEST(ConcurrentCacheTest, ConcurrentAccess) {
+    ConcurrentCache<int, int> cache(64);
+    std::atomic<int> errors(0);
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 8; t++) {
+        threads.push_back(std::thread([&cache, &errors, t]() {
+            for(int i = 0; i < 20000; i++) {
+                int key = (i * 7 + t * 13) % 200;
+                int value = -1;
+                if(!cache.visit(key, [&value](int& v) { value = v; })) {
+                    cache.put(key, key + 1000);
+                } else if(value != key + 1000) {
+                    errors++;
+                }
+            }
+        }));
+    }
+
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(0, errors);
+    EXPECT_LE(cache.size(), 64);
+}
+
+TEST(ConcurrentCacheTest, MemoryLimit) {
+    //Each value reports itself as its size in bytes
+    ConcurrentCache<int, int> cache(100, [](const int& value) { return (size_t)value; }, 1);
+    cache.setMemoryLimit(100);
+    EXPECT_EQ(100, cache.memoryLimit());
+
+    cache.put(0, 40);
+    cache.put(1, 40);
+    EXPECT_EQ(80, cache.memoryUsage());
+
+    //The oldest entry is evicted to make room
+    cache.put(2, 30);
+    EXPECT_FALSE(cache.exists(0));
+    EXPECT_TRUE(cache.exists(1));
+    EXPECT_TRUE(cache.exists(2));
+    EXPECT_EQ(70, cache.memoryUsage());
+    EXPECT_EQ(80, cache.peakMemoryUsage());
+
+    //Values larger than the limit are not cached
+    cache.put(3, 101);
+    EXPECT_FALSE(cache.exists(3));
+    EXPECT_EQ(70, cache.memoryUsage());
+
+    //Replacing a value updates the usage
+    cache.put(2, 10);
+    EXPECT_EQ(50, cache.memoryUsage());
+
+    //Lowering the limit evicts until the cache fits
+    cache.setMemoryLimit(20);
+    EXPECT_EQ(1, cache.size());
+    EXPECT_TRUE(cache.exists(2));
+    EXPECT_EQ(10, cache.memoryUsage());
+    EXPECT_EQ(80, cache.peakMemoryUsage());
+}
+
+TEST(ConcurrentCacheTest, MemoryLimitAcrossShards) {
+    ConcurrentCache<int, int> cache(1000, [](const int&) { return (size_t)10; });
+    cache.setMemoryLimit(500);
+
+    for(int i = 0; i < 1000; i++) {
+        cache.put(i, i);
+        EXPECT_LE(cache.memoryUsage(), 500);
+    }
+
+    EXPECT_EQ(10 * cache.size(), cache.memoryUsage());
+    EXPECT_LE(cache.peakMemoryUsage(), 500);
+
+    //Lowering the limit evicts from every shard, not just the first
+    cache.setMemoryLimit(20);
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(20, cache.memoryUsage());
+}
+
+TEST(ConcurrentCacheTest, PeakOnlyCountsHeldEntries) {
+    ConcurrentCache<int, int> cache(1, [](const int& value) { return (size_t)value; }, 1);
+
+    //The entry over capacity is evicted before the new one is counted
+    cache.put(0, 40);
+    cache.put(1, 30);
+    EXPECT_EQ(30, cache.memoryUsage());
+    EXPECT_EQ(40, cache.peakMemoryUsage());
+}
+
+TEST(ConcurrentCacheTest, LargeValuesUseWholeLimit) {
+    ConcurrentCache<int, int> cache(1000, [](const int& value) { return (size_t)value; });
+    cache.setMemoryLimit(1000);
+
+    //A value larger than the limit divided between the default shards is still cached
+    cache.put(0, 100);
+    EXPECT_TRUE(cache.exists(0));
+
+    //Making room evicts from other shards too
+    for(int i = 1; i <= 9; i++) {
+        cache.put(i, 10);
+    }
+    cache.put(10, 900);
+    EXPECT_TRUE(cache.exists(10));
+    EXPECT_LE(cache.memoryUsage(), 1000);
+    EXPECT_LE(cache.peakMemoryUsage(), 1000);
+
+    //Only values larger than the whole limit are refused
+    cache.put(11, 1001);
+    EXPECT_FALSE(cache.exists(11));
+    EXPECT_TRUE(cache.exists(10));
+}
+
+TEST(ConcurrentCacheTest, MemoryLimitRequiresSize) {
+    ConcurrentCache<int, int> cache(10);
+    EXPECT_THROW(cache.setMemoryLimit(100), std::logic_error);
+    EXPECT_EQ(0, cache.memoryUsage());
+}
+
+TEST(ConcurrentCacheTest, MovesValues) {
+    ConcurrentCache<int, CopyCounter> cache(4);
+    CopyCounter::copies = 0;
+
+    CopyCounter value(5);
+    cache.put(1, std::move(value));
+    cache.emplace(2, 6);
+    EXPECT_EQ(0, CopyCounter::copies);
+
+    int visited = 0;
+    cache.visit(1, [&visited](CopyCounter& v) { visited += v.value; });
+    cache.visit(2, [&visited](CopyCounter& v) { visited += v.value; });
+    EXPECT_EQ(11, visited);
+    EXPECT_EQ(0, CopyCounter::copies);
+
+    //Putting an lvalue still copies it exactly once
+    CopyCounter kept(7);
+    cache.put(3, kept);
+    EXPECT_EQ(1, CopyCounter::copies);
+    EXPECT_EQ(7, kept.value);
+}
+
+TEST(ConcurrentCacheTest, HandlesOutliveEviction) {
+    ConcurrentCache<int, std::shared_ptr<const std::vector<int>>> cache(1, 1);
+    cache.put(1, std::make_shared<const std::vector<int>>(100, 1));
+
+    std::shared_ptr<const std::vector<int>> handle;
+    cache.visit(1, [&handle](std::shared_ptr<const std::vector<int>>& value) { handle = value; });
+
+    //Evicting the entry only drops the cache's reference
+    cache.put(2, std::make_shared<const std::vector<int>>(100, 2));
+    EXPECT_FALSE(cache.exists(1));
+    ASSERT_TRUE(handle != nullptr);
+    EXPECT_EQ(100, handle->size());
+    EXPECT_EQ(1, (*handle)[99]);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,7 +1,13 @@
 #include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
 #include "ocean_model_interfaces/fvcom/FVCOMChunk.h"
+#include "ocean_model_interfaces/util/ChunkStore.h"
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
 using namespace ocean_model_interfaces;
 
 const FVCOMStructure structure("./ocean_model_interfaces/test_data/box_plume_split", 50, 50, 10, 10);
@@ -13,14 +19,14 @@ TEST(FCVOMChunkTest, GetNodeData) {
     const std::vector<unsigned int>& nodes = structure.getNodesInChunk(chunkInfo);
     const std::vector<unsigned int>& triangles = structure.getTrianglesInChunk(chunkInfo);
 
-    FVCOMChunk chunk(structure.getModelFiles(), nodes, triangles, chunkInfo);
-    const FVCOMChunk::NodeData& data1 = chunk.getNodeData(1, 0, 0);
-    const FVCOMChunk::NodeData& data2 = chunk.getNodeData(1, 9, 0);
-    const FVCOMChunk::NodeData& data3 = chunk.getNodeData(1, 9, 9);
+    FVCOMChunk chunk(structure.getModelFiles(), nodes, triangles, chunkInfo, structure.getStorageBackend());
+    const FVCOMChunk::NodeData& data1 = chunk.getNodeData(structure.getNodeIndexInChunk(1), 0, 0);
+    const FVCOMChunk::NodeData& data2 = chunk.getNodeData(structure.getNodeIndexInChunk(1), 9, 0);
+    const FVCOMChunk::NodeData& data3 = chunk.getNodeData(structure.getNodeIndexInChunk(1), 9, 9);
 
-    const FVCOMChunk::NodeData& data4 = chunk.getNodeData(17, 0, 0);
-    const FVCOMChunk::NodeData& data5 = chunk.getNodeData(17, 9, 0);
-    const FVCOMChunk::NodeData& data6 = chunk.getNodeData(17, 9, 9);
+    const FVCOMChunk::NodeData& data4 = chunk.getNodeData(structure.getNodeIndexInChunk(17), 0, 0);
+    const FVCOMChunk::NodeData& data5 = chunk.getNodeData(structure.getNodeIndexInChunk(17), 9, 0);
+    const FVCOMChunk::NodeData& data6 = chunk.getNodeData(structure.getNodeIndexInChunk(17), 9, 9);
 
     ASSERT_FLOAT_EQ(3.2964647, data1.temp);
     ASSERT_FLOAT_EQ(34.71025, data1.salt);
@@ -47,14 +53,14 @@ TEST(FCVOMChunkTest, GetTriangleData) {
     const std::vector<unsigned int>& nodes = structure.getNodesInChunk(chunkInfo);
     const std::vector<unsigned int>& triangles = structure.getTrianglesInChunk(chunkInfo);
 
-    FVCOMChunk chunk(structure.getModelFiles(), nodes, triangles, chunkInfo);
-    const FVCOMChunk::TriangleData& data1 = chunk.getTriangleData(51, 0, 0);
-    const FVCOMChunk::TriangleData& data2 = chunk.getTriangleData(51, 9, 0);
-    const FVCOMChunk::TriangleData& data3 = chunk.getTriangleData(51, 9, 9);
+    FVCOMChunk chunk(structure.getModelFiles(), nodes, triangles, chunkInfo, structure.getStorageBackend());
+    const FVCOMChunk::TriangleData& data1 = chunk.getTriangleData(structure.getTriangleIndexInChunk(51), 0, 0);
+    const FVCOMChunk::TriangleData& data2 = chunk.getTriangleData(structure.getTriangleIndexInChunk(51), 9, 0);
+    const FVCOMChunk::TriangleData& data3 = chunk.getTriangleData(structure.getTriangleIndexInChunk(51), 9, 9);
 
-    const FVCOMChunk::TriangleData& data4 = chunk.getTriangleData(8, 0, 0);
-    const FVCOMChunk::TriangleData& data5 = chunk.getTriangleData(8, 9, 0);
-    const FVCOMChunk::TriangleData& data6 = chunk.getTriangleData(8, 9, 9);
+    const FVCOMChunk::TriangleData& data4 = chunk.getTriangleData(structure.getTriangleIndexInChunk(8), 0, 0);
+    const FVCOMChunk::TriangleData& data5 = chunk.getTriangleData(structure.getTriangleIndexInChunk(8), 9, 0);
+    const FVCOMChunk::TriangleData& data6 = chunk.getTriangleData(structure.getTriangleIndexInChunk(8), 9, 9);
 
     ASSERT_FLOAT_EQ(0.0, data1.u);
     ASSERT_FLOAT_EQ(0.0, data1.v);
@@ -81,6 +87,35 @@ TEST(FCVOMChunkTest, GetTriangleData) {
     ASSERT_FLOAT_EQ(-0.000160249, data6.w);
 }
 
+TEST(FCVOMChunkTest, StoreCountsMatchChunk) {
+    std::string storeFile = "./FVCOMChunk_test_store.bin";
+
+    //Two nodes and three triangles, each with two time steps of two siglays
+    FVCOMStructure::ChunkInfo chunkInfo = {};
+    chunkInfo.timeSize = 2;
+    chunkInfo.siglaySize = 2;
+    std::vector<float> nodeValues(2 * 4, 1.0f);
+    std::vector<float> triangleValues(3 * 4, 2.0f);
+    {
+        ChunkStoreWriter writer(storeFile, "layout", FVCOMChunk::getVariableNames(), 1);
+        writer.writeChunk(0, {nodeValues.data(), nodeValues.data(), nodeValues.data(), triangleValues.data(), triangleValues.data(), triangleValues.data()},
+                          {nodeValues.size(), nodeValues.size(), nodeValues.size(), triangleValues.size(), triangleValues.size(), triangleValues.size()});
+        writer.finish();
+    }
+    std::shared_ptr<const ChunkStore> store = std::make_shared<const ChunkStore>(storeFile);
+
+    FVCOMChunk chunk(store, chunkInfo, 2, 3);
+    ASSERT_FLOAT_EQ(1.0, chunk.getNodeData(1, 1, 1).temp);
+    ASSERT_FLOAT_EQ(2.0, chunk.getTriangleData(2, 1, 1).w);
+
+    //Counts that divide evenly but are for a different number of elements would read past the values
+    EXPECT_THROW(FVCOMChunk(store, chunkInfo, 3, 3), std::runtime_error);
+    EXPECT_THROW(FVCOMChunk(store, chunkInfo, 2, 4), std::runtime_error);
+    EXPECT_THROW(FVCOMChunk(store, chunkInfo, 1, 3), std::runtime_error);
+
+    std::remove(storeFile.c_str());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
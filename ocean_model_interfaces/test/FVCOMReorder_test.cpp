@@ -0,0 +1,313 @@
+#include "ocean_model_interfaces/fvcom/FVCOMStructure.h"
+#include "ocean_model_interfaces/fvcom/FVCOMChunk.h"
+#include "ocean_model_interfaces/fvcom/FVCOM.h"
+#include "ocean_model_interfaces/util/UtilityFunctions.h"
+
+#include <gtest/gtest.h>
+#include <netcdf>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+using namespace ocean_model_interfaces;
+
+#define SECONDS_IN_DAY 86400
+
+static const std::string MODEL_DIRECTORY = "./ocean_model_interfaces/test_data/box_plume_split";
+static const std::string REORDERED_DIRECTORY = "./FVCOMReorder_test_model";
+static const std::string BROKEN_DIRECTORY = "./FVCOMReorder_test_broken";
+
+//Variables that hold 1 based node or triangle numbers, where zero marks a missing neighbor
+static const std::vector<std::string> NODE_INDEX_VARIABLES = {"nv", "nbsn"};
+static const std::vector<std::string> TRIANGLE_INDEX_VARIABLES = {"nbe", "nbve"};
+
+/**
+ * Orders points along a Hilbert curve over their bounding box, the same way scripts/fvcom_spatial_reorder.py does.
+ * @return The original index of the point at each position along the curve
+ */
+static std::vector<int> hilbertOrder(const std::vector<float>& x, const std::vector<float>& y) {
+    const uint64_t n = 1 << 16;
+    auto quantize = [n](const std::vector<float>& values) {
+        double min = *std::min_element(values.begin(), values.end());
+        double max = *std::max_element(values.begin(), values.end());
+        std::vector<uint64_t> quantized(values.size(), 0);
+        for(size_t i = 0; max > min && i < values.size(); i++) {
+            quantized[i] = (uint64_t)std::floor((values[i] - min) / (max - min) * (n - 1));
+        }
+        return quantized;
+    };
+    std::vector<uint64_t> quantizedX = quantize(x);
+    std::vector<uint64_t> quantizedY = quantize(y);
+
+    std::vector<uint64_t> distances(x.size(), 0);
+    for(size_t i = 0; i < x.size(); i++) {
+        uint64_t xi = quantizedX[i];
+        uint64_t yi = quantizedY[i];
+        for(uint64_t s = n >> 1; s > 0; s >>= 1) {
+            uint64_t rx = (xi & s) > 0;
+            uint64_t ry = (yi & s) > 0;
+            distances[i] += s * s * ((3 * rx) ^ ry);
+
+            //Rotate the quadrant so the curve stays continuous
+            if(ry == 0) {
+                if(rx == 1) {
+                    xi = n - 1 - xi;
+                    yi = n - 1 - yi;
+                }
+                std::swap(xi, yi);
+            }
+        }
+    }
+
+    std::vector<int> order(x.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&distances](int a, int b) { return distances[a] < distances[b]; });
+    return order;
+}
+
+/**
+ * Copies a variable with its node and triangle dimensions permuted.
+ * @param orders The original index at each new position, by dimension name
+ * @param newIndices The new index of each original index, used to renumber variables that hold indices. Null for other variables.
+ */
+template<typename T>
+static void copyVariable(const netCDF::NcVar& source, netCDF::NcFile& destination, const std::map<std::string, std::vector<int>>& orders,
+                         const std::vector<int>* newIndices) {
+    std::vector<netCDF::NcDim> sourceDims = source.getDims();
+    std::vector<netCDF::NcDim> dims;
+    size_t total = 1;
+    for(const netCDF::NcDim& dim : sourceDims) {
+        dims.push_back(destination.getDim(dim.getName()));
+        total *= dim.getSize();
+    }
+
+    std::vector<T> values(total);
+    std::vector<T> permuted(total);
+    source.getVar(values.data());
+
+    for(size_t k = 0; k < total; k++) {
+        //Walk the dimensions from the fastest varying one to find where each value came from
+        size_t remaining = k;
+        size_t sourceIndex = 0;
+        size_t stride = 1;
+        for(int d = (int)sourceDims.size() - 1; d >= 0; d--) {
+            size_t size = sourceDims[d].getSize();
+            size_t index = remaining % size;
+            remaining /= size;
+
+            auto order = orders.find(sourceDims[d].getName());
+            if(order != orders.end()) {
+                index = order->second[index];
+            }
+            sourceIndex += index * stride;
+            stride *= size;
+        }
+
+        permuted[k] = values[sourceIndex];
+        if(newIndices && permuted[k] > 0) {
+            permuted[k] = (*newIndices)[(size_t)permuted[k] - 1] + 1;
+        }
+    }
+
+    destination.addVar(source.getName(), source.getType(), dims).putVar(permuted.data());
+}
+
+/**
+ * Writes a copy of a model with its nodes and triangles in Hilbert order and the original_node and original_nele
+ * variables scripts/fvcom_spatial_reorder.py adds. Attributes are not read by the library and are not copied.
+ * @param breakPermutation Give two nodes the same original index, so original_node is not a permutation
+ */
+static void writeReorderedModel(const std::string& source, const std::string& destination, bool breakPermutation) {
+    std::vector<std::string> filenames = traverseDataFiles(source);
+    ASSERT_FALSE(filenames.empty());
+    boost::filesystem::create_directories(destination);
+
+    //Every file shares the mesh, so the order comes from the first one
+    std::map<std::string, std::vector<int>> orders;
+    {
+        netCDF::NcFile file(filenames[0], netCDF::NcFile::read);
+        const std::vector<std::pair<std::string, std::vector<std::string>>> coordinates = {{"node", {"x", "y"}}, {"nele", {"xc", "yc"}}};
+        for(const auto& dimCoordinates : coordinates) {
+            std::vector<float> x(file.getDim(dimCoordinates.first).getSize());
+            std::vector<float> y(x.size());
+            file.getVar(dimCoordinates.second[0]).getVar(x.data());
+            file.getVar(dimCoordinates.second[1]).getVar(y.data());
+            orders[dimCoordinates.first] = hilbertOrder(x, y);
+        }
+    }
+
+    std::map<std::string, std::vector<int>> newIndices;
+    for(const auto& order : orders) {
+        std::vector<int>& indices = newIndices[order.first];
+        indices.resize(order.second.size());
+        for(size_t i = 0; i < order.second.size(); i++) {
+            indices[order.second[i]] = i;
+        }
+    }
+
+    for(const std::string& filename : filenames) {
+        netCDF::NcFile input(filename, netCDF::NcFile::read);
+        netCDF::NcFile output((boost::filesystem::path(destination) / boost::filesystem::path(filename).filename()).string(), netCDF::NcFile::replace);
+
+        for(const auto& dim : input.getDims()) {
+            output.addDim(dim.first, dim.second.getSize());
+        }
+
+        for(const auto& var : input.getVars()) {
+            const std::vector<int>* indices = nullptr;
+            if(std::find(NODE_INDEX_VARIABLES.begin(), NODE_INDEX_VARIABLES.end(), var.first) != NODE_INDEX_VARIABLES.end()) {
+                indices = &newIndices["node"];
+            } else if(std::find(TRIANGLE_INDEX_VARIABLES.begin(), TRIANGLE_INDEX_VARIABLES.end(), var.first) != TRIANGLE_INDEX_VARIABLES.end()) {
+                indices = &newIndices["nele"];
+            }
+
+            if(var.second.getType() == netCDF::ncChar) {
+                copyVariable<char>(var.second, output, orders, nullptr);
+            } else {
+                copyVariable<double>(var.second, output, orders, indices);
+            }
+        }
+
+        std::vector<int> originalNode = orders["node"];
+        if(breakPermutation) {
+            originalNode[1] = originalNode[0];
+        }
+        output.addVar("original_node", netCDF::ncInt, output.getDim("node")).putVar(originalNode.data());
+        output.addVar("original_nele", netCDF::ncInt, output.getDim("nele")).putVar(orders["nele"].data());
+    }
+}
+
+static void expectSameValues(const FVCOMChunk& expected, const FVCOMChunk& actual) {
+    for(unsigned int v = 0; v < FVCOMChunk::NUM_VARIABLES; v++) {
+        FVCOMChunk::Variable variable = (FVCOMChunk::Variable)v;
+        ASSERT_EQ(expected.getNumValues(variable), actual.getNumValues(variable));
+        for(size_t i = 0; i < expected.getNumValues(variable); i++) {
+            ASSERT_EQ(expected.getValues(variable)[i], actual.getValues(variable)[i]);
+        }
+    }
+}
+
+TEST(FVCOMReorderTest, MatchesOriginalOrder) {
+    writeReorderedModel(MODEL_DIRECTORY, REORDERED_DIRECTORY, false);
+
+    FVCOMStructure original(MODEL_DIRECTORY, 50, 50, 10, 10);
+    FVCOMStructure reordered(REORDERED_DIRECTORY, 50, 50, 10, 10);
+    ASSERT_FALSE(original.isReordered());
+    ASSERT_TRUE(reordered.isReordered());
+    ASSERT_EQ(original.getNumNodes(), reordered.getNumNodes());
+    ASSERT_EQ(original.getNumTriangles(), reordered.getNumTriangles());
+
+    //Nodes and triangles keep their original numbers even though the files store them elsewhere
+    unsigned int movedNodes = 0;
+    for(unsigned int i = 0; i < original.getNumNodes(); i++) {
+        Point expected = original.getNodePointWithH(i);
+        Point actual = reordered.getNodePointWithH(i);
+        ASSERT_EQ(expected.x, actual.x);
+        ASSERT_EQ(expected.y, actual.y);
+        ASSERT_EQ(expected.z, actual.z);
+        for(unsigned int siglay = 0; siglay < original.getNumSiglays(); siglay++) {
+            ASSERT_EQ(original.getNodePointAtSiglay(i, siglay).z, reordered.getNodePointAtSiglay(i, siglay).z);
+        }
+        movedNodes += reordered.getNodeFileIndex(i) != i;
+    }
+    EXPECT_GT(movedNodes, 0);
+
+    unsigned int movedTriangles = 0;
+    for(unsigned int i = 0; i < original.getNumTriangles(); i++) {
+        ASSERT_EQ(original.getNodesInTriangle(i), reordered.getNodesInTriangle(i));
+        movedTriangles += reordered.getTriangleFileIndex(i) != i;
+
+        //A point inside the triangle is found in the same triangle
+        const std::vector<int>& nodes = original.getNodesInTriangle(i);
+        Point center(0, 0, 0);
+        for(int node : nodes) {
+            center.x += original.getNodePointWithH(node).x / nodes.size();
+            center.y += original.getNodePointWithH(node).y / nodes.size();
+        }
+        ASSERT_EQ(original.getContainingTriangle(center), reordered.getContainingTriangle(center));
+    }
+    EXPECT_GT(movedTriangles, 0);
+
+    //Chunks read the values of each node and triangle from wherever the files store them
+    for(const FVCOMStructure::ChunkInfo& chunkInfo : original.getAllChunks()) {
+        if(chunkInfo.timeChunk != 0) {
+            continue;
+        }
+
+        const std::vector<unsigned int>& nodes = original.getNodesInChunk(chunkInfo);
+        const std::vector<unsigned int>& triangles = original.getTrianglesInChunk(chunkInfo);
+        ASSERT_EQ(nodes, reordered.getNodesInChunk(chunkInfo));
+        ASSERT_EQ(triangles, reordered.getTrianglesInChunk(chunkInfo));
+
+        std::vector<unsigned int> nodeFileIndices;
+        std::vector<unsigned int> triangleFileIndices;
+        for(unsigned int node : nodes) {
+            nodeFileIndices.push_back(reordered.getNodeFileIndex(node));
+        }
+        for(unsigned int triangle : triangles) {
+            triangleFileIndices.push_back(reordered.getTriangleFileIndex(triangle));
+        }
+
+        FVCOMChunk expected(original.getModelFiles(), nodes, triangles, chunkInfo, original.getStorageBackend());
+        FVCOMChunk actual(reordered.getModelFiles(), nodes, triangles, chunkInfo, reordered.getStorageBackend(), nodeFileIndices, triangleFileIndices);
+        expectSameValues(expected, actual);
+    }
+
+    //Queries give the same data at the same points
+    FVCOM originalModel(MODEL_DIRECTORY, 50, 50, 10, 10, 100);
+    FVCOM reorderedModel(REORDERED_DIRECTORY, 50, 50, 10, 10, 100);
+    int compared = 0;
+    for(unsigned int i = 0; i < original.getNumTriangles(); i += 7) {
+        const std::vector<int>& nodes = original.getNodesInTriangle(i);
+        Point p0 = original.getNodePointWithH(nodes[0]);
+        Point p1 = original.getNodePointWithH(nodes[1]);
+        Point p2 = original.getNodePointWithH(nodes[2]);
+        double x = (p0.x + p1.x + p2.x) / 3;
+        double y = (p0.y + p1.y + p2.y) / 3;
+
+        for(double time : {0.0, 0.01}) {
+            ModelData expected;
+            try {
+                expected = originalModel.getData(x, y, -1, time * SECONDS_IN_DAY);
+            }
+            catch(std::out_of_range const & err) {
+                EXPECT_THROW(reorderedModel.getData(x, y, -1, time * SECONDS_IN_DAY), std::out_of_range);
+                continue;
+            }
+
+            ModelData actual = reorderedModel.getData(x, y, -1, time * SECONDS_IN_DAY);
+            EXPECT_DOUBLE_EQ(expected.temp, actual.temp);
+            EXPECT_DOUBLE_EQ(expected.salt, actual.salt);
+            EXPECT_DOUBLE_EQ(expected.dye, actual.dye);
+            EXPECT_DOUBLE_EQ(expected.u, actual.u);
+            EXPECT_DOUBLE_EQ(expected.v, actual.v);
+            EXPECT_DOUBLE_EQ(expected.w, actual.w);
+            EXPECT_DOUBLE_EQ(expected.depth, actual.depth);
+            compared++;
+        }
+    }
+    EXPECT_GT(compared, 0);
+
+    boost::filesystem::remove_all(REORDERED_DIRECTORY);
+}
+
+TEST(FVCOMReorderTest, RejectsNonPermutation) {
+    writeReorderedModel(MODEL_DIRECTORY, BROKEN_DIRECTORY, true);
+
+    EXPECT_THROW(FVCOMStructure(BROKEN_DIRECTORY, 50, 50, 10, 10), std::runtime_error);
+
+    boost::filesystem::remove_all(BROKEN_DIRECTORY);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -4,6 +4,8 @@
 #include "ocean_model_interfaces/util/Plane.h"
 #include "ocean_model_interfaces/util/Point.h"
 
+#include <cstdio>
+
 using namespace ocean_model_interfaces;
 
 FVCOMStructure structure("./ocean_model_interfaces/test_data/box_plume_split", 10, 10, 10, 10);
@@ -456,6 +458,81 @@ TEST(FVCOMStructureTest, PointInModel) {
     ASSERT_FALSE(structure.pointInModel(depthOutside2, 0));
 }
 
+TEST(FVCOMStructureTest, FileIndicesWithoutReordering) {
+    //The test models were not reordered so file indices are the original indices
+    ASSERT_FALSE(structure.isReordered());
+
+    for(unsigned int i = 0; i < structure.getNumNodes(); i++) {
+        ASSERT_EQ(i, structure.getNodeFileIndex(i));
+    }
+
+    for(unsigned int i = 0; i < structure.getNumTriangles(); i++) {
+        ASSERT_EQ(i, structure.getTriangleFileIndex(i));
+    }
+}
+
+TEST(FVCOMStructureTest, StructureCache) {
+    std::string cacheFile = "./FVCOMStructure_test_cache.bin";
+    std::remove(cacheFile.c_str());
+
+    //The first structure writes the cache and the second loads from it
+    FVCOMStructure written("./ocean_model_interfaces/test_data/axial_data_test", 1000, 1000, 10, 10, cacheFile);
+    FVCOMStructure cached("./ocean_model_interfaces/test_data/axial_data_test", 1000, 1000, 10, 10, cacheFile);
+
+    //A structure loaded from the cache never opens the model files
+    EXPECT_GT(written.getFilePool().getOpenFileCount(), 0);
+    EXPECT_EQ(0, cached.getFilePool().getOpenFileCount());
+
+    //Only the first structure reads the mesh from the model files
+    EXPECT_GT(written.getLoadTimes().readMesh, 0);
+    EXPECT_EQ(0, cached.getLoadTimes().readMesh);
+    EXPECT_EQ(0, cached.getLoadTimes().splitIntoChunks);
+
+    for(const FVCOMStructure* loaded : {&written, &cached}) {
+        ASSERT_EQ(structureAxial.getNumNodes(), loaded->getNumNodes());
+        ASSERT_EQ(structureAxial.getNumTriangles(), loaded->getNumTriangles());
+        ASSERT_EQ(structureAxial.getNumSiglays(), loaded->getNumSiglays());
+        ASSERT_EQ(structureAxial.getNumTimes(), loaded->getNumTimes());
+
+        std::vector<FVCOMStructure::ModelFile> expectedFiles = structureAxial.getModelFiles();
+        std::vector<FVCOMStructure::ModelFile> loadedFiles = loaded->getModelFiles();
+        ASSERT_EQ(expectedFiles.size(), loadedFiles.size());
+        for(unsigned int i = 0; i < expectedFiles.size(); i++) {
+            EXPECT_EQ(expectedFiles[i].filename, loadedFiles[i].filename);
+            EXPECT_EQ(expectedFiles[i].startTimeIndex, loadedFiles[i].startTimeIndex);
+        }
+
+        for(unsigned int i = 0; i < structureAxial.getNumNodes(); i++) {
+            Point expected = structureAxial.getNodePointAtSiglay(i, 5);
+            Point point = loaded->getNodePointAtSiglay(i, 5);
+            ASSERT_DOUBLE_EQ(expected.x, point.x);
+            ASSERT_DOUBLE_EQ(expected.y, point.y);
+            ASSERT_DOUBLE_EQ(expected.z, point.z);
+            ASSERT_EQ(structureAxial.getNodeIndexInChunk(i), loaded->getNodeIndexInChunk(i));
+        }
+
+        for(unsigned int i = 0; i < structureAxial.getNumTriangles(); i++) {
+            ASSERT_EQ(structureAxial.getNodesInTriangle(i), loaded->getNodesInTriangle(i));
+
+            FVCOMStructure::ChunkInfo chunk = loaded->getChunkForTriangle(i, 0, 0);
+            ASSERT_EQ(structureAxial.getChunkForTriangle(i, 0, 0).id, chunk.id);
+            ASSERT_EQ(structureAxial.getTrianglesInChunk(chunk), loaded->getTrianglesInChunk(chunk));
+        }
+
+        Point position(8545.73568, -132697.938, -334.07498037);
+        ASSERT_EQ(structureAxial.getContainingTriangle(position), loaded->getContainingTriangle(position));
+    }
+
+    //A cache written for other chunk sizes is replaced instead of used
+    FVCOMStructure resized("./ocean_model_interfaces/test_data/axial_data_test", 500, 500, 10, 10, cacheFile);
+    FVCOMStructure resizedExpected("./ocean_model_interfaces/test_data/axial_data_test", 500, 500, 10, 10);
+    for(unsigned int i = 0; i < resizedExpected.getNumNodes(); i++) {
+        ASSERT_EQ(resizedExpected.getNodeIndexInChunk(i), resized.getNodeIndexInChunk(i));
+    }
+
+    std::remove(cacheFile.c_str());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -9,6 +9,13 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
 using namespace ocean_model_interfaces;
 
 #define SECONDS_IN_DAY 86400
@@ -371,6 +378,313 @@ TEST(FVCOMTest, ModelEdge) {
     EXPECT_FLOAT_EQ(0.0, data.dye);
 }
 
+TEST(FVCOMTest, QueryContext)
+{
+    fvcomMultiple.setOffsets(0, 0, 0, 0);
+
+    //Two interleaved trajectories each with their own context should get the same data as without a context
+    QueryContext context1;
+    QueryContext context2;
+    for(int i = 0; i < 10; i++)
+    {
+        double time = i * 0.03 * SECONDS_IN_DAY;
+
+        ModelData data1 = fvcomMultiple.getData(8545.73568 + i * 10, -132697.938, -334.07498037 + i, time, context1);
+        ModelData data2 = fvcomMultiple.getData(-138453.56466666667, -25886.79643333335 + i * 10, -381.232432006 + i, time, context2);
+
+        ModelData expected1 = fvcomMultiple.getData(8545.73568 + i * 10, -132697.938, -334.07498037 + i, time);
+        ModelData expected2 = fvcomMultiple.getData(-138453.56466666667, -25886.79643333335 + i * 10, -381.232432006 + i, time);
+
+        EXPECT_DOUBLE_EQ(expected1.temp, data1.temp);
+        EXPECT_DOUBLE_EQ(expected1.salt, data1.salt);
+        EXPECT_DOUBLE_EQ(expected1.u, data1.u);
+        EXPECT_DOUBLE_EQ(expected1.depth, data1.depth);
+
+        EXPECT_DOUBLE_EQ(expected2.temp, data2.temp);
+        EXPECT_DOUBLE_EQ(expected2.salt, data2.salt);
+        EXPECT_DOUBLE_EQ(expected2.u, data2.u);
+        EXPECT_DOUBLE_EQ(expected2.depth, data2.depth);
+    }
+
+    EXPECT_NE(-1, context1.lastCell);
+    EXPECT_NE(-1, context1.lastTimeIndex);
+    EXPECT_NE(context1.lastCell, context2.lastCell);
+}
+
+TEST(FVCOMTest, ConcurrentQueries)
+{
+    fvcomMultiple.setOffsets(0, 0, 0, 0);
+
+    std::vector<double> xs = {8545.73568, -138453.56466666667, 12314};
+    std::vector<double> ys = {-132697.938, -25886.79643333335, -9648};
+    std::vector<double> zs = {-334.07498037, -381.232432006, -89};
+
+    std::vector<ModelData> expected;
+    for(unsigned int i = 0; i < xs.size(); i++)
+    {
+        expected.push_back(fvcomMultiple.getData(xs[i], ys[i], zs[i], 0.11 * SECONDS_IN_DAY));
+    }
+
+    //Every thread queries the same model with its own context
+    std::vector<int> mismatches(4, 0);
+    std::vector<std::thread> threads;
+    for(unsigned int t = 0; t < mismatches.size(); t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            QueryContext context;
+            for(unsigned int i = 0; i < 30; i++)
+            {
+                unsigned int point = (i + t) % xs.size();
+                ModelData data = fvcomMultiple.getData(xs[point], ys[point], zs[point], 0.11 * SECONDS_IN_DAY, context);
+                if(data.temp != expected[point].temp || data.u != expected[point].u)
+                {
+                    mismatches[t]++;
+                }
+            }
+        }));
+    }
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for(unsigned int t = 0; t < mismatches.size(); t++)
+    {
+        EXPECT_EQ(0, mismatches[t]);
+    }
+}
+
+TEST(FVCOMTest, BatchQueries)
+{
+    fvcomMultiple.setOffsets(0, 0, 0, 0);
+
+    //Mix of points inside the model, outside in XY, depth and time
+    std::vector<double> xs = {8545.73568, -138453.56466666667, 12314, 300000, 0, 8545.73568, 8555.73568};
+    std::vector<double> ys = {-132697.938, -25886.79643333335, -9648, 0, 0, -132697.938, -132697.938};
+    std::vector<double> zs = {-334.07498037, -381.232432006, -89, 0, 10000, -334.07498037, -333.07498037};
+    std::vector<double> ts = {0.11 * SECONDS_IN_DAY, 0.02 * SECONDS_IN_DAY, 0.11 * SECONDS_IN_DAY, 0, 0, -0.1 * SECONDS_IN_DAY, 0.05 * SECONDS_IN_DAY};
+
+    ModelDataSoA batch;
+    fvcomMultiple.getDataBatch(xs.data(), ys.data(), zs.data(), ts.data(), xs.size(), batch);
+    ASSERT_EQ(xs.size(), batch.size());
+
+    for(unsigned int i = 0; i < xs.size(); i++)
+    {
+        ModelData expected;
+        bool inModel = true;
+        try
+        {
+            expected = fvcomMultiple.getData(xs[i], ys[i], zs[i], ts[i]);
+        }
+        catch(std::out_of_range const & err)
+        {
+            expected = fvcomMultiple.getDataOutOfRange(xs[i], ys[i], zs[i], ts[i]);
+            inModel = false;
+        }
+
+        EXPECT_EQ(inModel, (bool)batch.inModel[i]);
+        EXPECT_DOUBLE_EQ(expected.depth, batch.depth[i]);
+        if(inModel)
+        {
+            EXPECT_DOUBLE_EQ(expected.temp, batch.temp[i]);
+            EXPECT_DOUBLE_EQ(expected.salt, batch.salt[i]);
+            EXPECT_DOUBLE_EQ(expected.dye, batch.dye[i]);
+            EXPECT_DOUBLE_EQ(expected.u, batch.u[i]);
+            EXPECT_DOUBLE_EQ(expected.v, batch.v[i]);
+            EXPECT_DOUBLE_EQ(expected.w, batch.w[i]);
+        }
+        else
+        {
+            EXPECT_TRUE(std::isnan(batch.temp[i]));
+            EXPECT_TRUE(std::isnan(batch.u[i]));
+        }
+    }
+}
+
+TEST(FVCOMTest, ParallelBatchQueries)
+{
+    fvcomMultiple.setOffsets(0, 0, 0, 0);
+
+    //Points spread across the mesh and through time, with some outside of the model
+    std::vector<double> xs, ys, zs, ts;
+    for(int i = 0; i < 2000; i++)
+    {
+        xs.push_back(-140000 + (i % 100) * 1500);
+        ys.push_back(-135000 + (i / 20) * 1300);
+        zs.push_back(-5.0 - (i % 37) * 10);
+        ts.push_back((i % 11) * 0.01 * SECONDS_IN_DAY);
+    }
+
+    ModelDataSoA serial;
+    fvcomMultiple.setBatchThreadCount(1);
+    fvcomMultiple.getDataBatch(xs.data(), ys.data(), zs.data(), ts.data(), xs.size(), serial);
+
+    ModelDataSoA parallel;
+    fvcomMultiple.setBatchThreadCount(4);
+    EXPECT_EQ(4, fvcomMultiple.getBatchThreadCount());
+    fvcomMultiple.getDataBatch(xs.data(), ys.data(), zs.data(), ts.data(), xs.size(), parallel);
+    fvcomMultiple.setBatchThreadCount(1);
+
+    ASSERT_EQ(serial.size(), parallel.size());
+    for(unsigned int i = 0; i < serial.size(); i++)
+    {
+        EXPECT_EQ(serial.inModel[i], parallel.inModel[i]);
+        if(serial.inModel[i])
+        {
+            EXPECT_DOUBLE_EQ(serial.temp[i], parallel.temp[i]);
+            EXPECT_DOUBLE_EQ(serial.salt[i], parallel.salt[i]);
+            EXPECT_DOUBLE_EQ(serial.u[i], parallel.u[i]);
+            EXPECT_DOUBLE_EQ(serial.depth[i], parallel.depth[i]);
+        }
+    }
+}
+
+TEST(FVCOMTest, Prefetch)
+{
+    fvcomMultiple.setOffsets(0, 0, 0, 0);
+
+    int loads = 0;
+    FVCOM fvcom("./ocean_model_interfaces/test_data/axial_data_test", [&loads]() { loads++; }, nullptr, 1000, 1000, 10, 3, 100);
+
+    //Everything a query near the point needs for the next few time slices should be loaded in the background
+    fvcom.prefetch(8545.73568, -132697.938, -334.07498037, 0.02 * SECONDS_IN_DAY, 500, 0.05 * SECONDS_IN_DAY);
+    fvcom.waitForPrefetch();
+    EXPECT_EQ(0, loads);
+
+    for(int i = 0; i < 5; i++)
+    {
+        ModelData data = fvcom.getData(8545.73568 + i * 50, -132697.938 + i * 50, -334.07498037, (0.02 + i * 0.01) * SECONDS_IN_DAY);
+        ModelData expected = fvcomMultiple.getData(8545.73568 + i * 50, -132697.938 + i * 50, -334.07498037, (0.02 + i * 0.01) * SECONDS_IN_DAY);
+        EXPECT_DOUBLE_EQ(expected.temp, data.temp);
+        EXPECT_DOUBLE_EQ(expected.u, data.u);
+    }
+
+    EXPECT_EQ(0, loads);
+
+    //Destroying a model with prefetches still queued must not crash
+    fvcom.prefetch(0, 0, 0, 0, 100000, 0.1 * SECONDS_IN_DAY);
+}
+
+TEST(FVCOMTest, PrefetchOffMesh)
+{
+    //Find a point inside the bounding box of the mesh that no triangle contains
+    double minX = std::numeric_limits<double>::max(), minY = minX;
+    double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+    for(unsigned int node = 0; node < structure.getNumNodes(); node++)
+    {
+        Point p = structure.getNodePointWithH(node);
+        minX = std::min(minX, p.x);
+        minY = std::min(minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+
+    bool found = false;
+    Point offMesh(0, 0, -10);
+    for(int i = 1; i < 100 && !found; i++)
+    {
+        for(int j = 1; j < 100 && !found; j++)
+        {
+            offMesh.x = minX + (maxX - minX) * i / 100;
+            offMesh.y = minY + (maxY - minY) * j / 100;
+            try
+            {
+                structure.getContainingTriangle(offMesh);
+            }
+            catch(std::out_of_range const & err)
+            {
+                found = structure.xyInModel(offMesh);
+            }
+        }
+    }
+    ASSERT_TRUE(found);
+
+    //The depth is unknown off the mesh, so the prefetch falls back to every siglay instead of throwing
+    int loads = 0;
+    FVCOM fvcom("./ocean_model_interfaces/test_data/axial_data_test", [&loads]() { loads++; }, nullptr, 1000, 1000, 10, 3, 100);
+    EXPECT_NO_THROW(fvcom.prefetch(offMesh.x, offMesh.y, offMesh.z, 0.02 * SECONDS_IN_DAY, 500, 0.05 * SECONDS_IN_DAY));
+    fvcom.waitForPrefetch();
+    EXPECT_EQ(0, loads);
+}
+
+TEST(FVCOMTest, CacheMemoryLimit)
+{
+    fvcomMultiple.setOffsets(0, 0, 0, 0);
+
+    FVCOM fvcom("./ocean_model_interfaces/test_data/axial_data_test", 1000, 1000, 10, 3, 100);
+    fvcom.getData(8545.73568, -132697.938, -334.07498037, 0.02 * SECONDS_IN_DAY);
+
+    size_t chunkBytes = fvcom.getCacheMemoryUsage();
+    ASSERT_GT(chunkBytes, 0);
+
+    //Allow about sixteen chunks, then touch many chunks
+    size_t limit = 16 * chunkBytes;
+    fvcom.setCacheMemoryLimit(limit);
+    for(int i = 0; i < 20; i++)
+    {
+        ModelData data = fvcom.getData(8545.73568 + i * 500, -132697.938 + i * 500, -334.07498037, (0.02 + i * 0.01) * SECONDS_IN_DAY);
+        ModelData expected = fvcomMultiple.getData(8545.73568 + i * 500, -132697.938 + i * 500, -334.07498037, (0.02 + i * 0.01) * SECONDS_IN_DAY);
+        EXPECT_DOUBLE_EQ(expected.temp, data.temp);
+        EXPECT_LE(fvcom.getCacheMemoryUsage(), limit);
+    }
+
+    EXPECT_GE(fvcom.getPeakCacheMemoryUsage(), chunkBytes);
+}
+
+TEST(FVCOMTest, TinyCache)
+{
+    fvcomMultiple.setOffsets(0, 0, 0, 0);
+
+    //Interpolating one point needs several chunks, so most of them are evicted while still in use
+    FVCOM fvcom("./ocean_model_interfaces/test_data/axial_data_test", 1000, 1000, 10, 3, 1);
+    for(int i = 0; i < 20; i++)
+    {
+        double x = 8545.73568 + i * 500;
+        double y = -132697.938 + i * 500;
+        double time = (0.02 + i * 0.01) * SECONDS_IN_DAY;
+
+        ModelData data = fvcom.getData(x, y, -334.07498037, time);
+        ModelData expected = fvcomMultiple.getData(x, y, -334.07498037, time);
+        EXPECT_DOUBLE_EQ(expected.temp, data.temp);
+        EXPECT_DOUBLE_EQ(expected.u, data.u);
+    }
+
+    //Chunks in use stay valid after eviction, so the cache never has to grow past its one entry
+    EXPECT_EQ(1, fvcom.getCachedChunkCount());
+}
+
+TEST(FVCOMTest, ChunkStore)
+{
+    fvcomMultiple.setOffsets(0, 0, 0, 0);
+    std::string storeFile = "./FVCOM_test_chunk_store.bin";
+
+    FVCOM fvcom("./ocean_model_interfaces/test_data/axial_data_test", 1000, 1000, 10, 3, 10);
+    fvcom.writeChunkStore(storeFile);
+    fvcom.setChunkStore(storeFile);
+
+    for(int i = 0; i < 20; i++)
+    {
+        double x = 8545.73568 + i * 500;
+        double y = -132697.938 + i * 500;
+        double time = (0.02 + i * 0.01) * SECONDS_IN_DAY;
+
+        ModelData data = fvcom.getData(x, y, -334.07498037, time);
+        ModelData expected = fvcomMultiple.getData(x, y, -334.07498037, time);
+        EXPECT_DOUBLE_EQ(expected.temp, data.temp);
+        EXPECT_DOUBLE_EQ(expected.salt, data.salt);
+        EXPECT_DOUBLE_EQ(expected.u, data.u);
+        EXPECT_DOUBLE_EQ(expected.w, data.w);
+    }
+
+    //A store is only used with the chunk sizes it was written for
+    FVCOM resized("./ocean_model_interfaces/test_data/axial_data_test", 500, 500, 10, 3, 10);
+    EXPECT_THROW(resized.setChunkStore(storeFile), std::runtime_error);
+
+    std::remove(storeFile.c_str());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -37,7 +37,7 @@ class GeodeticGridChunkTest : public testing::Test {
 TEST_F(GeodeticGridChunkTest, GetGridChunkInfo)
 {
     GeodeticGridStructure::ChunkInfo struct1Start = structure1.getGridChunkInfo(0, 3, 4, 5);
-    GeodeticGridChunk struct1StartChunk(struct1Start, structure1.getModelFiles());
+    GeodeticGridChunk struct1StartChunk(struct1Start, structure1.getModelFiles(), structure1.getStorageBackend());
     ModelData struct1StartData = struct1StartChunk.getData(0, 3, 4, 5);
     EXPECT_FLOAT_EQ(struct1StartData.u, 0.01317278016358614);
     EXPECT_FLOAT_EQ(struct1StartData.v, -4.7695075045339763E-4);
@@ -47,7 +47,7 @@ TEST_F(GeodeticGridChunkTest, GetGridChunkInfo)
     EXPECT_FLOAT_EQ(struct1StartData.dye, 4.6685445E-17);
 
     GeodeticGridStructure::ChunkInfo struct1End = structure1.getGridChunkInfo(1, 31, 48, 49);
-    GeodeticGridChunk struct1EndChunk(struct1End, structure1.getModelFiles());
+    GeodeticGridChunk struct1EndChunk(struct1End, structure1.getModelFiles(), structure1.getStorageBackend());
     ModelData struct1EndData = struct1EndChunk.getData(1, 31, 48, 49);
     EXPECT_FLOAT_EQ(struct1EndData.u, -0.1458616405725479);
     EXPECT_FLOAT_EQ(struct1EndData.v, 0.05776486173272133);
@@ -57,7 +57,7 @@ TEST_F(GeodeticGridChunkTest, GetGridChunkInfo)
     EXPECT_FLOAT_EQ(struct1EndData.dye, 2.4945718E-6);
 
     GeodeticGridStructure::ChunkInfo struct1Mid = structure1.getGridChunkInfo(0, 14, 25, 36);
-    GeodeticGridChunk struct1MidChunk(struct1Mid, structure1.getModelFiles());
+    GeodeticGridChunk struct1MidChunk(struct1Mid, structure1.getModelFiles(), structure1.getStorageBackend());
     ModelData struct1MidData = struct1MidChunk.getData(0, 14, 25, 36);
     EXPECT_FLOAT_EQ(struct1MidData.u, -0.029579374939203262);
     EXPECT_FLOAT_EQ(struct1MidData.v, -0.027591418474912643);
@@ -67,7 +67,7 @@ TEST_F(GeodeticGridChunkTest, GetGridChunkInfo)
     EXPECT_FLOAT_EQ(struct1MidData.dye, 1.5467025E-8);
 
     GeodeticGridStructure::ChunkInfo struct2Start = structure2.getGridChunkInfo(0, 3, 4, 5);
-    GeodeticGridChunk struct2StartChunk(struct2Start, structure2.getModelFiles());
+    GeodeticGridChunk struct2StartChunk(struct2Start, structure2.getModelFiles(), structure2.getStorageBackend());
     ModelData struct2StartData = struct2StartChunk.getData(0, 3, 4, 5);
     EXPECT_FLOAT_EQ(struct2StartData.u, 0.01317278016358614);
     EXPECT_FLOAT_EQ(struct2StartData.v, -4.7695075045339763E-4);
@@ -77,7 +77,7 @@ TEST_F(GeodeticGridChunkTest, GetGridChunkInfo)
     EXPECT_FLOAT_EQ(struct2StartData.dye, 4.6685445E-17);
 
     GeodeticGridStructure::ChunkInfo struct2End = structure2.getGridChunkInfo(1, 31, 48, 49);
-    GeodeticGridChunk struct2EndChunk(struct2End, structure2.getModelFiles());
+    GeodeticGridChunk struct2EndChunk(struct2End, structure2.getModelFiles(), structure2.getStorageBackend());
     ModelData struct2EndData = struct2EndChunk.getData(1, 31, 48, 49);
     EXPECT_FLOAT_EQ(struct2EndData.u, -0.1458616405725479);
     EXPECT_FLOAT_EQ(struct2EndData.v, 0.05776486173272133);
@@ -87,7 +87,7 @@ TEST_F(GeodeticGridChunkTest, GetGridChunkInfo)
     EXPECT_FLOAT_EQ(struct2EndData.dye, 2.4945718E-6);
 
     GeodeticGridStructure::ChunkInfo struct2Mid = structure2.getGridChunkInfo(0, 14, 25, 36);
-    GeodeticGridChunk struct2MidChunk(struct2Mid, structure2.getModelFiles());
+    GeodeticGridChunk struct2MidChunk(struct2Mid, structure2.getModelFiles(), structure2.getStorageBackend());
     ModelData struct2MidData = struct2MidChunk.getData(0, 14, 25, 36);
     EXPECT_FLOAT_EQ(struct2MidData.u, -0.029579374939203262);
     EXPECT_FLOAT_EQ(struct2MidData.v, -0.027591418474912643);
@@ -179,6 +179,31 @@ TEST_F(GeodeticGridStructureTest, GetWaterColumnDepth)
     EXPECT_DOUBLE_EQ(structure1.indexWaterColumnDepth(25, 36), 4260.392949210215);
 }
 
+TEST_F(GeodeticGridStructureTest, SinglePrecisionDepths)
+{
+    GeodeticGridParameters parameters;
+    parameters.modelDirectory = "./ocean_model_interfaces/test_data/geodetic_grid_test/";
+    parameters.depthChunkSize = 5;
+    parameters.latChunkSize = 6;
+    parameters.lonChunkSize = 6;
+    parameters.precision = GeodeticGridParameters::FLOAT32;
+    GeodeticGridStructure singleStructure(parameters);
+
+    EXPECT_FLOAT_EQ(singleStructure.indexWaterColumnDepth(4, 5), 4192.582992535584);
+    EXPECT_FLOAT_EQ(singleStructure.indexWaterColumnDepth(48, 49), 4240.553816352657);
+
+    //Only the depths are rounded, so the weights barely change
+    Point betweenAll = Point(-169.2590, -14.57603, -4177.89994465);
+    double betweenAllTime = 2506688.8;
+    auto singleWeights = singleStructure.getDataInterpolationWeights(betweenAll, betweenAllTime);
+    auto doubleWeights = structure1.getDataInterpolationWeights(betweenAll, betweenAllTime);
+    ASSERT_EQ(singleWeights.size(), doubleWeights.size());
+    for(auto const& weight : doubleWeights) {
+        ASSERT_EQ(singleWeights.count(weight.first), 1);
+        EXPECT_NEAR(singleWeights[weight.first], weight.second, 1e-4);
+    }
+}
+
 TEST_F(GeodeticGridStructureTest, GetDataInterpolationWeights)
 {
     //Test directly on Index 0,10,25,25
@@ -296,6 +321,41 @@ TEST_F(GeodeticGridStructureTest, GetDataInterpolationWeights)
     }
 }
 
+TEST_F(GeodeticGridStructureTest, GetInterpolationStencil)
+{
+    Point betweenAll = Point(-169.2590, -14.57603, -4177.89994465);
+    double betweenAllTime = 2506688.8;
+
+    GeodeticGridStructure::InterpolationStencil stencil;
+    structure1.getInterpolationStencil(betweenAll, betweenAllTime, stencil);
+    auto weights = structure1.getDataInterpolationWeights(betweenAll, betweenAllTime);
+
+    //The stencil has the same points and weights as the map, in the same order
+    ASSERT_EQ(stencil.size, 12);
+    ASSERT_EQ(weights.size(), 12);
+    double weightSum = 0;
+    unsigned int i = 0;
+    for(auto const& weight : weights) {
+        const GeodeticGridStructure::InterpolationStencil::GridPoint& gridPoint = stencil.points[i++];
+        EXPECT_EQ(weight.first, std::make_tuple(gridPoint.timeIndex, gridPoint.depthIndex, gridPoint.latIndex, gridPoint.lonIndex));
+        EXPECT_EQ(weight.second, gridPoint.weight);
+        weightSum += gridPoint.weight;
+    }
+    EXPECT_NEAR(weightSum, 1.0, 1e-9);
+    EXPECT_EQ(stencil.waterColumnDepth, structure1.interpolateWaterColumnDepth(betweenAll));
+
+    //Above the top layer only the top layer is used
+    Point onNode3 = Point(-169.21768707482994, -14.53462687854287, 0);
+    structure1.getInterpolationStencil(onNode3, 2507120.0, stencil);
+    ASSERT_EQ(stencil.size, 6);
+    EXPECT_EQ(stencil.points[0].depthIndex, 31);
+    EXPECT_EQ(stencil.points[5].depthIndex, 31);
+
+    EXPECT_THROW(structure1.getInterpolationStencil(Point(-169.2590, -14.57603, 10), betweenAllTime, stencil), std::out_of_range);
+    EXPECT_THROW(structure1.getInterpolationStencil(Point(-170, -14.57603, -100), betweenAllTime, stencil), std::out_of_range);
+    EXPECT_THROW(structure1.getInterpolationStencil(betweenAll, 0, stencil), std::out_of_range);
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
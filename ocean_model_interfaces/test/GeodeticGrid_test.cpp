@@ -4,6 +4,7 @@
 #include "ocean_model_interfaces/util/UtilityFunctions.h"
 
 #include <gtest/gtest.h>
+#include <cmath>
 
 using namespace ocean_model_interfaces;
 
@@ -352,6 +353,72 @@ TEST_F(GeodeticGridTest, OffSetGetModelData)
     EXPECT_FLOAT_EQ(dataXY.depth, 4196.58100612);
 }
 
+TEST_F(GeodeticGridTest, SinglePrecision)
+{
+    GeodeticGridParameters parameters;
+    parameters.modelDirectory = "./ocean_model_interfaces/test_data/geodetic_grid_test/";
+    parameters.depthChunkSize = 5;
+    parameters.latChunkSize = 6;
+    parameters.lonChunkSize = 6;
+    parameters.precision = GeodeticGridParameters::FLOAT32;
+
+    GeodeticGrid singleModel(parameters);
+    singleModel.setOrigin(Point(-169.2590, -14.57603, 0));
+
+    //u and v are doubles in the model files, so they are rounded along with the depths
+    ModelData indexData = singleModel.getDataAtIndex(0, 3, 4, 5);
+    EXPECT_FLOAT_EQ(indexData.u, 0.01317278016358614);
+    EXPECT_FLOAT_EQ(indexData.v, -4.7695075045339763E-4);
+    EXPECT_FLOAT_EQ(indexData.temp, 0.95487386);
+    EXPECT_FLOAT_EQ(indexData.depth, 4192.582992535584);
+
+    ModelData expected = model1.getData(0, 0, -4177.89994465, 2506688.8);
+    ModelData data = singleModel.getData(0, 0, -4177.89994465, 2506688.8);
+    EXPECT_NEAR(expected.u, data.u, 1e-4 * std::abs(expected.u));
+    EXPECT_NEAR(expected.v, data.v, 1e-4 * std::abs(expected.v));
+    EXPECT_NEAR(expected.temp, data.temp, 1e-4 * std::abs(expected.temp));
+    EXPECT_NEAR(expected.depth, data.depth, 1e-4 * expected.depth);
+}
+
+TEST_F(GeodeticGridTest, BatchModelData)
+{
+    model1.setCoordinateType(ModelInterface::CoordinateType::LATLON);
+
+    //Mix of points inside the model, outside in XY, depth and time
+    std::vector<double> lons = {-169.2590, -169.2590, -169.2, 0, -169.2590};
+    std::vector<double> lats = {-14.57603, -14.57603, -14.5, 0, -14.57603};
+    std::vector<double> depths = {-4177.89994465, -100, -500, -100, 100};
+    std::vector<double> times = {2506688.8, 2506688.8, 2506688.8, 2506688.8, 0};
+
+    ModelDataSoA batch;
+    model1.getDataBatch(lons.data(), lats.data(), depths.data(), times.data(), lons.size(), batch);
+    ASSERT_EQ(lons.size(), batch.size());
+
+    for(unsigned int i = 0; i < lons.size(); i++) {
+        ModelData expected;
+        bool inModel = true;
+        try {
+            expected = model1.getData(lons[i], lats[i], depths[i], times[i]);
+        } catch(std::out_of_range const & err) {
+            expected = model1.getDataOutOfRange(lons[i], lats[i], depths[i], times[i]);
+            inModel = false;
+        }
+
+        EXPECT_EQ(inModel, (bool)batch.inModel[i]);
+        if(inModel) {
+            EXPECT_DOUBLE_EQ(expected.u, batch.u[i]);
+            EXPECT_DOUBLE_EQ(expected.v, batch.v[i]);
+            EXPECT_DOUBLE_EQ(expected.w, batch.w[i]);
+            EXPECT_DOUBLE_EQ(expected.temp, batch.temp[i]);
+            EXPECT_DOUBLE_EQ(expected.salt, batch.salt[i]);
+            EXPECT_DOUBLE_EQ(expected.dye, batch.dye[i]);
+            EXPECT_DOUBLE_EQ(expected.depth, batch.depth[i]);
+        } else {
+            EXPECT_TRUE(std::isnan(batch.u[i]));
+        }
+    }
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,93 @@
+#include "ocean_model_interfaces/util/KDTree.h"
+#include "ocean_model_interfaces/util/Point.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <limits>
+
+using namespace ocean_model_interfaces;
+
+static int bruteForceNearest(const std::vector<Point>& points, const Point& testPoint)
+{
+    double closestDistance = std::numeric_limits<double>::max();
+    int closest = -1;
+    for(unsigned int i = 0; i < points.size(); i++)
+    {
+        double distance = (points[i].x - testPoint.x) * (points[i].x - testPoint.x) +
+                          (points[i].y - testPoint.y) * (points[i].y - testPoint.y);
+        if(distance < closestDistance)
+        {
+            closestDistance = distance;
+            closest = i;
+        }
+    }
+
+    return closest;
+}
+
+TEST(KDTreeTest, EmptyTree)
+{
+    KDTree tree;
+    EXPECT_EQ(tree.size(), 0);
+    EXPECT_EQ(tree.nearest(Point(0, 0, 0)), -1);
+
+    KDTree emptyPoints((std::vector<Point>()));
+    EXPECT_EQ(emptyPoints.nearest(Point(0, 0, 0)), -1);
+}
+
+TEST(KDTreeTest, MatchesBruteForce)
+{
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> coordinate(-5000, 5000);
+
+    std::vector<Point> points;
+    for(unsigned int i = 0; i < 5000; i++)
+    {
+        points.push_back(Point(coordinate(generator), coordinate(generator), coordinate(generator)));
+    }
+
+    KDTree tree(points);
+    EXPECT_EQ(tree.size(), points.size());
+
+    //Include points outside the extent of the tree
+    std::uniform_real_distribution<double> queryCoordinate(-7000, 7000);
+    for(unsigned int i = 0; i < 2000; i++)
+    {
+        Point testPoint(queryCoordinate(generator), queryCoordinate(generator), 0);
+        EXPECT_EQ(tree.nearest(testPoint), bruteForceNearest(points, testPoint));
+    }
+}
+
+TEST(KDTreeTest, TiesReturnLowestIndex)
+{
+    //Regular grid with duplicated points so many queries are equidistant to several points
+    std::vector<Point> points;
+    for(unsigned int copy = 0; copy < 2; copy++)
+    {
+        for(int x = 0; x < 20; x++)
+        {
+            for(int y = 0; y < 20; y++)
+            {
+                points.push_back(Point(x * 10.0, y * 10.0, 0));
+            }
+        }
+    }
+
+    KDTree tree(points);
+
+    for(int x = -1; x < 40; x++)
+    {
+        for(int y = -1; y < 40; y++)
+        {
+            Point testPoint(x * 5.0, y * 5.0, 0);
+            EXPECT_EQ(tree.nearest(testPoint), bruteForceNearest(points, testPoint));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,54 @@
+#include "ocean_model_interfaces/util/MappedFile.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+
+using namespace ocean_model_interfaces;
+
+static const std::string TEST_FILE = "./MappedFile_test.bin";
+
+TEST(MappedFileTest, ReadsContents) {
+    std::string contents = "mapped file contents";
+    {
+        std::ofstream out(TEST_FILE, std::ios::binary);
+        out << contents;
+    }
+
+    MappedFile file(TEST_FILE);
+    ASSERT_EQ(contents.size(), file.size());
+    EXPECT_EQ(contents, std::string(file.data(), file.size()));
+
+    //Moving hands the mapping over without unmapping it
+    MappedFile moved(std::move(file));
+    EXPECT_EQ(nullptr, file.data());
+    EXPECT_EQ(0, file.size());
+    EXPECT_EQ(contents, std::string(moved.data(), moved.size()));
+
+    std::remove(TEST_FILE.c_str());
+}
+
+TEST(MappedFileTest, EmptyFile) {
+    {
+        std::ofstream out(TEST_FILE, std::ios::binary);
+    }
+
+    MappedFile file(TEST_FILE);
+    EXPECT_EQ(0, file.size());
+    EXPECT_EQ(nullptr, file.data());
+
+    std::remove(TEST_FILE.c_str());
+}
+
+TEST(MappedFileTest, MissingFile) {
+    EXPECT_THROW(MappedFile("./MappedFile_test_missing.bin"), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
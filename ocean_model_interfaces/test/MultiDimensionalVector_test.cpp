@@ -0,0 +1,74 @@
+#include "ocean_model_interfaces/util/MultiDimensionalVector.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace ocean_model_interfaces;
+
+TEST(MultiDimensionalVectorTest, RowMajorLayout) {
+    MultiDimensionalVector<int, 3> vector({2, 3, 4});
+
+    EXPECT_EQ(2u, vector.size(0));
+    EXPECT_EQ(3u, vector.size(1));
+    EXPECT_EQ(4u, vector.size(2));
+
+    EXPECT_EQ(12u, vector.view().getStrides()[0]);
+    EXPECT_EQ(4u, vector.view().getStrides()[1]);
+    EXPECT_EQ(1u, vector.view().getStrides()[2]);
+    EXPECT_EQ(1 * 12 + 2 * 4 + 3, (int)vector.getOffset(1, 2, 3));
+
+    int n = 0;
+    for(int i = 0; i < 2; i++) {
+        for(int j = 0; j < 3; j++) {
+            for(int k = 0; k < 4; k++) {
+                vector(i, j, k) = n++;
+            }
+        }
+    }
+    for(int i = 0; i < 2 * 3 * 4; i++) {
+        EXPECT_EQ(i, vector.getDataArray()[i]);
+    }
+    EXPECT_EQ(vector.getDataArray() + 16, vector.getDataArrayAtIndex(1, 1, 0));
+}
+
+TEST(MultiDimensionalVectorTest, CheckedAccess) {
+    MultiDimensionalVector<double, 2> vector({3, 5});
+    vector(2, 4) = 7.5;
+
+    EXPECT_EQ(7.5, vector.index(2, 4));
+    EXPECT_THROW(vector.index(3, 0), std::runtime_error);
+    EXPECT_THROW(vector.index(0, 5), std::runtime_error);
+
+    //Offsets past 32 bits do not overflow
+    MultiDimensionalView<const double, 2> large(nullptr, {100000, 100000}, {100000, 1});
+    EXPECT_EQ(99999ull * 100000ull + 99999ull, (unsigned long long)large.getOffset(99999, 99999));
+}
+
+TEST(MultiDimensionalVectorTest, SlicesShareMemory) {
+    MultiDimensionalVector<int, 3> vector({2, 3, 4});
+
+    MultiDimensionalView<int, 2> slice = vector.slice(1);
+    EXPECT_EQ(3u, slice.size(0));
+    EXPECT_EQ(4u, slice.size(1));
+    EXPECT_EQ(vector.getDataArrayAtIndex(1, 0, 0), slice.getDataArray());
+
+    slice(2, 3) = 42;
+    EXPECT_EQ(42, vector(1, 2, 3));
+
+    MultiDimensionalView<int, 1> row = slice.slice(2);
+    EXPECT_EQ(4u, row.size(0));
+    row(0) = 17;
+    EXPECT_EQ(17, vector(1, 2, 0));
+    EXPECT_THROW(row.index(4), std::runtime_error);
+
+    const MultiDimensionalVector<int, 3>& constVector = vector;
+    MultiDimensionalView<const int, 1> constRow = constVector.slice(1).slice(2);
+    EXPECT_EQ(17, constRow(0));
+    EXPECT_EQ(42, constRow.index(3));
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,65 @@
+#include "ocean_model_interfaces/util/NetCDFFilePool.h"
+#include "ocean_model_interfaces/util/NetCDFMutex.h"
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace ocean_model_interfaces;
+
+const std::string file0 = "./ocean_model_interfaces/test_data/box_plume_split/box_plume_0001_0.nc";
+const std::string file1 = "./ocean_model_interfaces/test_data/box_plume_split/box_plume_0001_1.nc";
+
+TEST(NetCDFFilePoolTest, ReusesOpenFiles) {
+    std::lock_guard<std::mutex> lock(getNetCDFMutex());
+    NetCDFFilePool pool;
+
+    netCDF::NcFile& first = pool.getFile(file0);
+    netCDF::NcFile& second = pool.getFile(file0);
+
+    EXPECT_EQ(&first, &second);
+    EXPECT_EQ(1, pool.getOpenFileCount());
+}
+
+TEST(NetCDFFilePoolTest, LimitsOpenFiles) {
+    std::lock_guard<std::mutex> lock(getNetCDFMutex());
+    NetCDFFilePool pool(1);
+
+    pool.getFile(file0);
+    pool.getFile(file1);
+    EXPECT_EQ(1, pool.getOpenFileCount());
+
+    //Files that were closed are opened again when needed
+    EXPECT_FALSE(pool.getVar(file0, "temp").isNull());
+    EXPECT_EQ(1, pool.getOpenFileCount());
+
+    pool.closeAll();
+    EXPECT_EQ(0, pool.getOpenFileCount());
+}
+
+TEST(NetCDFFilePoolTest, GetVar) {
+    std::lock_guard<std::mutex> lock(getNetCDFMutex());
+    NetCDFFilePool pool;
+
+    netCDF::NcVar temp = pool.getVar(file0, "temp");
+    ASSERT_FALSE(temp.isNull());
+    EXPECT_EQ("temp", temp.getName());
+
+    EXPECT_TRUE(pool.getVar(file0, "not_a_variable").isNull());
+}
+
+TEST(NetCDFFilePoolTest, MissingFile) {
+    std::lock_guard<std::mutex> lock(getNetCDFMutex());
+    NetCDFFilePool pool(1);
+
+    pool.getFile(file0);
+    EXPECT_ANY_THROW(pool.getFile("./ocean_model_interfaces/test_data/not_a_file.nc"));
+
+    //A file that fails to open does not close the open ones
+    EXPECT_EQ(1, pool.getOpenFileCount());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
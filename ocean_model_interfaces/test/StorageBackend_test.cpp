@@ -0,0 +1,236 @@
+#include "ocean_model_interfaces/util/MemoryStorageBackend.h"
+#include "ocean_model_interfaces/fvcom/FVCOMChunk.h"
+#include "ocean_model_interfaces/geodetic_grid/GeodeticGridChunk.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ocean_model_interfaces;
+
+/**
+ * Value stored at an index of a test variable, unique for each variable and index
+ */
+static float testValue(unsigned int variable, unsigned int a, unsigned int b, unsigned int c, unsigned int d = 0)
+{
+    return variable * 10000 + a * 1000 + b * 100 + c * 10 + d;
+}
+
+TEST(MemoryStorageBackendTest, ReadsHyperslabs) {
+    std::vector<float> values;
+    for(unsigned int i = 0; i < 2; i++) {
+        for(unsigned int j = 0; j < 3; j++) {
+            for(unsigned int k = 0; k < 4; k++) {
+                values.push_back(testValue(0, i, j, k));
+            }
+        }
+    }
+
+    MemoryStorageBackend backend;
+    backend.setVariable("file", "var", {2, 3, 4}, values);
+    EXPECT_TRUE(backend.hasVariable("file", "var"));
+    EXPECT_FALSE(backend.hasVariable("file", "other"));
+    EXPECT_FALSE(backend.hasVariable("other", "var"));
+
+    std::vector<float> floats(2 * 2 * 3);
+    backend.read("file", "var", {0, 1, 1}, {2, 2, 3}, floats.data());
+    size_t n = 0;
+    for(unsigned int i = 0; i < 2; i++) {
+        for(unsigned int j = 1; j < 3; j++) {
+            for(unsigned int k = 1; k < 4; k++) {
+                EXPECT_EQ(testValue(0, i, j, k), floats[n++]);
+            }
+        }
+    }
+
+    //A single value converted to double
+    double value;
+    backend.read("file", "var", {1, 2, 3}, {1, 1, 1}, &value);
+    EXPECT_EQ(testValue(0, 1, 2, 3), value);
+
+    //Nothing is written for an empty hyperslab
+    value = -1;
+    backend.read("file", "var", {1, 0, 0}, {1, 0, 4}, &value);
+    EXPECT_EQ(-1, value);
+}
+
+TEST(MemoryStorageBackendTest, RejectsBadReads) {
+    MemoryStorageBackend backend;
+    EXPECT_THROW(backend.setVariable("file", "var", {2, 3}, std::vector<float>(5)), std::runtime_error);
+    backend.setVariable("file", "var", {2, 3}, std::vector<float>(6));
+
+    std::vector<float> out(6);
+    EXPECT_THROW(backend.read("file", "other", {0, 0}, {1, 1}, out.data()), std::runtime_error);
+    EXPECT_THROW(backend.read("file", "var", {0}, {1}, out.data()), std::runtime_error);
+    EXPECT_THROW(backend.read("file", "var", {1, 0}, {2, 1}, out.data()), std::runtime_error);
+    EXPECT_THROW(backend.read("file", "var", {0, 4}, {1, 0}, out.data()), std::runtime_error);
+}
+
+TEST(StorageBackendTest, FVCOMChunkReadsAcrossFiles) {
+    const unsigned int numNodes = 6;
+    const unsigned int numTriangles = 4;
+    const unsigned int numSiglays = 3;
+
+    //Two files, times 0-1 and 2-4. Only the first file has dye.
+    std::vector<FVCOMStructure::ModelFile> modelFiles(2);
+    modelFiles[0].filename = "first";
+    modelFiles[0].startTime = 0;
+    modelFiles[0].startTimeIndex = 0;
+    modelFiles[0].timeDim = 2;
+    modelFiles[1].filename = "second";
+    modelFiles[1].startTime = 2;
+    modelFiles[1].startTimeIndex = 2;
+    modelFiles[1].timeDim = 3;
+
+    MemoryStorageBackend backend;
+    const std::vector<std::string>& names = FVCOMChunk::getVariableNames();
+    for(const FVCOMStructure::ModelFile& file : modelFiles) {
+        for(unsigned int var = 0; var < FVCOMChunk::NUM_VARIABLES; var++) {
+            if(var == FVCOMChunk::DYE && file.filename == "second") {
+                continue;
+            }
+
+            unsigned int numElements = var < FVCOMChunk::U ? numNodes : numTriangles;
+            std::vector<float> values;
+            for(unsigned int t = 0; t < file.timeDim; t++) {
+                for(unsigned int s = 0; s < numSiglays; s++) {
+                    for(unsigned int e = 0; e < numElements; e++) {
+                        values.push_back(testValue(var, file.startTimeIndex + t, s, e));
+                    }
+                }
+            }
+            backend.setVariable(file.filename, names[var], {file.timeDim, numSiglays, numElements}, values);
+        }
+    }
+
+    FVCOMStructure::ChunkInfo chunkInfo = {};
+    chunkInfo.siglayStart = 1;
+    chunkInfo.siglaySize = 2;
+    chunkInfo.timeStart = 1;
+    chunkInfo.timeSize = 3;
+
+    std::vector<unsigned int> nodes = {5, 1, 3};
+    std::vector<unsigned int> triangles = {2, 0};
+    FVCOMChunk chunk(modelFiles, nodes, triangles, chunkInfo, backend);
+
+    for(unsigned int t = 0; t < chunkInfo.timeSize; t++) {
+        for(unsigned int s = 0; s < chunkInfo.siglaySize; s++) {
+            unsigned int modelTime = chunkInfo.timeStart + t;
+            unsigned int modelSiglay = chunkInfo.siglayStart + s;
+
+            for(unsigned int n = 0; n < nodes.size(); n++) {
+                FVCOMChunk::NodeData data = chunk.getNodeData(n, modelSiglay, modelTime);
+                EXPECT_EQ(testValue(FVCOMChunk::TEMP, modelTime, modelSiglay, nodes[n]), data.temp);
+                EXPECT_EQ(testValue(FVCOMChunk::SALT, modelTime, modelSiglay, nodes[n]), data.salt);
+
+                //Dye is only used if every file has it
+                EXPECT_EQ(0, data.dye);
+            }
+            for(unsigned int n = 0; n < triangles.size(); n++) {
+                FVCOMChunk::TriangleData data = chunk.getTriangleData(n, modelSiglay, modelTime);
+                EXPECT_EQ(testValue(FVCOMChunk::U, modelTime, modelSiglay, triangles[n]), data.u);
+                EXPECT_EQ(testValue(FVCOMChunk::V, modelTime, modelSiglay, triangles[n]), data.v);
+                EXPECT_EQ(testValue(FVCOMChunk::W, modelTime, modelSiglay, triangles[n]), data.w);
+            }
+        }
+    }
+}
+
+TEST(StorageBackendTest, GeodeticGridChunkReadsAcrossFiles) {
+    const unsigned int numDepths = 2;
+    const unsigned int numLats = 3;
+    const unsigned int numLons = 4;
+
+    std::vector<GeodeticGridStructure::ModelFile> modelFiles(2);
+    modelFiles[0].filename = "first";
+    modelFiles[0].startTime = 0;
+    modelFiles[0].startTimeIndex = 0;
+    modelFiles[0].timeDim = 2;
+    modelFiles[1].filename = "second";
+    modelFiles[1].startTime = 2;
+    modelFiles[1].startTimeIndex = 2;
+    modelFiles[1].timeDim = 2;
+
+    MemoryStorageBackend backend;
+    const std::vector<std::string>& names = GeodeticGridChunk::getVariableNames();
+    for(const GeodeticGridStructure::ModelFile& file : modelFiles) {
+        for(unsigned int var = 0; var < names.size(); var++) {
+            std::vector<float> values;
+            for(unsigned int t = 0; t < file.timeDim; t++) {
+                for(unsigned int d = 0; d < numDepths; d++) {
+                    for(unsigned int lat = 0; lat < numLats; lat++) {
+                        for(unsigned int lon = 0; lon < numLons; lon++) {
+                            values.push_back(testValue(var, file.startTimeIndex + t, d, lat, lon));
+                        }
+                    }
+                }
+            }
+            backend.setVariable(file.filename, names[var], {file.timeDim, numDepths, numLats, numLons}, values);
+        }
+    }
+
+    GeodeticGridStructure::ChunkInfo info = {};
+    info.timeStart = 0;
+    info.timeSize = 3;
+    info.depthStart = 1;
+    info.depthSize = 1;
+    info.latStart = 1;
+    info.latSize = 2;
+    info.lonStart = 2;
+    info.lonSize = 2;
+
+    GeodeticGridChunk chunk(info, modelFiles, backend, GeodeticGridParameters::FLOAT32);
+    GeodeticGridChunk doubleChunk(info, modelFiles, backend);
+    EXPECT_EQ(GeodeticGridParameters::FLOAT32, chunk.getPrecision());
+    EXPECT_EQ(GeodeticGridParameters::FLOAT64, doubleChunk.getPrecision());
+    EXPECT_LT(chunk.getMemoryUsage(), doubleChunk.getMemoryUsage());
+
+    for(unsigned int t = info.timeStart; t < info.timeStart + info.timeSize; t++) {
+        for(unsigned int lat = info.latStart; lat < info.latStart + info.latSize; lat++) {
+            for(unsigned int lon = info.lonStart; lon < info.lonStart + info.lonSize; lon++) {
+                ModelData data = chunk.getData(t, info.depthStart, lat, lon);
+                EXPECT_EQ(testValue(0, t, info.depthStart, lat, lon), data.u);
+                EXPECT_EQ(testValue(1, t, info.depthStart, lat, lon), data.v);
+                EXPECT_EQ(testValue(2, t, info.depthStart, lat, lon), data.w);
+                EXPECT_EQ(testValue(3, t, info.depthStart, lat, lon), data.salt);
+                EXPECT_EQ(testValue(4, t, info.depthStart, lat, lon), data.temp);
+                EXPECT_EQ(testValue(5, t, info.depthStart, lat, lon), data.dye);
+
+                //The float values read from the files are the same at either precision
+                EXPECT_EQ(data.u, doubleChunk.getData(t, info.depthStart, lat, lon).u);
+                EXPECT_EQ(data.dye, doubleChunk.getData(t, info.depthStart, lat, lon).dye);
+
+                //Every variable of a grid point is next to each other
+                MultiDimensionalView<const float, 4> timeSlice = chunk.getTimeSlice<float>(t);
+                for(unsigned int var = 0; var < GeodeticGridChunk::NUM_VARIABLES; var++) {
+                    EXPECT_EQ(testValue(var, t, info.depthStart, lat, lon), timeSlice(0, lat - info.latStart, lon - info.lonStart, var));
+                }
+
+                ModelData weighted = {};
+                chunk.addWeightedValues(chunk.getOffset(t, info.depthStart, lat, lon), 0.5, weighted);
+                EXPECT_EQ(data.temp * 0.5, weighted.temp);
+                EXPECT_EQ(data.salt * 0.5, weighted.salt);
+            }
+        }
+    }
+
+    EXPECT_EQ(chunk.getOffset(0, 1, 1, 2) + GeodeticGridChunk::NUM_VARIABLES, chunk.getOffset(0, 1, 1, 3));
+    std::vector<float> temps = chunk.getValues("temp");
+    ASSERT_EQ(info.timeSize * info.depthSize * info.latSize * info.lonSize, temps.size());
+    EXPECT_EQ(testValue(4, 0, 1, 1, 2), temps[0]);
+    EXPECT_EQ(testValue(4, 0, 1, 1, 3), temps[1]);
+
+    EXPECT_THROW(chunk.getData(0, 0, 1, 2), std::runtime_error);
+    EXPECT_THROW(chunk.getData(0, 1, 1, 4), std::runtime_error);
+    EXPECT_THROW(chunk.getData(3, 1, 1, 2), std::runtime_error);
+    EXPECT_THROW(chunk.getTimeSlice<float>(3), std::runtime_error);
+    EXPECT_THROW(chunk.getTimeSlice<double>(0), std::runtime_error);
+    EXPECT_NO_THROW(doubleChunk.getTimeSlice<double>(0));
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,194 @@
+#include "ocean_model_interfaces/fvcom/SyntheticFVCOM.h"
+#include "ocean_model_interfaces/fvcom/FVCOM.h"
+#include "ocean_model_interfaces/geodetic_grid/SyntheticGeodeticGrid.h"
+#include "ocean_model_interfaces/geodetic_grid/GeodeticGrid.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+using namespace ocean_model_interfaces;
+
+#define SECONDS_IN_DAY 86400
+
+static const std::string FVCOM_DIRECTORY = "./SyntheticModels_test_fvcom";
+static const std::string GRID_DIRECTORY = "./SyntheticModels_test_grid";
+
+static void expectSameData(const ModelData& expected, const ModelData& actual) {
+    EXPECT_EQ(expected.u, actual.u);
+    EXPECT_EQ(expected.v, actual.v);
+    EXPECT_EQ(expected.w, actual.w);
+    EXPECT_EQ(expected.temp, actual.temp);
+    EXPECT_EQ(expected.salt, actual.salt);
+    EXPECT_EQ(expected.dye, actual.dye);
+}
+
+TEST(SyntheticModelsTest, BackendValues) {
+    std::vector<SyntheticStorageBackend::File> files = {{"a.nc", 2}, {"b.nc", 3}};
+    std::vector<SyntheticStorageBackend::Variable> variables = {{"temp", {4, 5}, 10.0f, 2.0f}};
+    SyntheticStorageBackend backend(files, variables);
+
+    EXPECT_TRUE(backend.hasVariable("a.nc", "temp"));
+    EXPECT_TRUE(backend.hasVariable("/any/directory/b.nc", "temp"));
+    EXPECT_FALSE(backend.hasVariable("c.nc", "temp"));
+    EXPECT_FALSE(backend.hasVariable("a.nc", "salt"));
+
+    //Times continue from one file to the next
+    std::vector<float> values(3 * 2 * 2);
+    backend.read("b.nc", "temp", {0, 1, 3}, {3, 2, 2}, values.data());
+    size_t n = 0;
+    for(unsigned int t = 0; t < 3; t++) {
+        for(unsigned int layer = 1; layer < 3; layer++) {
+            for(unsigned int element = 3; element < 5; element++) {
+                float value = backend.getValue(0, 2 + t, layer, element);
+                EXPECT_EQ(value, values[n++]);
+                EXPECT_LE(8.0f, value);
+                EXPECT_GE(12.0f, value);
+            }
+        }
+    }
+
+    EXPECT_THROW(backend.read("a.nc", "temp", {1, 0, 0}, {2, 1, 1}, values.data()), std::runtime_error);
+    EXPECT_THROW(backend.read("c.nc", "temp", {0, 0, 0}, {1, 1, 1}, values.data()), std::runtime_error);
+}
+
+TEST(SyntheticModelsTest, FVCOM) {
+    SyntheticFVCOMParameters parameters;
+    parameters.nodesX = 30;
+    parameters.nodesY = 20;
+    parameters.nodeSpacing = 50;
+    parameters.siglays = 5;
+    parameters.timeSteps = 7;
+    parameters.timeStepsPerFile = 3;
+    writeSyntheticFVCOM(FVCOM_DIRECTORY, parameters);
+
+    FVCOM model(FVCOM_DIRECTORY, 300, 300, 2, 2, 100);
+    FVCOM computed(FVCOM_DIRECTORY, 300, 300, 2, 2, 100);
+    computed.setStorageBackend(createSyntheticFVCOMBackend(parameters));
+
+    //The data read from the files is the data the backend computes
+    int compared = 0;
+    for(double x = -700; x <= 700; x += 130) {
+        for(double y = -450; y <= 450; y += 110) {
+            for(double time : {0.0, 0.1, 0.2}) {
+                ModelData expected = model.getData(x, y, -20, time * SECONDS_IN_DAY);
+                expectSameData(expected, computed.getData(x, y, -20, time * SECONDS_IN_DAY));
+                compared++;
+            }
+        }
+    }
+    EXPECT_EQ(11 * 9 * 3, compared);
+
+    //Without data the files only hold the structure, and the backend provides the values
+    parameters.writeData = false;
+    writeSyntheticFVCOM(FVCOM_DIRECTORY, parameters);
+    FVCOM structureOnly(FVCOM_DIRECTORY, 300, 300, 2, 2, 100);
+    structureOnly.setStorageBackend(createSyntheticFVCOMBackend(parameters));
+    expectSameData(model.getData(120, -35, -30, 0.2 * SECONDS_IN_DAY), structureOnly.getData(120, -35, -30, 0.2 * SECONDS_IN_DAY));
+
+    boost::filesystem::remove_all(FVCOM_DIRECTORY);
+}
+
+TEST(SyntheticModelsTest, GeodeticGrid) {
+    SyntheticGeodeticGridParameters parameters;
+    parameters.lats = 12;
+    parameters.lons = 15;
+    parameters.depths = 4;
+    parameters.timeSteps = 3;
+    writeSyntheticGeodeticGrid(GRID_DIRECTORY, parameters);
+
+    GeodeticGridParameters gridParameters;
+    gridParameters.modelDirectory = GRID_DIRECTORY;
+    gridParameters.depthChunkSize = 3;
+    gridParameters.latChunkSize = 5;
+    gridParameters.lonChunkSize = 6;
+
+    GeodeticGrid model(gridParameters);
+    GeodeticGrid computed(gridParameters);
+    computed.setStorageBackend(createSyntheticGeodeticGridBackend(parameters));
+
+    for(unsigned int t = 0; t < parameters.timeSteps; t++) {
+        for(unsigned int d = 0; d < parameters.depths; d++) {
+            for(unsigned int lat = 0; lat < parameters.lats; lat++) {
+                for(unsigned int lon = 0; lon < parameters.lons; lon++) {
+                    expectSameData(model.getDataAtIndex(t, d, lat, lon), computed.getDataAtIndex(t, d, lat, lon));
+                }
+            }
+        }
+    }
+
+    boost::filesystem::remove_all(GRID_DIRECTORY);
+}
+
+TEST(SyntheticModelsTest, GeodeticGridLayerOrder) {
+    SyntheticGeodeticGridParameters parameters;
+    parameters.lats = 6;
+    parameters.lons = 7;
+    parameters.depths = 8;
+    parameters.timeSteps = 2;
+
+    for(bool surfaceFirst : {false, true}) {
+        parameters.surfaceFirst = surfaceFirst;
+        writeSyntheticGeodeticGrid(GRID_DIRECTORY, parameters);
+
+        for(GeodeticGridParameters::Precision precision : {GeodeticGridParameters::FLOAT32, GeodeticGridParameters::FLOAT64}) {
+            GeodeticGridParameters gridParameters;
+            gridParameters.modelDirectory = GRID_DIRECTORY;
+            gridParameters.precision = precision;
+            GeodeticGridStructure structure(gridParameters);
+
+            //At a grid point the layers are evenly spaced from the seafloor to the surface
+            const unsigned int latIndex = 2;
+            const unsigned int lonIndex = 3;
+            Point point(parameters.minLon + lonIndex * parameters.spacing, parameters.minLat + latIndex * parameters.spacing, 0);
+            double waterColumnDepth = structure.indexWaterColumnDepth(latIndex, lonIndex);
+            auto layerDepth = [&](double layerFromSeafloor) {
+                return -waterColumnDepth * (1.0 - (layerFromSeafloor + 0.5) / parameters.depths);
+            };
+            auto modelLayer = [&](unsigned int layerFromSeafloor) {
+                return surfaceFirst ? parameters.depths - 1 - layerFromSeafloor : layerFromSeafloor;
+            };
+            auto depthWeights = [&](double z) {
+                point.z = z;
+                std::vector<double> weights(parameters.depths, 0.0);
+                for(auto const& weight : structure.getDataInterpolationWeights(point, 0)) {
+                    weights[std::get<1>(weight.first)] += weight.second;
+                }
+                return weights;
+            };
+
+            std::vector<double> between = depthWeights(layerDepth(2.5));
+            EXPECT_NEAR(0.5, between[modelLayer(2)], 1e-3);
+            EXPECT_NEAR(0.5, between[modelLayer(3)], 1e-3);
+
+            std::vector<double> quarter = depthWeights(layerDepth(5.25));
+            EXPECT_NEAR(0.75, quarter[modelLayer(5)], 1e-3);
+            EXPECT_NEAR(0.25, quarter[modelLayer(6)], 1e-3);
+
+            EXPECT_NEAR(1.0, depthWeights(layerDepth(4))[modelLayer(4)], 1e-3);
+            EXPECT_NEAR(1.0, depthWeights(-1)[modelLayer(parameters.depths - 1)], 1e-9);
+            EXPECT_NEAR(1.0, depthWeights(layerDepth(-0.25))[modelLayer(0)], 1e-9);
+        }
+    }
+
+    boost::filesystem::remove_all(GRID_DIRECTORY);
+}
+
+TEST(SyntheticModelsTest, RejectsEmptyModels) {
+    SyntheticFVCOMParameters fvcomParameters;
+    fvcomParameters.nodesX = 1;
+    EXPECT_THROW(writeSyntheticFVCOM(FVCOM_DIRECTORY, fvcomParameters), std::runtime_error);
+
+    SyntheticGeodeticGridParameters gridParameters;
+    gridParameters.timeSteps = 0;
+    EXPECT_THROW(createSyntheticGeodeticGridBackend(gridParameters), std::runtime_error);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
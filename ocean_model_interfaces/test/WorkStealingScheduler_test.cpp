@@ -0,0 +1,97 @@
+#include "ocean_model_interfaces/util/WorkStealingScheduler.h"
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+using namespace ocean_model_interfaces;
+
+TEST(WorkStealingSchedulerTest, SingleThread) {
+    WorkStealingScheduler scheduler(1);
+    EXPECT_EQ(1, scheduler.getThreadCount());
+
+    std::vector<size_t> order;
+    scheduler.run(5, [&order](size_t task, unsigned int worker) {
+        EXPECT_EQ(0, worker);
+        order.push_back(task);
+    });
+
+    //A single worker runs the tasks in order
+    ASSERT_EQ(5, order.size());
+    for(size_t i = 0; i < order.size(); i++) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(WorkStealingSchedulerTest, ZeroThreads) {
+    WorkStealingScheduler scheduler(0);
+    EXPECT_EQ(1, scheduler.getThreadCount());
+}
+
+TEST(WorkStealingSchedulerTest, NoTasks) {
+    WorkStealingScheduler scheduler(4);
+    std::atomic<int> count(0);
+    scheduler.run(0, [&count](size_t, unsigned int) { count++; });
+    EXPECT_EQ(0, count);
+}
+
+TEST(WorkStealingSchedulerTest, RunsEveryTaskOnce) {
+    WorkStealingScheduler scheduler(4);
+
+    for(size_t taskCount : {1, 3, 4, 17, 1000}) {
+        std::vector<std::atomic<int>> runs(taskCount);
+        for(auto& run : runs) {
+            run = 0;
+        }
+
+        scheduler.run(taskCount, [&runs](size_t task, unsigned int worker) {
+            EXPECT_LT(worker, 4u);
+            runs[task]++;
+        });
+
+        for(size_t i = 0; i < taskCount; i++) {
+            EXPECT_EQ(1, runs[i]) << "task " << i << " of " << taskCount;
+        }
+    }
+}
+
+TEST(WorkStealingSchedulerTest, StealsFromSlowWorker) {
+    WorkStealingScheduler scheduler(4);
+    std::vector<std::atomic<int>> tasksPerWorker(4);
+    for(auto& count : tasksPerWorker) {
+        count = 0;
+    }
+
+    //The first quarter of the tasks starts on worker 0 and is much slower than the rest
+    scheduler.run(40, [&tasksPerWorker](size_t task, unsigned int worker) {
+        if(task < 10) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        tasksPerWorker[worker]++;
+    });
+
+    EXPECT_LT(tasksPerWorker[0], 10);
+    EXPECT_EQ(40, tasksPerWorker[0] + tasksPerWorker[1] + tasksPerWorker[2] + tasksPerWorker[3]);
+}
+
+TEST(WorkStealingSchedulerTest, RethrowsException) {
+    WorkStealingScheduler scheduler(3);
+    EXPECT_THROW(scheduler.run(100, [](size_t task, unsigned int) {
+        if(task == 42) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+
+    //The scheduler can be reused after a failure
+    std::atomic<int> count(0);
+    scheduler.run(10, [&count](size_t, unsigned int) { count++; });
+    EXPECT_EQ(10, count);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
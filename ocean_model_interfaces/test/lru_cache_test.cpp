@@ -36,6 +36,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ocean_model_interfaces/util/LRUCache.h"
 #include <gtest/gtest.h>
 
+#include <vector>
+
 using namespace ocean_model_interfaces;
 
 const int NUM_OF_TEST2_RECORDS = 100;
@@ -100,6 +102,18 @@ TEST(LRUCacheTest, KeepLastUsed) {
     }
 }
 
+TEST(LRUCacheTest, MovesValues) {
+    LRUCache<int, std::vector<int>> cache_lru(2);
+    std::vector<int> values(100, 3);
+    const int* data = values.data();
+
+    cache_lru.put(1, std::move(values));
+
+    //The cache owns the original buffer instead of a copy
+    EXPECT_EQ(data, cache_lru.get(1).data());
+    EXPECT_EQ(100, cache_lru.get(1).size());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
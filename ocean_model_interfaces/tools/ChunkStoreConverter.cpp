@@ -0,0 +1,73 @@
+#include "ocean_model_interfaces/fvcom/FVCOM.h"
+#include "ocean_model_interfaces/geodetic_grid/GeodeticGrid.h"
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <exception>
+
+using namespace ocean_model_interfaces;
+
+static void printUsage()
+{
+    std::cerr << "Usage:" << std::endl
+              << "  ChunkStoreConverter fvcom <model directory> <store file> <x chunk size> <y chunk size> <siglay chunk size> <time chunk size>" << std::endl
+              << "  ChunkStoreConverter geodetic <model directory> <store file> <time chunk size> <depth chunk size> <lat chunk size> <lon chunk size>" << std::endl
+              << "The chunk sizes must match the ones the model is opened with when the store is used." << std::endl;
+}
+
+/**
+ * Rewrites an FVCOM or geodetic grid model directory into a chunk store, so later runs can load chunks
+ * by mapping the store instead of reading the netCDF files. See FVCOM::setChunkStore and GeodeticGrid::setChunkStore.
+ */
+int main(int argc, char **argv)
+{
+    if(argc != 8)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::string type = argv[1];
+    std::string directory = argv[2];
+    std::string storeFile = argv[3];
+
+    try
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        if(type == "fvcom")
+        {
+            FVCOM model(directory, std::stoi(argv[4]), std::stoi(argv[5]), std::stoi(argv[6]), std::stoi(argv[7]), 1);
+            model.writeChunkStore(storeFile);
+        }
+        else if(type == "geodetic")
+        {
+            GeodeticGridParameters parameters;
+            parameters.modelDirectory = directory;
+            parameters.timeChunkSize = std::stoi(argv[4]);
+            parameters.depthChunkSize = std::stoi(argv[5]);
+            parameters.latChunkSize = std::stoi(argv[6]);
+            parameters.lonChunkSize = std::stoi(argv[7]);
+            parameters.cacheSize = 1;
+
+            GeodeticGrid model(parameters);
+            model.writeChunkStore(storeFile);
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Wrote " << storeFile << " in " << elapsed.count() << " s" << std::endl;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Could not convert " << directory << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
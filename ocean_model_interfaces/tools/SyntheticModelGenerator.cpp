@@ -0,0 +1,82 @@
+#include "ocean_model_interfaces/fvcom/SyntheticFVCOM.h"
+#include "ocean_model_interfaces/geodetic_grid/SyntheticGeodeticGrid.h"
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <exception>
+
+using namespace ocean_model_interfaces;
+
+static void printUsage()
+{
+    std::cerr << "Usage:" << std::endl
+              << "  SyntheticModelGenerator fvcom <directory> <nodes x> <nodes y> <siglays> <time steps> <time steps per file> [--no-data]" << std::endl
+              << "  SyntheticModelGenerator geodetic <directory> <lats> <lons> <depths> <time steps> <time steps per file> [--no-data]" << std::endl
+              << "With --no-data only the structure is written, and chunks must be loaded through the matching synthetic storage backend." << std::endl;
+}
+
+/**
+ * Writes a synthetic FVCOM or geodetic grid model of any size for benchmarks. See writeSyntheticFVCOM and
+ * writeSyntheticGeodeticGrid.
+ */
+int main(int argc, char **argv)
+{
+    bool writeData = true;
+    if(argc == 9 && std::string(argv[8]) == "--no-data")
+    {
+        writeData = false;
+        argc--;
+    }
+    if(argc != 8)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::string type = argv[1];
+    std::string directory = argv[2];
+
+    try
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        if(type == "fvcom")
+        {
+            SyntheticFVCOMParameters parameters;
+            parameters.nodesX = std::stoi(argv[3]);
+            parameters.nodesY = std::stoi(argv[4]);
+            parameters.siglays = std::stoi(argv[5]);
+            parameters.timeSteps = std::stoi(argv[6]);
+            parameters.timeStepsPerFile = std::stoi(argv[7]);
+            parameters.writeData = writeData;
+            writeSyntheticFVCOM(directory, parameters);
+        }
+        else if(type == "geodetic")
+        {
+            SyntheticGeodeticGridParameters parameters;
+            parameters.lats = std::stoi(argv[3]);
+            parameters.lons = std::stoi(argv[4]);
+            parameters.depths = std::stoi(argv[5]);
+            parameters.timeSteps = std::stoi(argv[6]);
+            parameters.timeStepsPerFile = std::stoi(argv[7]);
+            parameters.writeData = writeData;
+            writeSyntheticGeodeticGrid(directory, parameters);
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Wrote " << directory << " in " << elapsed.count() << " s" << std::endl;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Could not write " << directory << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
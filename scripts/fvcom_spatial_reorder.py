@@ -0,0 +1,128 @@
+import argparse
+import os
+import numpy as np
+import xarray as xr
+
+# Variables that hold 1 based node or element numbers, remapped to the new numbering.
+# Zero marks a missing neighbor in the FVCOM connectivity variables and is kept as is.
+NODE_INDEX_VARIABLES = ["nv", "nbsn"]
+ELEMENT_INDEX_VARIABLES = ["nbe", "nbve"]
+
+# Bits of precision per axis used to build the Hilbert curve
+HILBERT_BITS = 16
+
+def hilbert_index(x, y, bits=HILBERT_BITS):
+    """Distance of each point along a Hilbert curve over the bounding box of the points"""
+    n = 1 << bits
+    scale = n - 1
+
+    def quantize(values):
+        span = values.max() - values.min()
+        if span == 0:
+            return np.zeros(values.shape, dtype=np.int64)
+        return np.floor((values - values.min()) / span * scale).astype(np.int64)
+
+    xi = quantize(np.asarray(x, dtype=np.float64))
+    yi = quantize(np.asarray(y, dtype=np.float64))
+    d = np.zeros(xi.shape, dtype=np.int64)
+
+    s = n >> 1
+    while s > 0:
+        rx = ((xi & s) > 0).astype(np.int64)
+        ry = ((yi & s) > 0).astype(np.int64)
+        d += s * s * ((3 * rx) ^ ry)
+
+        # Rotate the quadrant so the curve stays continuous
+        flip = (ry == 0) & (rx == 1)
+        xi = np.where(flip, n - 1 - xi, xi)
+        yi = np.where(flip, n - 1 - yi, yi)
+        swap = ry == 0
+        xi, yi = np.where(swap, yi, xi), np.where(swap, xi, yi)
+        s >>= 1
+
+    return d
+
+def remap_indices(values, new_index_of_old):
+    """Remap 1 based indices, leaving 0 (no neighbor) unchanged"""
+    values = np.asarray(values)
+    remapped = values.copy()
+    valid = values > 0
+    remapped[valid] = new_index_of_old[values[valid] - 1] + 1
+    return remapped
+
+def compute_order(model_file):
+    """Hilbert order of the nodes and elements of a model"""
+    ds = xr.open_dataset(model_file, decode_times=False)
+    node_order = np.argsort(hilbert_index(ds["x"].values, ds["y"].values), kind="stable")
+    element_order = np.argsort(hilbert_index(ds["xc"].values, ds["yc"].values), kind="stable")
+    ds.close()
+    return node_order, element_order
+
+def process_single_file(input_file, output_file, node_order, element_order):
+    """Write a copy of one model file with the nodes and elements in Hilbert order"""
+    print(f"\nProcessing: {os.path.basename(input_file)}")
+
+    ds = xr.open_dataset(input_file, decode_times=False)
+    if ds.sizes["node"] != len(node_order) or ds.sizes["nele"] != len(element_order):
+        ds.close()
+        raise ValueError("All model files must share the same mesh")
+
+    new_node_of_old = np.empty(len(node_order), dtype=np.int64)
+    new_node_of_old[node_order] = np.arange(len(node_order))
+    new_element_of_old = np.empty(len(element_order), dtype=np.int64)
+    new_element_of_old[element_order] = np.arange(len(element_order))
+
+    # Permute every variable along its node and element dimensions
+    print("  Reordering nodes and elements...")
+    reordered = ds.isel(node=node_order, nele=element_order)
+
+    for name in NODE_INDEX_VARIABLES:
+        if name in reordered.variables:
+            reordered[name].values = remap_indices(reordered[name].values, new_node_of_old)
+    for name in ELEMENT_INDEX_VARIABLES:
+        if name in reordered.variables:
+            reordered[name].values = remap_indices(reordered[name].values, new_element_of_old)
+
+    # The library uses these to keep reporting the original numbering
+    reordered["original_node"] = xr.DataArray(node_order.astype(np.int32), dims=["node"],
+                                              attrs={"long_name": "original 0 based index of each node"})
+    reordered["original_nele"] = xr.DataArray(element_order.astype(np.int32), dims=["nele"],
+                                              attrs={"long_name": "original 0 based index of each element"})
+
+    print(f"  Saving to {os.path.basename(output_file)}...")
+    reordered.to_netcdf(output_file)
+
+    print(f"  ✓ Saved: {os.path.basename(output_file)}")
+    ds.close()
+
+def main(args):
+    os.makedirs(args.output_path, exist_ok=True)
+    print(f"Output directory: {args.output_path}")
+    print(f"Processing {len(args.model_files)} files...")
+
+    # Every file shares the mesh, so the order is computed once from the first file
+    print("\nComputing Hilbert curve order (first file)...")
+    node_order, element_order = compute_order(args.model_files[0])
+    print(f"✓ Ordered {len(node_order)} nodes and {len(element_order)} elements")
+
+    for i, input_file in enumerate(args.model_files, 1):
+        output_file = os.path.join(args.output_path, os.path.basename(input_file))
+        print(f"\n[{i}/{len(args.model_files)}]", end=" ")
+
+        try:
+            process_single_file(input_file, output_file, node_order, element_order)
+        except Exception as e:
+            print(f"  ✗ Error processing {os.path.basename(input_file)}: {e}")
+            raise
+
+    print(f"\n{'='*60}")
+    print(f"Done! Processed {len(args.model_files)} files successfully.")
+    print(f"Output location: {args.output_path}")
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Renumber FVCOM nodes and elements along a Hilbert curve so spatial chunks are contiguous in the files")
+    parser.add_argument("-o", "--output-path", help="The path to output model files")
+    parser.add_argument('-m', '--model-files', nargs='+', default=[], help="A list of files to reorder")
+
+    args = parser.parse_args()
+    main(args)